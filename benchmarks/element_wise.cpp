@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import std;
+
+// Measures a chain of element-wise operations, a * b + c / d.
+//
+// The deferred chain is calculated in one pass when the result is stored. The
+// immediate chain stores every intermediate result, like before the
+// operations were deferred.
+
+namespace calculator {
+namespace math {
+
+/** @returns The time of one call of @p function in seconds. */
+template <class Function> static double measure(Function function) {
+  std::size_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+  do {
+    function();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+/** Stores the elements of @p value. */
+static tstorage store(tstorage value) {
+  std::get<tvector>(value).visit([](auto) {});
+  return value;
+}
+
+static void benchmark(std::size_t size) {
+  std::mt19937_64 generator;
+  std::uniform_real_distribution<double> distribution{1., 2.};
+  auto make = [&] {
+    std::vector<double> elements(size);
+    std::ranges::generate(elements, [&] { return distribution(generator); });
+    return tstorage{tvector{std::move(elements)}};
+  };
+  const tstorage a = make();
+  const tstorage b = make();
+  const tstorage c = make();
+  const tstorage d = make();
+
+  const double deferred = measure([&] {
+    store(element_wise_add(element_wise_mul(a, b), element_wise_div(c, d)));
+  });
+  const double immediate = measure([&] {
+    store(element_wise_add(store(element_wise_mul(a, b)),
+                           store(element_wise_div(c, d))));
+  });
+
+  std::cout << std::format("{:>10} {:>14.3f} {:>15.3f} {:>8.2f}\n", size,
+                           deferred * 1e3, immediate * 1e3,
+                           immediate / deferred);
+}
+
+} // namespace math
+} // namespace calculator
+
+int main() {
+  std::cout << std::format("{:>10} {:>14} {:>15} {:>8}\n", "size",
+                           "deferred (ms)", "immediate (ms)", "speedup");
+  for (std::size_t size = 10'000; size <= 100'000'000; size *= 10)
+    calculator::math::benchmark(size);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.linear_algebra;
+import std;
+
+// Measures the dense linear algebra operations on random matrices.
+//
+// The throughput is the number of floating-point operations of the textbook
+// algorithm divided by the time. The residual of the solution is
+// ||A * x - b|| / (||A|| * ||x|| * n * epsilon), which should stay in the
+// order of one for a stable algorithm.
+
+namespace calculator {
+namespace math {
+
+static std::vector<double> make_random(std::size_t size,
+                                       std::mt19937_64 &generator) {
+  std::uniform_real_distribution<double> distribution{-1., 1.};
+  std::vector<double> result(size);
+  for (double &element : result)
+    element = distribution(generator);
+  return result;
+}
+
+/** @returns The time of one call of @p function in seconds. */
+template <class Function> static double measure(Function function) {
+  std::size_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+  do {
+    function();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+static double residual(std::span<const double> a, std::span<const double> x,
+                       std::span<const double> b, std::size_t n) {
+  double error = 0.;
+  double norm_a = 0.;
+  double norm_x = 0.;
+  for (std::size_t i = 0; i < n; ++i) {
+    double row = 0.;
+    double sum = -b[i];
+    for (std::size_t j = 0; j < n; ++j) {
+      sum += a[i * n + j] * x[j];
+      row += std::abs(a[i * n + j]);
+    }
+    error = std::max(error, std::abs(sum));
+    norm_a = std::max(norm_a, row);
+    norm_x = std::max(norm_x, std::abs(x[i]));
+  }
+
+  return error / (norm_a * norm_x * static_cast<double>(n) *
+                  std::numeric_limits<double>::epsilon());
+}
+
+static void benchmark(std::size_t n) {
+  std::mt19937_64 generator{n};
+  const std::vector<double> elements = make_random(n * n, generator);
+  const std::vector<double> rhs = make_random(n, generator);
+  const tstorage a = tmatrix{n, n, tvector{elements}};
+  const tstorage b = tvector{rhs};
+
+  const double flops = static_cast<double>(n) * static_cast<double>(n) *
+                       static_cast<double>(n);
+  auto print = [n](std::string_view name, double seconds, double operations) {
+    std::cout << std::format("{:>6} {:>6} {:>12.3f} {:>10.2f}", n, name,
+                             seconds * 1e3, operations / seconds / 1e9);
+  };
+
+  print("det", measure([&] { det(a); }), 2. / 3. * flops);
+  std::cout << '\n';
+
+  tstorage x;
+  print("solve", measure([&] { x = solve(a, b); }), 2. / 3. * flops);
+  const std::span<const double> solution = std::get<tvector>(x).get<double>();
+  std::cout << std::format(" {:>10.3f}\n",
+                           residual(elements, solution, rhs, n));
+
+  print("inv", measure([&] { inv(a); }), 2. * flops);
+  std::cout << '\n';
+
+  print("matmul", measure([&] { matmul(a, a); }), 2. * flops);
+  std::cout << '\n';
+}
+
+} // namespace math
+} // namespace calculator
+
+int main() {
+  std::cout << std::format("{:>6} {:>6} {:>12} {:>10} {:>10}\n", "n",
+                           "op", "time (ms)", "GFLOP/s", "residual");
+  for (std::size_t n = 16; n <= 2048; n *= 2)
+    calculator::math::benchmark(n);
+}
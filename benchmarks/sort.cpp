@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.sort;
+import std;
+
+// Measures the sorting of vectors with random elements.
+//
+// The radix sort is compared with std::sort on the same elements. The small
+// keys only differ in their lowest 16 bits, so most passes are skipped.
+
+namespace calculator {
+namespace math {
+
+/** @returns The time of one call of @p function in seconds. */
+template <class Function> static double measure(Function function) {
+  std::size_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+  do {
+    function();
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+template <class T, class Generator>
+static void benchmark(std::string_view name, std::size_t size,
+                      Generator generator) {
+  std::vector<T> elements(size);
+  std::ranges::generate(elements, generator);
+  const tstorage value = tvector{elements};
+
+  const double radix = measure([&] { sort(value); });
+  const double standard = measure([&] {
+    std::vector<T> copy = elements;
+    std::ranges::sort(copy);
+  });
+
+  const double keys = static_cast<double>(size) / 1e6;
+  std::cout << std::format("{:>10} {:>7} {:>12.3f} {:>10.1f} {:>10.1f}\n",
+                           size, name, radix * 1e3, keys / radix,
+                           keys / standard);
+}
+
+} // namespace math
+} // namespace calculator
+
+int main() {
+  std::cout << std::format("{:>10} {:>7} {:>12} {:>10} {:>10}\n", "size",
+                           "type", "time (ms)", "Mkeys/s", "std::sort");
+  std::mt19937_64 generator;
+  for (std::size_t size = 1'000; size <= 100'000'000; size *= 10) {
+    calculator::math::benchmark<std::int64_t>(
+        "int64", size, [&] { return static_cast<std::int64_t>(generator()); });
+    calculator::math::benchmark<std::uint64_t>(
+        "small", size, [&] { return generator() & 0xffff; });
+    calculator::math::benchmark<double>("double", size, [&] {
+      return std::bit_cast<double>(generator() >> 2);
+    });
+  }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.reduction;
+import std;
+
+// Measures the throughput and the accuracy of the summation algorithms.
+//
+// The elements are multiples of 2^-30 with a large dynamic range and random
+// signs, so the elements partly cancel each other. Since the elements are
+// fixed-point values their exact sum is calculated with an __int128_t.
+
+namespace calculator {
+namespace math {
+
+static constexpr int scale = 30;
+
+struct tdata {
+  tstorage vector;
+  /** The exact sum rounded to a double. */
+  double reference;
+};
+
+static tdata make_data(std::size_t size) {
+  std::mt19937_64 generator{size};
+  std::uniform_int_distribution<std::int64_t> mantissa{-(std::int64_t(1) << 40),
+                                                       std::int64_t(1) << 40};
+  std::uniform_int_distribution<int> exponent{0, scale};
+
+  std::vector<double> elements;
+  elements.reserve(size);
+  __int128_t exact = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    const __int128_t value = static_cast<__int128_t>(mantissa(generator))
+                             << exponent(generator);
+    exact += value;
+    elements.push_back(std::ldexp(static_cast<double>(value), -scale));
+  }
+
+  return {tvector{std::move(elements)},
+          std::ldexp(static_cast<double>(exact), -scale)};
+}
+
+static void benchmark(const tdata &data, std::size_t size,
+                      std::string_view name, tsummation summation) {
+  const std::vector<tstorage> values{data.vector};
+  double result = 0.;
+  std::size_t iterations = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed;
+  do {
+    result = std::get<double>(sum(values, summation));
+    ++iterations;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < std::chrono::milliseconds(200));
+
+  const double seconds = elapsed.count() / static_cast<double>(iterations);
+  const double error = std::abs(result - data.reference);
+  const double ulp = std::abs(std::nextafter(data.reference, 0.) -
+                              data.reference);
+  std::cout << std::format("{:>10} {:>9} {:>10.3f} {:>12.3e} {:>10.1f}\n",
+                           size, name,
+                           static_cast<double>(size * sizeof(double)) /
+                               seconds / 1e9,
+                           error / std::abs(data.reference), error / ulp);
+}
+
+static void benchmark(std::size_t size) {
+  const tdata data = make_data(size);
+  benchmark(data, size, "naive", tsummation::naive);
+  benchmark(data, size, "pairwise", tsummation::pairwise);
+  benchmark(data, size, "neumaier", tsummation::neumaier);
+}
+
+} // namespace math
+} // namespace calculator
+
+int main() {
+  std::cout << std::format("{:>10} {:>9} {:>10} {:>12} {:>10}\n", "elements",
+                           "algorithm", "GB/s", "rel. error", "ulp");
+  for (std::size_t size : {std::size_t(1) << 10, std::size_t(1) << 16,
+                           std::size_t(1) << 20, std::size_t(1) << 24})
+    calculator::math::benchmark(size);
+}
@@ -16,8 +16,10 @@ module;
 
 #include <FL/Fl.H>
 #include <FL/Fl_Box.H>
-#include <FL/Fl_Browser.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Scrollbar.H>
 #include <FL/Fl_Window.H>
+#include <FL/fl_draw.H>
 
 export module gui;
 
@@ -27,6 +29,92 @@ import std;
 // When not in an anonymous namespace the twindow classes in tui and gui give
 // issues. This seems like a bug in Clang.
 namespace {
+/**
+ * Shows the values of the stack, the top of the stack at the bottom.
+ *
+ * Only the visible rows are formatted and drawn, directly from the rendered
+ * values of the stack. So the costs of an update don't depend on the size of
+ * the stack.
+ */
+class tstack_view final : public Fl_Group {
+public:
+  tstack_view(int x, int y, int w, int h, const calculator::tmodel &model)
+      : Fl_Group(x, y, w, h), model_(model) {
+    box(box_type);
+    color(FL_BACKGROUND2_COLOR);
+    scrollbar_.callback([](Fl_Widget *, void *self) {
+      static_cast<tstack_view *>(self)->redraw();
+    }, this);
+    end();
+  }
+
+  void textfont(Fl_Font font) { textfont_ = font; }
+  void textsize(Fl_Fontsize size) { textsize_ = size; }
+
+  /** Updates the view after the stack changed, shows the top of the stack. */
+  void update();
+
+private:
+  int handle(int event) override {
+    if (event == FL_MOUSEWHEEL)
+      return scrollbar_.handle(event);
+    return Fl_Group::handle(event);
+  }
+
+  void draw() override;
+
+  /** @returns The number of rows fitting in the view. */
+  std::size_t rows() const {
+    fl_font(textfont_, textsize_);
+    return static_cast<std::size_t>((h() - Fl::box_dh(box())) / fl_height());
+  }
+
+  static constexpr Fl_Boxtype box_type = FL_DOWN_BOX;
+
+  const calculator::tmodel &model_;
+  Fl_Font textfont_{FL_HELVETICA};
+  Fl_Fontsize textsize_{FL_NORMAL_SIZE};
+
+  Fl_Scrollbar scrollbar_{
+      x() + w() - Fl::box_dx(box_type) - Fl::scrollbar_size(),
+      y() + Fl::box_dy(box_type), Fl::scrollbar_size(),
+      h() - Fl::box_dh(box_type)};
+};
+
+void tstack_view::update() {
+  const std::size_t size = model_.stack().size();
+  const std::size_t rows = std::min(this->rows(), size);
+  scrollbar_.value(static_cast<int>(size - rows), static_cast<int>(rows), 0,
+                   static_cast<int>(size));
+  redraw();
+}
+
+void tstack_view::draw() {
+  draw_box();
+
+  const int left = x() + Fl::box_dx(box());
+  const int right = scrollbar_.x() - Fl::box_dx(box());
+  const int top = y() + Fl::box_dy(box());
+  fl_push_clip(left, top, right - left, h() - Fl::box_dh(box()));
+
+  const calculator::tstack &stack = model_.stack();
+  const std::size_t first =
+      std::min(static_cast<std::size_t>(scrollbar_.value()), stack.size());
+  const std::size_t last = std::min(first + rows(), stack.size());
+
+  fl_color(FL_FOREGROUND_COLOR);
+  int baseline = top + fl_height() - fl_descent();
+  for (std::string_view value : stack.strings(first, last)) {
+    const int size = static_cast<int>(value.size());
+    fl_draw(value.data(), size,
+            right - static_cast<int>(fl_width(value.data(), size)), baseline);
+    baseline += fl_height();
+  }
+
+  fl_pop_clip();
+  draw_child(scrollbar_);
+}
+
 class twindow final : public Fl_Window {
 public:
   twindow() : Fl_Window(600, 315, "RPN") {
@@ -43,6 +131,8 @@ public:
     input_.box(FL_DOWN_BOX);
     input_.labelsize(36);
     input_.labelfont(FL_COURIER);
+
+    model_.stack().background_formatting_set(true);
   }
 
 private:
@@ -54,7 +144,8 @@ private:
       update_ui();
       return 1;
     }
-    return 0;
+    // Lets the stack scroll.
+    return Fl_Window::handle(event);
   }
 
   /** Process the user provided input. */
@@ -66,7 +157,7 @@ private:
   // *** Widgets ***
 
   Fl_Box diagnostics_{5, 5, 590, 25};
-  Fl_Browser stack_{5, 30, 590, 230};
+  tstack_view stack_{5, 30, 590, 230, model_};
   Fl_Box input_{5, 260, 590, 50};
 
   // *** Model & controller ***
@@ -141,19 +232,10 @@ void twindow::process_input_event() {
   }
 }
 
-static std::string align_right(std::string &&value) {
-  return "@r" + std::move(value);
-}
-
 void twindow::update_ui() {
   diagnostics_.label(model_.diagnostics_get().c_str());
 
-  stack_.clear();
-  for (auto value : model_.stack().strings()) {
-    stack_.insert(std::numeric_limits<int>::max(),
-                  align_right(std::move(value)).c_str());
-  }
-  stack_.bottomline(stack_.size());
+  stack_.update();
 
   input_.label(model_.input_get().c_str());
 }
@@ -20,9 +20,18 @@ export module calculator.controller;
 
 import calculator.math.arithmetic;
 import calculator.math.bitwise;
+import calculator.math.combinatorics;
 import calculator.math.core;
+import calculator.math.element_wise;
+import calculator.math.fft;
+import calculator.math.linear_algebra;
 import calculator.math.logarithm;
+import calculator.math.reduction;
 import calculator.math.round;
+import calculator.math.scan;
+import calculator.math.sequence;
+import calculator.math.sort;
+import calculator.math.statistics;
 import calculator.model;
 import calculator.transaction;
 import calculator.undo_handler;
@@ -35,7 +44,7 @@ namespace calculator {
 /** Functor for a nullary operation. */
 template <class F>
 concept nullary_operation =
-    std::same_as<std::invoke_result_t<F, ttransaction>, void>;
+    std::same_as<std::invoke_result_t<F, ttransaction &>, void>;
 
 /** Functor for an unary math operation. */
 template <class F>
@@ -48,6 +57,13 @@ concept binary_operation =
     (std::same_as<std::invoke_result_t<F, math::tstorage, math::tstorage>,
                   math::tstorage>);
 
+/** Functor for a ternary math operation. */
+template <class F>
+concept ternary_operation =
+    (std::same_as<std::invoke_result_t<F, math::tstorage, math::tstorage,
+                                       math::tstorage>,
+                  math::tstorage>);
+
 /**
  * The pressed keyboard modifiers.
  *
@@ -379,6 +395,201 @@ static void exectute_operation(ttransaction &transaction,
   transaction.push(std::invoke(operation, lhs, rhs));
 }
 
+static void exectute_operation(ttransaction &transaction,
+                               ternary_operation auto operation) {
+  auto [c, b, a] = transaction.pop<3>();
+  transaction.push(std::invoke(operation, a, b, c));
+}
+
+/**
+ * Returns the storage of the top @p count values on the stack.
+ *
+ * The values stay on the stack, afterwards they're removed with
+ * @ref ttransaction::drop. Popping them would copy the values twice, which
+ * matters for large stacks.
+ */
+static std::vector<math::tstorage> top_values(const ttransaction &transaction,
+                                              std::size_t count) {
+  if (transaction.values().size() < count)
+    throw std::out_of_range("The stack doesn't contain enough elements");
+
+  const std::span<const tvalue> values = transaction.values().last(count);
+  return std::vector<math::tstorage>(values.begin(), values.end());
+}
+
+/**
+ * Packs values on the stack in a vector.
+ *
+ * The top of the stack contains the number of values to pack.
+ */
+static void pack(ttransaction &transaction) {
+  const math::tstorage count = transaction.pop()[0];
+  const std::vector<math::tstorage> values =
+      top_values(transaction, math::positive_integral_cast(count));
+  math::tstorage result = math::pack(values);
+  transaction.drop(values.size());
+  transaction.push(std::move(result));
+}
+
+/** Pushes the elements of a vector on the stack. */
+static void unpack(ttransaction &transaction) {
+  auto [value] = transaction.pop();
+  const std::vector<math::tstorage> elements = math::unpack(value);
+  transaction.push(std::vector<tvalue>(elements.begin(), elements.end()));
+}
+
+/** Pushes the P, L, and U matrices of the LU decomposition on the stack. */
+static void lu(ttransaction &transaction) {
+  auto [value] = transaction.pop();
+  const std::array<math::tstorage, 3> factors = math::lu(value);
+  transaction.push(std::vector<tvalue>(factors.begin(), factors.end()));
+}
+
+/** @returns Whether the top of the stack contains a vector. */
+static bool top_is_vector(const ttransaction &transaction) {
+  const std::span<const tvalue> values = transaction.values();
+  if (values.empty())
+    throw std::out_of_range("The stack doesn't contain an element");
+
+  return std::holds_alternative<math::tvector>(math::tstorage(values.back()));
+}
+
+/**
+ * Sorts the values on the stack in @p Order.
+ *
+ * When the top of the stack contains a vector its elements are sorted instead.
+ */
+template <math::torder Order> static void sort(ttransaction &transaction) {
+  if (top_is_vector(transaction)) {
+    auto [value] = transaction.pop();
+    transaction.push(math::sort(value, Order));
+    return;
+  }
+
+  const std::span<const tvalue> values = transaction.values();
+  transaction.permute(math::sort_order(
+      std::vector<math::tstorage>(values.begin(), values.end()), Order));
+}
+
+/**
+ * Replaces the values on the stack with the indices that sort them.
+ *
+ * When the top of the stack contains a vector it's replaced with the indices
+ * that sort its elements instead.
+ */
+static void argsort(ttransaction &transaction) {
+  if (top_is_vector(transaction)) {
+    auto [value] = transaction.pop();
+    transaction.push(math::argsort(value));
+    return;
+  }
+
+  const std::vector<std::size_t> indices = math::sort_order(
+      top_values(transaction, transaction.values().size()),
+      math::torder::ascending);
+  transaction.drop(indices.size());
+  transaction.push(tvalue{math::tvector{
+      std::vector<std::uint64_t>(indices.begin(), indices.end())}});
+}
+
+/** Sums the values using the algorithm @p Summation. */
+template <math::tsummation Summation>
+static math::tstorage sum(std::span<const math::tstorage> values) {
+  return math::sum(values, Summation);
+}
+
+/**
+ * Reduces all values on the stack to one value.
+ *
+ * The elements of a vector are reduced like separate values.
+ */
+template <math::tstorage (*Reduction)(std::span<const math::tstorage>)>
+static void reduce_stack(ttransaction &transaction) {
+  const std::vector<math::tstorage> values =
+      top_values(transaction, transaction.values().size());
+  math::tstorage result = std::invoke(Reduction, values);
+  transaction.drop(values.size());
+  transaction.push(std::move(result));
+}
+
+/**
+ * Reduces the top values on the stack to one value.
+ *
+ * The top of the stack contains the number of values to reduce.
+ */
+template <math::tstorage (*Reduction)(std::span<const math::tstorage>)>
+static void reduce_top(ttransaction &transaction) {
+  const math::tstorage count = transaction.pop()[0];
+  const std::vector<math::tstorage> values =
+      top_values(transaction, math::positive_integral_cast(count));
+  math::tstorage result = std::invoke(Reduction, values);
+  transaction.drop(values.size());
+  transaction.push(std::move(result));
+}
+
+/**
+ * Calculates the quantile of all values on the stack.
+ *
+ * The top of the stack contains the probability of the quantile.
+ */
+static void quantile(ttransaction &transaction) {
+  const math::tstorage probability = transaction.pop()[0];
+  const std::vector<math::tstorage> values =
+      top_values(transaction, transaction.values().size());
+  math::tstorage result = math::quantile(values, probability);
+  transaction.drop(values.size());
+  transaction.push(std::move(result));
+}
+
+/**
+ * Calculates the histogram of all values on the stack.
+ *
+ * The top of the stack contains the number of buckets.
+ */
+static void hist(ttransaction &transaction) {
+  const math::tstorage buckets = transaction.pop()[0];
+  const std::vector<math::tstorage> values =
+      top_values(transaction, transaction.values().size());
+  math::tstorage result =
+      math::hist(values, math::positive_integral_cast(buckets));
+  transaction.drop(values.size());
+  transaction.push(std::move(result));
+}
+
+/**
+ * @returns The @p value as precision of a @ref tnotation.
+ * @throws std::range_error when the value is not a valid precision.
+ */
+static int precision_cast(const math::tstorage &value) {
+  const math::tstorage precision = math::integral_cast(value);
+  std::uint64_t result;
+  if (std::holds_alternative<std::uint64_t>(precision))
+    result = std::get<std::uint64_t>(precision);
+  else if (std::get<std::int64_t>(precision) < 0)
+    throw std::range_error("Not a non-negative value");
+  else
+    result = static_cast<std::uint64_t>(std::get<std::int64_t>(precision));
+
+  if (result > tnotation::precision_max)
+    throw std::range_error("Value too large");
+  return static_cast<int>(result);
+}
+
+/**
+ * Sets the notation used to display @c double values.
+ *
+ * The top of the stack contains the precision.
+ */
+template <tnotation::tstyle Style>
+static void notation_set(ttransaction &transaction) {
+  const math::tstorage precision = transaction.pop()[0];
+  transaction.notation_set({Style, precision_cast(precision)});
+}
+
+static void notation_shortest(ttransaction &transaction) {
+  transaction.notation_set({});
+}
+
 static void execute_command(ttransaction &transaction, std::string_view input) {
   /*** Nullary ***/
   static constexpr std::array nullary_commands =
@@ -388,8 +599,64 @@ static void execute_command(ttransaction &transaction, std::string_view input) {
       iter != nullary_commands.end())
     return exectute_operation(transaction, iter->second);
 
+  /*** Stack ***/
+  static constexpr std::array stack_commands = lib::make_dictionary(
+      "pack", &pack,     //
+      "unpack", &unpack, //
+      /*** Linear algebra ***/
+      "lu", &lu, //
+      /*** Sort ***/
+      "sort", &sort<math::torder::ascending>,   //
+      "rsort", &sort<math::torder::descending>, //
+      "argsort", &argsort,                      //
+      /*** Reduction ***/
+      "sum", &reduce_stack<&sum<math::tsummation::naive>>,     //
+      "psum", &reduce_stack<&sum<math::tsummation::pairwise>>, //
+      "ksum", &reduce_stack<&sum<math::tsummation::neumaier>>, //
+      "prod", &reduce_stack<&math::prod>,                      //
+      "min", &reduce_stack<&math::min>,                        //
+      "max", &reduce_stack<&math::max>,                        //
+      "count", &reduce_stack<&math::count>,                    //
+      "nsum", &reduce_top<&sum<math::tsummation::naive>>,      //
+      "npsum", &reduce_top<&sum<math::tsummation::pairwise>>,  //
+      "nksum", &reduce_top<&sum<math::tsummation::neumaier>>,  //
+      "nprod", &reduce_top<&math::prod>,                       //
+      "nmin", &reduce_top<&math::min>,                         //
+      "nmax", &reduce_top<&math::max>,                         //
+      "ncount", &reduce_top<&math::count>,                     //
+      /*** Statistics ***/
+      "median", &reduce_stack<&math::median>, //
+      "nmedian", &reduce_top<&math::median>,  //
+      "quantile", &quantile,                  //
+      "hist", &hist,                          //
+      /*** Notation ***/
+      "fix", &notation_set<tnotation::tstyle::fixed>,      //
+      "sci", &notation_set<tnotation::tstyle::scientific>, //
+      "shortest", &notation_shortest                       //
+  );
+
+  if (auto iter = lib::find(stack_commands, input);
+      iter != stack_commands.end())
+    return exectute_operation(transaction, iter->second);
+
   /*** Unary ***/
   static constexpr std::array unary_commands = lib::make_dictionary(
+      /*** Bitwise ***/
+      "popcount", &math::popcount, //
+      "clz", &math::clz,           //
+      "ctz", &math::ctz,           //
+      "bswap", &math::bswap,       //
+      "bitrev", &math::bitrev,     //
+      /*** Combinatorics ***/
+      "fact", &math::fact, //
+      /*** Fourier transform ***/
+      "fft", &math::fft,   //
+      "ifft", &math::ifft, //
+      /*** Linear algebra ***/
+      "transpose", &math::transpose, //
+      "flatten", &math::flatten,     //
+      "inv", &math::inv,             //
+      "det", &math::det,             //
       /*** Logarithm ***/
       "lg", &math::lg,   //
       "ln", &math::ln,   //
@@ -398,7 +665,14 @@ static void execute_command(ttransaction &transaction, std::string_view input) {
       "round", &math::round, //
       "floor", &math::floor, //
       "ceil", &math::ceil,   //
-      "trunc", &math::trunc);
+      "trunc", &math::trunc, //
+      /*** Scan ***/
+      "cumsum", &math::cumsum,   //
+      "cumprod", &math::cumprod, //
+      "cummax", &math::cummax,   //
+      "cummin", &math::cummin,   //
+      /*** Sequence ***/
+      "iota", &math::iota);
 
   if (auto iter = lib::find(unary_commands, input);
       iter != unary_commands.end())
@@ -406,6 +680,21 @@ static void execute_command(ttransaction &transaction, std::string_view input) {
 
   /*** Binary ***/
   static constexpr std::array binary_commands = lib::make_dictionary(
+      /*** Bitwise ***/
+      "pdep", &math::pdep, //
+      "pext", &math::pext, //
+      "rotl", &math::rotl, //
+      "rotr", &math::rotr, //
+      /*** Combinatorics ***/
+      "choose", &math::choose, //
+      /*** Fourier transform ***/
+      "conv", &math::conv, //
+      /*** Linear algebra ***/
+      "matmul", &math::matmul,   //
+      "dot", &math::dot,         //
+      "outer", &math::outer,     //
+      "reshape", &math::reshape, //
+      "solve", &math::solve,     //
       /*** Powers ***/
       "pow", static_cast<math::tstorage (*)(math::tstorage, math::tstorage)>(
                  math::pow) // cast needed to specify non-templated function.
@@ -415,6 +704,16 @@ static void execute_command(ttransaction &transaction, std::string_view input) {
       iter != binary_commands.end())
     return exectute_operation(transaction, iter->second);
 
+  /*** Ternary ***/
+  static constexpr std::array ternary_commands = lib::make_dictionary(
+      "fma", &math::fma, //
+      /*** Sequence ***/
+      "range", &math::range);
+
+  if (auto iter = lib::find(ternary_commands, input);
+      iter != ternary_commands.end())
+    return exectute_operation(transaction, iter->second);
+
   /*** Error ***/
   throw std::domain_error("Invalid numeric value or command");
 }
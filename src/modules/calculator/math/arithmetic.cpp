@@ -15,11 +15,78 @@
 export module calculator.math.arithmetic;
 
 export import calculator.math.core;
+import calculator.math.element_wise;
 import std;
 
 namespace calculator {
 namespace math {
 
+/** @pre @p value is an integral. */
+static __int128_t to_int128(const tstorage &value) {
+  if (std::holds_alternative<std::int64_t>(value))
+    return get<std::int64_t>(value);
+  return get<std::uint64_t>(value);
+}
+
+/** Does either operand need an element-wise operation? */
+static bool holds_vector(const tstorage &lhs, const tstorage &rhs) {
+  return std::holds_alternative<tvector>(lhs) ||
+         std::holds_alternative<tvector>(rhs) ||
+         std::holds_alternative<tmatrix>(lhs) ||
+         std::holds_alternative<tmatrix>(rhs);
+}
+
+// TODO static can't be used, since caller is a template.
+/** @throws std::domain_error when @p value is a vector or a matrix. */
+/*static*/ void require_scalar(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value) ||
+      std::holds_alternative<tmatrix>(value))
+    throw std::domain_error("Not a scalar");
+}
+
+static bool holds_rational(const tstorage &lhs, const tstorage &rhs) {
+  return std::holds_alternative<trational>(lhs) ||
+         std::holds_alternative<trational>(rhs);
+}
+
+/**
+ * Converts an integral or a rational to a rational.
+ *
+ * @returns The rational or @c std::nullopt when the value doesn't fit in a
+ * rational; an @c std::uint64_t larger than @c INT64_MAX.
+ */
+static std::optional<trational> rational_cast(const tstorage &value) {
+  if (std::holds_alternative<trational>(value))
+    return get<trational>(value);
+
+  if (std::holds_alternative<std::int64_t>(value))
+    return trational{get<std::int64_t>(value), 1};
+
+  if (get<std::uint64_t>(value) >
+      static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+    return std::nullopt;
+
+  return trational{static_cast<std::int64_t>(get<std::uint64_t>(value)), 1};
+}
+
+/**
+ * Executes the rational @p operation on @p lhs and @p rhs.
+ *
+ * @pre Neither @p lhs nor @p rhs is a @c double.
+ *
+ * @returns The result or @c std::nullopt when either an operand or the result
+ * doesn't fit in a rational. The caller then uses a @c double operation.
+ */
+static std::optional<trational>
+rational_operation(const tstorage &lhs, const tstorage &rhs, auto operation) {
+  const std::optional<trational> l = rational_cast(lhs);
+  const std::optional<trational> r = rational_cast(rhs);
+  if (!l || !r)
+    return std::nullopt;
+
+  return operation(*l, *r);
+}
+
 static tstorage add(std::int64_t lhs, std::int64_t rhs) {
   return to_storage<std::int64_t>(static_cast<__int128_t>(lhs) +
                                   static_cast<__int128_t>(rhs));
@@ -40,12 +107,41 @@ static tstorage add(std::uint64_t lhs, std::int64_t rhs) {
 
 static double add(double lhs, double rhs) { return lhs + rhs; }
 
+static std::optional<trational> add(trational lhs, trational rhs) {
+  // A common denominator is the cheap case for a chain of additions.
+  if (lhs.denominator == rhs.denominator)
+    return make_rational(static_cast<__int128_t>(lhs.numerator) +
+                             rhs.numerator,
+                         lhs.denominator);
+
+  __int128_t numerator;
+  if (__builtin_add_overflow(
+          static_cast<__int128_t>(lhs.numerator) * rhs.denominator,
+          static_cast<__int128_t>(rhs.numerator) * lhs.denominator,
+          &numerator))
+    return std::nullopt;
+
+  return make_rational(numerator, static_cast<__int128_t>(lhs.denominator) *
+                                      rhs.denominator);
+}
+
 /** @see https://mordante.github.io/rpn/calculation.html#add */
 export tstorage add(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_vector(lhs, rhs))
+    return element_wise_add(lhs, rhs);
+
   if (std::holds_alternative<double>(lhs) ||
       std::holds_alternative<double>(rhs))
     return add(double_cast(lhs), double_cast(rhs));
 
+  if (holds_rational(lhs, rhs)) {
+    if (std::optional<trational> result = rational_operation(
+            lhs, rhs, [](trational l, trational r) { return add(l, r); }))
+      return *result;
+
+    return add(double_cast(lhs), double_cast(rhs));
+  }
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return add(get<std::int64_t>(lhs), get<std::int64_t>(rhs));
@@ -94,12 +190,40 @@ static tstorage sub(std::int64_t lhs, std::uint64_t rhs) {
 
 static double sub(double lhs, double rhs) { return lhs - rhs; }
 
+static std::optional<trational> sub(trational lhs, trational rhs) {
+  if (lhs.denominator == rhs.denominator)
+    return make_rational(static_cast<__int128_t>(lhs.numerator) -
+                             rhs.numerator,
+                         lhs.denominator);
+
+  __int128_t numerator;
+  if (__builtin_sub_overflow(
+          static_cast<__int128_t>(lhs.numerator) * rhs.denominator,
+          static_cast<__int128_t>(rhs.numerator) * lhs.denominator,
+          &numerator))
+    return std::nullopt;
+
+  return make_rational(numerator, static_cast<__int128_t>(lhs.denominator) *
+                                      rhs.denominator);
+}
+
 /** @see https://mordante.github.io/rpn/calculation.html#sub */
 export tstorage sub(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_vector(lhs, rhs))
+    return element_wise_sub(lhs, rhs);
+
   if (std::holds_alternative<double>(lhs) ||
       std::holds_alternative<double>(rhs))
     return sub(double_cast(lhs), double_cast(rhs));
 
+  if (holds_rational(lhs, rhs)) {
+    if (std::optional<trational> result = rational_operation(
+            lhs, rhs, [](trational l, trational r) { return sub(l, r); }))
+      return *result;
+
+    return sub(double_cast(lhs), double_cast(rhs));
+  }
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return sub(get<std::int64_t>(lhs), get<std::int64_t>(rhs));
@@ -133,12 +257,29 @@ static tstorage mul(std::uint64_t lhs, std::int64_t rhs) {
 
 static double mul(double lhs, double rhs) { return lhs * rhs; }
 
+static std::optional<trational> mul(trational lhs, trational rhs) {
+  return make_rational(static_cast<__int128_t>(lhs.numerator) * rhs.numerator,
+                       static_cast<__int128_t>(lhs.denominator) *
+                           rhs.denominator);
+}
+
 /** @see https://mordante.github.io/rpn/calculation.html#multiply */
 export tstorage mul(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_vector(lhs, rhs))
+    return element_wise_mul(lhs, rhs);
+
   if (std::holds_alternative<double>(lhs) ||
       std::holds_alternative<double>(rhs))
     return mul(double_cast(lhs), double_cast(rhs));
 
+  if (holds_rational(lhs, rhs)) {
+    if (std::optional<trational> result = rational_operation(
+            lhs, rhs, [](trational l, trational r) { return mul(l, r); }))
+      return *result;
+
+    return mul(double_cast(lhs), double_cast(rhs));
+  }
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return mul(get<std::int64_t>(lhs), get<std::int64_t>(rhs));
@@ -164,9 +305,58 @@ static double div(double lhs, double rhs) {
   return lhs / rhs;
 }
 
+/** @pre @p rhs != 0. */
+static std::optional<trational> div(trational lhs, trational rhs) {
+  return make_rational(
+      static_cast<__int128_t>(lhs.numerator) * rhs.denominator,
+      static_cast<__int128_t>(lhs.denominator) * rhs.numerator);
+}
+
+/**
+ * Divides two integrals.
+ *
+ * An exact quotient is stored as an integral, otherwise the result is a
+ * rational.
+ */
+template <class T = std::uint64_t>
+static tstorage div(__int128_t lhs, __int128_t rhs) {
+  if (rhs == 0)
+    throw std::domain_error("Division by zero");
+
+  if (lhs % rhs == 0)
+    return to_storage<T>(lhs / rhs);
+
+  if (std::optional<trational> result = make_rational(lhs, rhs))
+    return *result;
+
+  return static_cast<double>(lhs) / static_cast<double>(rhs);
+}
+
 /** @see https://mordante.github.io/rpn/calculation.html#division */
 export tstorage div(const tstorage &lhs, const tstorage &rhs) {
-  return div(double_cast(lhs), double_cast(rhs));
+  if (holds_vector(lhs, rhs))
+    return element_wise_div(lhs, rhs);
+
+  if (std::holds_alternative<double>(lhs) ||
+      std::holds_alternative<double>(rhs))
+    return div(double_cast(lhs), double_cast(rhs));
+
+  if (holds_rational(lhs, rhs)) {
+    if (double_cast(rhs) == 0.)
+      throw std::domain_error("Division by zero");
+
+    if (std::optional<trational> result = rational_operation(
+            lhs, rhs, [](trational l, trational r) { return div(l, r); }))
+      return *result;
+
+    return div(double_cast(lhs), double_cast(rhs));
+  }
+
+  if (std::holds_alternative<std::int64_t>(lhs) &&
+      std::holds_alternative<std::int64_t>(rhs))
+    return div<std::int64_t>(to_int128(lhs), to_int128(rhs));
+
+  return div(to_int128(lhs), to_int128(rhs));
 }
 
 static tstorage negate(std::int64_t value) {
@@ -180,11 +370,22 @@ static tstorage negate(std::uint64_t value) {
 
 static tstorage negate(double value) { return -value; }
 
+static tstorage negate(trational value) {
+  if (std::optional<trational> result = make_rational(
+          -static_cast<__int128_t>(value.numerator), value.denominator))
+    return *result;
+
+  return -double_cast(value);
+}
+
 export tstorage negate(tstorage value) {
+  require_scalar(value);
   if (std::holds_alternative<std::int64_t>(value))
     return negate(get<std::int64_t>(value));
   if (std::holds_alternative<std::uint64_t>(value))
     return negate(get<std::uint64_t>(value));
+  if (std::holds_alternative<trational>(value))
+    return negate(get<trational>(value));
 
   return negate(get<double>(value));
 }
@@ -215,8 +416,11 @@ static double mod(double lhs, double rhs) {
 }
 
 export tstorage mod(const tstorage &lhs, const tstorage &rhs) {
+  require_scalar(lhs);
+  require_scalar(rhs);
+
   if (std::holds_alternative<double>(lhs) ||
-      std::holds_alternative<double>(rhs))
+      std::holds_alternative<double>(rhs) || holds_rational(lhs, rhs))
     return mod(double_cast(lhs), double_cast(rhs));
 
   if (std::holds_alternative<std::int64_t>(lhs) &&
@@ -260,10 +464,15 @@ static tstorage quotient(__int128_t lhs, __int128_t rhs) {
 }
 
 export tstorage quotient(tstorage lhs, tstorage rhs) {
-  if (std::holds_alternative<double>(lhs))
+  require_scalar(lhs);
+  require_scalar(rhs);
+
+  if (std::holds_alternative<double>(lhs) ||
+      std::holds_alternative<trational>(lhs))
     lhs = integral_cast(lhs);
 
-  if (std::holds_alternative<double>(rhs))
+  if (std::holds_alternative<double>(rhs) ||
+      std::holds_alternative<trational>(rhs))
     rhs = integral_cast(rhs);
 
   if (std::holds_alternative<std::int64_t>(lhs) &&
@@ -287,6 +496,55 @@ export tstorage quotient(tstorage lhs, tstorage rhs) {
                   static_cast<__int128_t>(get<std::uint64_t>(rhs)));
 }
 
+/**
+ * Calculates the exact value of @p a * @p b + @p c.
+ *
+ * @returns The result or @c std::nullopt when an intermediate result doesn't
+ * fit in an @c __int128_t.
+ */
+static std::optional<__int128_t> fma(__int128_t a, __int128_t b, __int128_t c) {
+  __int128_t result;
+  if (__builtin_mul_overflow(a, b, &result) ||
+      __builtin_add_overflow(result, c, &result))
+    return std::nullopt;
+
+  return result;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#fused-multiply-add */
+export tstorage fma(tstorage a, tstorage b, tstorage c) {
+  require_scalar(a);
+  require_scalar(b);
+  require_scalar(c);
+
+  if (std::holds_alternative<double>(a) || std::holds_alternative<double>(b) ||
+      std::holds_alternative<double>(c))
+    return std::fma(double_cast(a), double_cast(b), double_cast(c));
+
+  if (holds_rational(a, b) || std::holds_alternative<trational>(c)) {
+    const std::optional<trational> product = rational_operation(
+        a, b, [](trational l, trational r) { return mul(l, r); });
+    const std::optional<trational> addend = rational_cast(c);
+    if (product && addend)
+      if (std::optional<trational> result = add(*product, *addend))
+        return *result;
+
+    return std::fma(double_cast(a), double_cast(b), double_cast(c));
+  }
+
+  const std::optional<__int128_t> result =
+      fma(to_int128(a), to_int128(b), to_int128(c));
+  if (!result)
+    return std::fma(double_cast(a), double_cast(b), double_cast(c));
+
+  if (std::holds_alternative<std::int64_t>(a) &&
+      std::holds_alternative<std::int64_t>(b) &&
+      std::holds_alternative<std::int64_t>(c))
+    return to_storage<std::int64_t>(*result);
+
+  return to_storage(*result);
+}
+
 // TODO static can't be used, since caller is a template.
 /*static*/ tstorage pow(double value, int exp) { return std::pow(value, exp); }
 
@@ -319,6 +577,18 @@ export tstorage quotient(tstorage lhs, tstorage rhs) {
   return to_storage(result);
 }
 
+// TODO static can't be used, since caller is a template.
+/*static*/ tstorage pow(trational value, int exp) {
+  std::optional<trational> result = value;
+  for (int i = 1; result && i < exp; ++i)
+    result = mul(*result, value);
+
+  if (result)
+    return *result;
+
+  return std::pow(double_cast(value), exp);
+}
+
 export tstorage pow(tstorage value, tstorage exp) {
   // TODO Improve algorithm selection and return type.
   return std::pow(double_cast(value), double_cast(exp));
@@ -327,11 +597,15 @@ export tstorage pow(tstorage value, tstorage exp) {
 export template <int N>
   requires(N >= 2 && N <= 9)
 tstorage pow(tstorage value) {
+  require_scalar(value);
+
   // TODO N is a compile-time value this can be used to use a smarter algorithm.
   if (std::holds_alternative<std::int64_t>(value))
     return pow(get<std::int64_t>(value), N);
   if (std::holds_alternative<std::uint64_t>(value))
     return pow(get<std::uint64_t>(value), N);
+  if (std::holds_alternative<trational>(value))
+    return pow(get<trational>(value), N);
 
   return pow(get<double>(value), N);
 }
@@ -15,6 +15,7 @@
 export module calculator.math.bitwise;
 
 export import calculator.math.core;
+import calculator.math.element_wise;
 import std;
 
 namespace calculator {
@@ -24,6 +25,10 @@ template <class T> static T bit_and(T lhs, T rhs) { return lhs & rhs; }
 
 /** @see https://mordante.github.io/rpn/calculation.html#generic */
 export tstorage bit_and(const tstorage &lhs, const tstorage &rhs) {
+  if (std::holds_alternative<tvector>(lhs) ||
+      std::holds_alternative<tvector>(rhs))
+    return element_wise_and(lhs, rhs);
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return bit_and(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
@@ -35,6 +40,10 @@ template <class T> static T bit_or(T lhs, T rhs) { return lhs | rhs; }
 
 /** @see https://mordante.github.io/rpn/calculation.html#generic */
 export tstorage bit_or(const tstorage &lhs, const tstorage &rhs) {
+  if (std::holds_alternative<tvector>(lhs) ||
+      std::holds_alternative<tvector>(rhs))
+    return element_wise_or(lhs, rhs);
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return bit_or(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
@@ -46,6 +55,10 @@ template <class T> static T bit_xor(T lhs, T rhs) { return lhs ^ rhs; }
 
 /** @see https://mordante.github.io/rpn/calculation.html#generic */
 export tstorage bit_xor(const tstorage &lhs, const tstorage &rhs) {
+  if (std::holds_alternative<tvector>(lhs) ||
+      std::holds_alternative<tvector>(rhs))
+    return element_wise_xor(lhs, rhs);
+
   if (std::holds_alternative<std::int64_t>(lhs) &&
       std::holds_alternative<std::int64_t>(rhs))
     return bit_xor(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
@@ -91,5 +104,166 @@ export tstorage shr(const tstorage &lhs, const tstorage &rhs) {
   return shr(bitwise_cast(lhs), shift);
 }
 
+// Note the bit counting operations always return an std::uint64_t, the number
+// of bits is never negative.
+
+/** @see https://mordante.github.io/rpn/calculation.html#bit-counting */
+export tstorage popcount(tstorage value) {
+  return static_cast<std::uint64_t>(std::popcount(bitwise_cast(value)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#bit-counting */
+export tstorage clz(tstorage value) {
+  return static_cast<std::uint64_t>(std::countl_zero(bitwise_cast(value)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#bit-counting */
+export tstorage ctz(tstorage value) {
+  return static_cast<std::uint64_t>(std::countr_zero(bitwise_cast(value)));
+}
+
+template <class T> static T bswap(T value) { return std::byteswap(value); }
+
+/** @see https://mordante.github.io/rpn/calculation.html#bit-reordering */
+export tstorage bswap(tstorage value) {
+  if (std::holds_alternative<std::int64_t>(value))
+    return bswap(std::get<std::int64_t>(value));
+
+  return bswap(bitwise_cast(value));
+}
+
+template <class T> static T bitrev(T value) {
+  return static_cast<T>(
+      __builtin_bitreverse64(static_cast<std::uint64_t>(value)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#bit-reordering */
+export tstorage bitrev(tstorage value) {
+  if (std::holds_alternative<std::int64_t>(value))
+    return bitrev(std::get<std::int64_t>(value));
+
+  return bitrev(bitwise_cast(value));
+}
+
+template <class T> static T rotl(T lhs, std::uint64_t rhs) {
+  return static_cast<T>(
+      std::rotl(static_cast<std::uint64_t>(lhs), static_cast<int>(rhs)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#bitwise-rotations */
+export tstorage rotl(tstorage lhs, tstorage rhs) {
+  const std::uint64_t shift = positive_integral_cast(rhs);
+  if (shift > 64)
+    throw std::range_error("Rotation too large");
+
+  if (std::holds_alternative<std::int64_t>(lhs))
+    return rotl(std::get<std::int64_t>(lhs), shift);
+
+  return rotl(bitwise_cast(lhs), shift);
+}
+
+template <class T> static T rotr(T lhs, std::uint64_t rhs) {
+  return static_cast<T>(
+      std::rotr(static_cast<std::uint64_t>(lhs), static_cast<int>(rhs)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#bitwise-rotations */
+export tstorage rotr(tstorage lhs, tstorage rhs) {
+  const std::uint64_t shift = positive_integral_cast(rhs);
+  if (shift > 64)
+    throw std::range_error("Rotation too large");
+
+  if (std::holds_alternative<std::int64_t>(lhs))
+    return rotr(std::get<std::int64_t>(lhs), shift);
+
+  return rotr(bitwise_cast(lhs), shift);
+}
+
+/*** Parallel bit deposit and extract ***/
+
+// The BMI2 instructions execute these operations in one instruction. When the
+// CPU doesn't support them a software implementation is used. The software
+// implementation only iterates over the bits set in the mask.
+
+static std::uint64_t pdep_software(std::uint64_t source, std::uint64_t mask) {
+  std::uint64_t result = 0;
+  for (std::uint64_t bit = 1; mask; bit <<= 1) {
+    if (source & bit)
+      result |= mask & -mask;
+    mask &= mask - 1;
+  }
+  return result;
+}
+
+static std::uint64_t pext_software(std::uint64_t source, std::uint64_t mask) {
+  std::uint64_t result = 0;
+  for (std::uint64_t bit = 1; mask; bit <<= 1) {
+    if (source & mask & -mask)
+      result |= bit;
+    mask &= mask - 1;
+  }
+  return result;
+}
+
+using tbit_function = std::uint64_t (*)(std::uint64_t, std::uint64_t);
+
+#if defined(__x86_64__)
+[[gnu::target("bmi2")]] static std::uint64_t pdep_bmi2(std::uint64_t source,
+                                                       std::uint64_t mask) {
+  return __builtin_ia32_pdep_di(source, mask);
+}
+
+[[gnu::target("bmi2")]] static std::uint64_t pext_bmi2(std::uint64_t source,
+                                                       std::uint64_t mask) {
+  return __builtin_ia32_pext_di(source, mask);
+}
+#endif
+
+static tbit_function select_pdep() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("bmi2"))
+    return pdep_bmi2;
+#endif
+  return pdep_software;
+}
+
+static tbit_function select_pext() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("bmi2"))
+    return pext_bmi2;
+#endif
+  return pext_software;
+}
+
+template <class T> static T pdep(T source, T mask) {
+  static const tbit_function function = select_pdep();
+  return static_cast<T>(function(static_cast<std::uint64_t>(source),
+                                 static_cast<std::uint64_t>(mask)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#generic */
+export tstorage pdep(tstorage lhs, tstorage rhs) {
+  if (std::holds_alternative<std::int64_t>(lhs) &&
+      std::holds_alternative<std::int64_t>(rhs))
+    return pdep(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
+
+  return pdep(bitwise_cast(lhs), bitwise_cast(rhs));
+}
+
+template <class T> static T pext(T source, T mask) {
+  static const tbit_function function = select_pext();
+  return static_cast<T>(function(static_cast<std::uint64_t>(source),
+                                 static_cast<std::uint64_t>(mask)));
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#generic */
+export tstorage pext(tstorage lhs, tstorage rhs) {
+  if (std::holds_alternative<std::int64_t>(lhs) &&
+      std::holds_alternative<std::int64_t>(rhs))
+    return pext(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
+
+  return pext(bitwise_cast(lhs), bitwise_cast(rhs));
+}
+
 } // namespace math
 } // namespace calculator
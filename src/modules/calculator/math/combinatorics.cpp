@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.combinatorics;
+
+export import calculator.math.core;
+import lib.table;
+import std;
+
+namespace calculator {
+namespace math {
+
+static std::uint64_t non_negative_integral_cast(const tstorage &value) {
+  const tstorage result = integral_cast(value);
+  if (std::holds_alternative<std::uint64_t>(result))
+    return std::get<std::uint64_t>(result);
+
+  if (std::get<std::int64_t>(result) < 0)
+    throw std::range_error("Not a non-negative value");
+
+  return static_cast<std::uint64_t>(std::get<std::int64_t>(result));
+}
+
+/** The largest n where n! fits in an @c std::uint64_t. */
+static constexpr std::size_t factorial_max = 20;
+
+static constexpr std::array factorials =
+    lib::make_table<factorial_max + 1>([](std::size_t n) {
+      std::uint64_t result = 1;
+      for (std::uint64_t i = 2; i <= n; ++i)
+        result *= i;
+      return result;
+    });
+
+/** @see https://mordante.github.io/rpn/calculation.html#factorial */
+export tstorage fact(tstorage value) {
+  const std::uint64_t n = non_negative_integral_cast(value);
+  if (n <= factorial_max)
+    return factorials[n];
+
+  // Unlike the binomial coefficient there are no cancelling terms, so
+  // tgamma is more accurate than exp(lgamma).
+  return std::tgamma(static_cast<double>(n) + 1.);
+}
+
+/**
+ * Calculates C(n, k) for 0 <= @p k <= @p n.
+ *
+ * Every intermediate result is a binomial coefficient itself, so the division
+ * is always exact.
+ *
+ * @returns The binomial coefficient or @c std::nullopt when the result doesn't
+ * fit in an @c std::uint64_t.
+ */
+static constexpr std::optional<std::uint64_t> binomial(std::uint64_t n,
+                                                       std::uint64_t k) {
+  k = std::min(k, n - k);
+  __uint128_t result = 1;
+  for (std::uint64_t i = 1; i <= k; ++i) {
+    result = result * (n - k + i) / i;
+    // With k <= n / 2 the intermediate results are increasing.
+    if (result > std::numeric_limits<std::uint64_t>::max())
+      return std::nullopt;
+  }
+  return static_cast<std::uint64_t>(result);
+}
+
+/** The largest n where C(n, k) fits in an @c std::uint64_t for every k. */
+static constexpr std::size_t binomial_max = 67;
+
+/**
+ * The rows of Pascal's triangle up to and including @ref binomial_max.
+ *
+ * The triangle is stored row-wise, C(n, k) is at index n * (n + 1) / 2 + k.
+ */
+static constexpr std::array binomials =
+    lib::make_table<(binomial_max + 1) * (binomial_max + 2) / 2>(
+        [](std::size_t index) {
+          std::uint64_t n = 0;
+          while (index > n) {
+            ++n;
+            index -= n;
+          }
+          return *binomial(n, index);
+        });
+
+/** @see https://mordante.github.io/rpn/calculation.html#binomial-coefficient */
+export tstorage choose(tstorage lhs, tstorage rhs) {
+  const std::uint64_t n = non_negative_integral_cast(lhs);
+  const std::uint64_t k = non_negative_integral_cast(rhs);
+  if (k > n)
+    return std::uint64_t(0);
+
+  if (n <= binomial_max)
+    return binomials[n * (n + 1) / 2 + k];
+
+  if (std::optional<std::uint64_t> result = binomial(n, k))
+    return *result;
+
+  return std::round(std::exp(std::lgamma(static_cast<double>(n) + 1.) -
+                             std::lgamma(static_cast<double>(k) + 1.) -
+                             std::lgamma(static_cast<double>(n - k) + 1.)));
+}
+
+} // namespace math
+} // namespace calculator
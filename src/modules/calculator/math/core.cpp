@@ -15,16 +15,36 @@
 module;
 
 export module calculator.math.core;
+
+export import calculator.math.matrix;
+export import calculator.math.rational;
+export import calculator.math.vector;
 import std;
 
 namespace calculator {
 namespace math {
 
-export using tstorage = std::variant<std::int64_t, std::uint64_t, double>;
+export using tstorage =
+    std::variant<std::int64_t, std::uint64_t, double, trational, tvector,
+                 tmatrix>;
 
 export template <class T>
-concept is_storage = std::same_as<T, std::int64_t> ||
-                     std::same_as<T, std::uint64_t> || std::same_as<T, double>;
+concept is_storage =
+    std::same_as<T, std::int64_t> || std::same_as<T, std::uint64_t> ||
+    std::same_as<T, double> || std::same_as<T, trational> ||
+    std::same_as<T, tvector> || std::same_as<T, tmatrix>;
+
+/**
+ * Returns the integral value of a rational.
+ *
+ * @throws std::range_error when the value is not an integral.
+ */
+static std::int64_t integral_value(trational value) {
+  value = reduce(value);
+  if (value.denominator != 1)
+    throw std::range_error("Not an integral");
+  return value.numerator;
+}
 
 static std::uint64_t bitwise_cast(std::int64_t value) {
   return static_cast<std::uint64_t>(value);
@@ -36,6 +56,18 @@ static std::uint64_t bitwise_cast(double value) {
   return std::bit_cast<std::uint64_t>(value);
 }
 
+static std::uint64_t bitwise_cast(trational value) {
+  return bitwise_cast(integral_value(value));
+}
+
+static std::uint64_t bitwise_cast(const tvector &) {
+  throw std::domain_error("Not a scalar");
+}
+
+static std::uint64_t bitwise_cast(const tmatrix &) {
+  throw std::domain_error("Not a scalar");
+}
+
 /** Catches changes of @ref tstorage. */
 template <class T> static std::uint64_t bitwise_cast(T) = delete;
 
@@ -72,6 +104,20 @@ static std::uint64_t positive_integral_cast(double value) {
   return static_cast<std::uint64_t>(result);
 }
 
+static std::uint64_t positive_integral_cast(trational value) {
+  if (value.numerator <= 0)
+    throw std::range_error("Not a positive value");
+  return positive_integral_cast(integral_value(value));
+}
+
+static std::uint64_t positive_integral_cast(const tvector &) {
+  throw std::domain_error("Not a scalar");
+}
+
+static std::uint64_t positive_integral_cast(const tmatrix &) {
+  throw std::domain_error("Not a scalar");
+}
+
 /** Catches changes of @ref tstorage. */
 template <class T> static std::uint64_t positive_integral_cast(T) = delete;
 
@@ -103,6 +149,20 @@ static std::int64_t negative_integral_cast(double value) {
   return static_cast<std::int64_t>(result);
 }
 
+static std::int64_t negative_integral_cast(trational value) {
+  if (value.numerator >= 0)
+    throw std::range_error("Not a negative value");
+  return negative_integral_cast(integral_value(value));
+}
+
+static std::int64_t negative_integral_cast(const tvector &) {
+  throw std::domain_error("Not a scalar");
+}
+
+static std::int64_t negative_integral_cast(const tmatrix &) {
+  throw std::domain_error("Not a scalar");
+}
+
 /** Catches changes of @ref tstorage. */
 template <class T> static std::int64_t negative_integral_cast(T) = delete;
 
@@ -127,6 +187,18 @@ static tstorage integral_cast(double value) {
   throw std::domain_error("value can't be converted to an integral");
 }
 
+static tstorage integral_cast(trational value) {
+  return integral_value(value);
+}
+
+static tstorage integral_cast(const tvector &) {
+  throw std::domain_error("Not a scalar");
+}
+
+static tstorage integral_cast(const tmatrix &) {
+  throw std::domain_error("Not a scalar");
+}
+
 /** Catches changes of @ref tstorage. */
 template <class T> static tstorage integral_cast(T) = delete;
 
@@ -144,6 +216,19 @@ static double double_cast(std::uint64_t value) {
 
 static double double_cast(double value) { return value; }
 
+static double double_cast(trational value) {
+  return static_cast<double>(value.numerator) /
+         static_cast<double>(value.denominator);
+}
+
+static double double_cast(const tvector &) {
+  throw std::domain_error("Not a scalar");
+}
+
+static double double_cast(const tmatrix &) {
+  throw std::domain_error("Not a scalar");
+}
+
 /** Catches changes of @ref tstorage. */
 template <class T> static double double_cast(T) = delete;
 
@@ -151,6 +236,19 @@ export double double_cast(const tstorage &value) {
   return std::visit([](auto v) { return double_cast(v); }, value);
 }
 
+/**
+ * Returns the elements of a vector or a matrix.
+ *
+ * @returns The elements or @c nullptr when @p value is a scalar.
+ */
+export const tvector *get_elements(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value))
+    return &std::get<tvector>(value);
+  if (std::holds_alternative<tmatrix>(value))
+    return &std::get<tmatrix>(value).elements();
+  return nullptr;
+}
+
 /**
  * Converts the @p value to the proper @ref tstorage type.
  *
@@ -187,5 +285,122 @@ export tstorage to_storage(__uint128_t value) {
 
   return static_cast<std::uint64_t>(value);
 }
+
+// TODO static can't be used, since caller is a template.
+template <class R>
+/*static*/ tstorage convert(std::span<const __int128_t> values) {
+  std::vector<R> result;
+  result.reserve(values.size());
+  for (__int128_t value : values)
+    result.push_back(static_cast<R>(value));
+
+  return tvector{std::move(result)};
+}
+
+/**
+ * Stores the integral @p values in a vector.
+ *
+ * Like @ref to_storage, but the type is selected for all elements.
+ */
+export template <class T = std::uint64_t>
+  requires(std::same_as<T, std::int64_t> || std::same_as<T, std::uint64_t>)
+tstorage to_vector(std::span<const __int128_t> values) {
+  const auto [min, max] = std::ranges::minmax(values);
+  const bool fits_signed = min >= std::numeric_limits<std::int64_t>::min() &&
+                           max <= std::numeric_limits<std::int64_t>::max();
+  const bool fits_unsigned =
+      min >= 0 && max <= std::numeric_limits<std::uint64_t>::max();
+
+  if (fits_signed && (std::same_as<T, std::int64_t> || !fits_unsigned))
+    return convert<std::int64_t>(values);
+  if (fits_unsigned)
+    return convert<std::uint64_t>(values);
+
+  return convert<double>(values);
+}
+
+/*** Comparison ***/
+
+/**
+ * The exact value of an integral or a rational.
+ *
+ * The value is stored as @c quotient + @c remainder / @c divisor, where
+ * @c quotient is rounded towards negative infinity. Comparing these values
+ * never overflows.
+ */
+struct texact {
+  __int128_t quotient;
+  __int128_t remainder;
+  __int128_t divisor;
+};
+
+/** @pre @p value is an integral or a rational. */
+static texact make_exact(const tstorage &value) {
+  if (std::holds_alternative<std::int64_t>(value))
+    return {std::get<std::int64_t>(value), 0, 1};
+  if (std::holds_alternative<std::uint64_t>(value))
+    return {std::get<std::uint64_t>(value), 0, 1};
+
+  const trational rational = std::get<trational>(value);
+  __int128_t quotient = rational.numerator / rational.denominator;
+  __int128_t remainder = rational.numerator % rational.denominator;
+  if (remainder < 0) {
+    --quotient;
+    remainder += rational.denominator;
+  }
+  return {quotient, remainder, rational.denominator};
+}
+
+static std::strong_ordering compare(const texact &lhs, const texact &rhs) {
+  if (lhs.quotient != rhs.quotient)
+    return lhs.quotient <=> rhs.quotient;
+
+  return lhs.remainder * rhs.divisor <=> rhs.remainder * lhs.divisor;
+}
+
+/**
+ * Compares a @c double with an exact value.
+ *
+ * The integral parts are compared exactly, the fractional parts are compared
+ * as @c double.
+ *
+ * @pre @p lhs is not a NaN.
+ */
+static std::partial_ordering compare(double lhs, const texact &rhs) {
+  const double floor = std::floor(lhs);
+  // The exact values are less than 2^65, so these values don't fit.
+  if (floor < -0x1p100)
+    return std::partial_ordering::less;
+  if (floor > 0x1p100)
+    return std::partial_ordering::greater;
+
+  const __int128_t quotient = static_cast<__int128_t>(floor);
+  if (quotient != rhs.quotient)
+    return quotient <=> rhs.quotient;
+
+  return lhs - floor <=> static_cast<double>(rhs.remainder) /
+                             static_cast<double>(rhs.divisor);
+}
+
+/**
+ * Compares two scalars.
+ *
+ * Unlike comparing the @ref double_cast of the values, this compares large
+ * integrals exactly.
+ *
+ * @pre @p lhs and @p rhs are scalars and not a NaN.
+ */
+export std::partial_ordering compare(const tstorage &lhs, const tstorage &rhs) {
+  const bool lhs_double = std::holds_alternative<double>(lhs);
+  const bool rhs_double = std::holds_alternative<double>(rhs);
+  if (lhs_double && rhs_double)
+    return std::get<double>(lhs) <=> std::get<double>(rhs);
+  if (lhs_double)
+    return compare(std::get<double>(lhs), make_exact(rhs));
+  if (rhs_double)
+    return 0 <=> compare(std::get<double>(rhs), make_exact(lhs));
+
+  return compare(make_exact(lhs), make_exact(rhs));
+}
 } // namespace math
 } // namespace calculator
@@ -0,0 +1,958 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.element_wise;
+
+export import calculator.math.core;
+import calculator.math.simd;
+import std;
+
+namespace calculator {
+namespace math {
+
+/**
+ * The elements of an operand of an element-wise operation.
+ *
+ * A scalar operand is used for every element of the other operand.
+ */
+using telements =
+    std::variant<std::span<const std::int64_t>, std::span<const std::uint64_t>,
+                 std::span<const double>, std::int64_t, std::uint64_t, double>;
+
+/**
+ * An operand of an element-wise operation.
+ *
+ * Unlike @ref telements this can be a lazy vector, its elements are
+ * calculated in parts by @ref for_each_part.
+ */
+using toperand =
+    std::variant<std::span<const std::int64_t>, std::span<const std::uint64_t>,
+                 std::span<const double>, std::int64_t, std::uint64_t, double,
+                 const tvector *>;
+
+/**
+ * Creates the operand for @p value.
+ *
+ * A rational scalar is converted to a @c double, a vector can't store
+ * rationals.
+ *
+ * @note The returned operand refers to @p value.
+ */
+static toperand make_operand(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value)) {
+    const tvector &vector = std::get<tvector>(value);
+    if (!vector.stored())
+      return &vector;
+
+    return vector.visit([](auto elements) -> toperand { return elements; });
+  }
+
+  if (std::holds_alternative<std::int64_t>(value))
+    return std::get<std::int64_t>(value);
+  if (std::holds_alternative<std::uint64_t>(value))
+    return std::get<std::uint64_t>(value);
+
+  return double_cast(value);
+}
+
+/** Is @p operand a vector with elements of type @p T? */
+template <class T> static bool holds_vector(const toperand &operand) {
+  if (std::holds_alternative<const tvector *>(operand))
+    return std::get<const tvector *>(operand)->holds<T>();
+  return std::holds_alternative<std::span<const T>>(operand);
+}
+
+template <class T> static bool holds(const toperand &operand) {
+  return holds_vector<T>(operand) || std::holds_alternative<T>(operand);
+}
+
+/**
+ * Converts an integral scalar to the element type of the vector @p other.
+ *
+ * This allows to use the fast paths for the common case of a small positive
+ * scalar and a vector of @c std::int64_t. The conversion is only done when
+ * the value of the scalar fits in the element type.
+ */
+static void adjust_scalar(toperand &scalar, const toperand &other) {
+  if (std::holds_alternative<std::uint64_t>(scalar) &&
+      holds_vector<std::int64_t>(other)) {
+    if (std::get<std::uint64_t>(scalar) <=
+        static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+      scalar = static_cast<std::int64_t>(std::get<std::uint64_t>(scalar));
+
+  } else if (std::holds_alternative<std::int64_t>(scalar) &&
+             holds_vector<std::uint64_t>(other)) {
+    if (std::get<std::int64_t>(scalar) >= 0)
+      scalar = static_cast<std::uint64_t>(std::get<std::int64_t>(scalar));
+  }
+}
+
+/** The storage for the elements of a part of a lazy vector. */
+using tbuffer = std::variant<std::vector<std::int64_t>,
+                             std::vector<std::uint64_t>, std::vector<double>>;
+
+/** Returns the elements of @p buffer, they have the type @p T. */
+template <class T> static std::vector<T> &buffer_elements(tbuffer &buffer) {
+  if (!std::holds_alternative<std::vector<T>>(buffer))
+    buffer.emplace<std::vector<T>>(tvector::part_size);
+  return std::get<std::vector<T>>(buffer);
+}
+
+/**
+ * Returns the elements [first, first + size) of @p operand.
+ *
+ * The elements of a lazy vector are calculated in @p buffer.
+ *
+ * @pre @p size <= @ref tvector::part_size when @p operand is a lazy vector.
+ */
+static telements part(const toperand &operand, std::size_t first,
+                      std::size_t size, tbuffer &buffer) {
+  return std::visit(
+      [&]<class T>(T value) -> telements {
+        if constexpr (std::same_as<T, const tvector *>) {
+          if (value->stored())
+            return value->visit([&](auto stored) -> telements {
+              return stored.subspan(first, size);
+            });
+
+          if (value->holds_sequence())
+            return value->visit_sequence(
+                [&]<class E>(const tsequence<E> &sequence) -> telements {
+                  std::vector<E> &result = buffer_elements<E>(buffer);
+                  for (std::size_t i = 0; i < size; ++i)
+                    result[i] = sequence[first + i];
+                  return std::span<const E>{result.data(), size};
+                });
+
+          std::vector<double> &result = buffer_elements<double>(buffer);
+          value->evaluate(first, size, result.data());
+          return std::span<const double>{result.data(), size};
+        } else if constexpr (requires { value.subspan(first, size); })
+          return value.subspan(first, size);
+        else
+          return value;
+      },
+      operand);
+}
+
+/**
+ * Calls @c function(l, r, first, size) with the elements
+ * [first, first + size) of @p lhs and @p rhs.
+ *
+ * Without a lazy operand the @p function is called once for all elements.
+ * Else the elements are processed in parts, the elements of the lazy vector
+ * are never stored.
+ */
+template <class Function>
+static void for_each_part(const toperand &lhs, const toperand &rhs,
+                          std::size_t size, Function function) {
+  const std::size_t part_size =
+      std::holds_alternative<const tvector *>(lhs) ||
+              std::holds_alternative<const tvector *>(rhs)
+          ? tvector::part_size
+          : size;
+
+  tbuffer l;
+  tbuffer r;
+  for (std::size_t first = 0; first < size; first += part_size) {
+    const std::size_t count = std::min(part_size, size - first);
+    function(part(lhs, first, count, l), part(rhs, first, count, r), first,
+             count);
+  }
+}
+
+/**
+ * Returns the number of elements in the result of an element-wise operation.
+ *
+ * @pre @p lhs or @p rhs is a vector.
+ *
+ * @throws std::domain_error when the sizes of the vectors differ.
+ */
+static std::size_t result_size(const tstorage &lhs, const tstorage &rhs) {
+  if (!std::holds_alternative<tvector>(lhs))
+    return std::get<tvector>(rhs).size();
+
+  const std::size_t size = std::get<tvector>(lhs).size();
+  if (std::holds_alternative<tvector>(rhs) &&
+      std::get<tvector>(rhs).size() != size)
+    throw std::domain_error("Vector sizes differ");
+
+  return size;
+}
+
+static bool holds_matrix(const tstorage &lhs, const tstorage &rhs) {
+  return std::holds_alternative<tmatrix>(lhs) ||
+         std::holds_alternative<tmatrix>(rhs);
+}
+
+/**
+ * Executes the element-wise @p operation on a matrix.
+ *
+ * The operation is executed on the elements of the matrix, the result has
+ * the shape of the matrix.
+ *
+ * @pre @p lhs or @p rhs is a matrix.
+ *
+ * @throws std::domain_error when the other operand is a vector or a matrix
+ * with a different shape.
+ */
+static tstorage matrix_operation(const tstorage &lhs, const tstorage &rhs,
+                                 tstorage (*operation)(const tstorage &,
+                                                       const tstorage &)) {
+  const tmatrix &matrix = std::holds_alternative<tmatrix>(lhs)
+                              ? std::get<tmatrix>(lhs)
+                              : std::get<tmatrix>(rhs);
+  auto elements = [&matrix](const tstorage &value) -> tstorage {
+    if (std::holds_alternative<tvector>(value))
+      throw std::domain_error("Not a matrix");
+    if (!std::holds_alternative<tmatrix>(value))
+      return value;
+
+    const tmatrix &other = std::get<tmatrix>(value);
+    if (other.rows() != matrix.rows() || other.columns() != matrix.columns())
+      throw std::domain_error("Matrix sizes differ");
+    return other.elements();
+  };
+
+  return make_matrix(
+      matrix.rows(), matrix.columns(),
+      std::get<tvector>(operation(elements(lhs), elements(rhs))));
+}
+
+/*** Double operations ***/
+
+using tdouble_operand =
+    std::variant<simd::tarray<std::int64_t>, simd::tarray<std::uint64_t>,
+                 simd::tarray<double>, simd::tbroadcast<double>>;
+
+static tdouble_operand double_operand(const telements &operand) {
+  return std::visit(
+      []<class T>(T value) -> tdouble_operand {
+        if constexpr (requires { value.data(); })
+          return simd::tarray<typename T::value_type>{value.data()};
+        else
+          return simd::tbroadcast<double>{static_cast<double>(value)};
+      },
+      operand);
+}
+
+template <class Operation>
+static tstorage double_operation(const toperand &lhs, const toperand &rhs,
+                                 std::size_t size, Operation &&operation) {
+  std::vector<double> result(size);
+  for_each_part(lhs, rhs, size,
+                [&](const telements &l, const telements &r, std::size_t first,
+                    std::size_t count) {
+                  std::visit(
+                      [&](auto left, auto right) {
+                        simd::transform(result.data() + first, count, left,
+                                        right, operation);
+                      },
+                      double_operand(l), double_operand(r));
+                });
+
+  return tvector{std::move(result)};
+}
+
+/*** Integral operations ***/
+
+// The integral operations use std::uint64_t elements. The signed operations
+// use the two's complement representation of the elements.
+
+using tintegral_operand =
+    std::variant<simd::tarray<std::uint64_t>, simd::tbroadcast<std::uint64_t>>;
+
+/**
+ * Creates the integral operand for an integral operation.
+ *
+ * A @c double uses its bit pattern, like @ref bitwise_cast.
+ */
+static tintegral_operand integral_operand(const telements &operand) {
+  return std::visit(
+      []<class T>(T value) -> tintegral_operand {
+        if constexpr (requires { value.data(); })
+          return simd::tarray<std::uint64_t>{
+              reinterpret_cast<const std::uint64_t *>(value.data())};
+        else
+          return simd::tbroadcast<std::uint64_t>{
+              std::bit_cast<std::uint64_t>(value)};
+      },
+      operand);
+}
+
+/**
+ * Executes an integral @p operation.
+ *
+ * @returns The result or @c std::nullopt when the @p operation detected an
+ * overflow.
+ */
+template <class T, class Operation>
+static std::optional<tstorage>
+integral_operation(const toperand &lhs, const toperand &rhs, std::size_t size,
+                   Operation &&operation) {
+  std::vector<T> result(size);
+  for_each_part(
+      lhs, rhs, size,
+      [&](const telements &l, const telements &r, std::size_t first,
+          std::size_t count) {
+        std::visit(
+            [&](auto left, auto right) {
+              simd::transform(
+                  reinterpret_cast<std::uint64_t *>(result.data()) + first,
+                  count, left, right, operation);
+            },
+            integral_operand(l), integral_operand(r));
+      });
+
+  if constexpr (requires { operation.overflowed(); })
+    if (operation.overflowed())
+      return std::nullopt;
+
+  return tvector{std::move(result)};
+}
+
+/*** Wide operations ***/
+
+// The wide operations calculate every element in the 128-bit domain. They
+// are used when the types of the operands differ, or when the result of the
+// integral operation doesn't fit. Since there are no 128-bit SIMD operations
+// these are scalar loops. The 128-bit results are never stored, they are
+// narrowed to the type of the result while calculating.
+
+template <class T>
+static __int128_t wide_element(std::span<const T> elements,
+                               std::size_t index) {
+  return static_cast<__int128_t>(elements[index]);
+}
+
+template <class T> static __int128_t wide_element(T value, std::size_t) {
+  return static_cast<__int128_t>(value);
+}
+
+/**
+ * Calls @c sink(i, value) with the result of the wide @p operation for
+ * every element.
+ *
+ * @returns Whether the @p operation returned a value for every element.
+ */
+template <class Operation, class Sink>
+static bool wide_transform(const toperand &lhs, const toperand &rhs,
+                           std::size_t size, Operation &operation,
+                           Sink sink) {
+  bool valid = true;
+  for_each_part(lhs, rhs, size,
+                [&](const telements &l, const telements &r, std::size_t first,
+                    std::size_t count) {
+                  std::visit(
+                      [&](auto left, auto right) {
+                        for (std::size_t i = 0; valid && i < count; ++i) {
+                          const std::optional<__int128_t> value = operation(
+                              wide_element(left, i), wide_element(right, i));
+                          if (value)
+                            sink(first + i, *value);
+                          else
+                            valid = false;
+                        }
+                      },
+                      l, r);
+                });
+  return valid;
+}
+
+/** Stores the results of a wide @p operation as @p R. */
+template <class R, class Operation>
+static tstorage wide_store(const toperand &lhs, const toperand &rhs,
+                           std::size_t size, Operation &operation) {
+  std::vector<R> result(size);
+  wide_transform(lhs, rhs, size, operation,
+                 [&result](std::size_t index, __int128_t value) {
+                   result[index] = static_cast<R>(value);
+                 });
+  return tvector{std::move(result)};
+}
+
+/**
+ * Executes a wide @p operation.
+ *
+ * The type of the elements is selected like @ref to_vector<T>. The results
+ * are stored as @p T, when they don't fit they are calculated again. The
+ * second pass selects the type and the third pass stores the results.
+ *
+ * @pre @p lhs and @p rhs are integral.
+ *
+ * @returns The result or @c std::nullopt when the @p operation returned
+ * @c std::nullopt for an element.
+ */
+template <class T = std::uint64_t, class Operation>
+static std::optional<tstorage> wide_operation(const toperand &lhs,
+                                              const toperand &rhs,
+                                              std::size_t size,
+                                              Operation operation) {
+  std::vector<T> result(size);
+  bool fits = true;
+  if (!wide_transform(lhs, rhs, size, operation,
+                      [&](std::size_t index, __int128_t value) {
+                        fits &= value >= std::numeric_limits<T>::min() &&
+                                value <= std::numeric_limits<T>::max();
+                        result[index] = static_cast<T>(value);
+                      }))
+    return std::nullopt;
+
+  if (fits)
+    return tvector{std::move(result)};
+
+  result = std::vector<T>{};
+  __int128_t min = std::numeric_limits<__int128_t>::max();
+  __int128_t max = std::numeric_limits<__int128_t>::min();
+  wide_transform(lhs, rhs, size, operation,
+                 [&](std::size_t, __int128_t value) {
+                   min = std::min(min, value);
+                   max = std::max(max, value);
+                 });
+
+  const bool fits_signed = min >= std::numeric_limits<std::int64_t>::min() &&
+                           max <= std::numeric_limits<std::int64_t>::max();
+  const bool fits_unsigned =
+      min >= 0 && max <= std::numeric_limits<std::uint64_t>::max();
+
+  if (fits_signed && (std::same_as<T, std::int64_t> || !fits_unsigned))
+    return wide_store<std::int64_t>(lhs, rhs, size, operation);
+  if (fits_unsigned)
+    return wide_store<std::uint64_t>(lhs, rhs, size, operation);
+
+  return wide_store<double>(lhs, rhs, size, operation);
+}
+
+/*** Sequence operations ***/
+
+// Adding or subtracting a scalar or a sequence to a sequence, or multiplying
+// a sequence by a scalar, gives a sequence again when the result is integral.
+// These operations keep a lazy vector lazy, so large sequences are never
+// stored.
+
+enum class tsequence_operation { add, sub, mul };
+
+static bool is_sequence(const tstorage &value) {
+  return std::holds_alternative<tvector>(value) &&
+         std::get<tvector>(value).holds_sequence();
+}
+
+/**
+ * Returns the first and last element of a sequence.
+ *
+ * @returns The elements as a vector, a scalar is returned unchanged, or
+ * @c std::nullopt when @p value is a stored vector.
+ */
+static std::optional<tstorage> sequence_endpoints(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    return value;
+  if (!is_sequence(value))
+    return std::nullopt;
+
+  return std::get<tvector>(value).visit_sequence(
+      []<class T>(const tsequence<T> &sequence) -> tstorage {
+        return tvector{
+            std::vector<T>{sequence[0], sequence[sequence.count - 1]}};
+      });
+}
+
+/**
+ * Executes an element-wise @p operation on a sequence.
+ *
+ * The @p element_wise operation is executed on the first and last elements
+ * only. The elements of a sequence are monotonic, so these select the type of
+ * the elements of the result.
+ *
+ * Only an integral result is a sequence, then its elements are exact. The
+ * elements of a @c double sequence, @c start' + i * step', differ from the
+ * results of the operation on the elements. Those results are calculated per
+ * element, for a large vector by a deferred operation.
+ *
+ * @returns The resulting sequence or @c std::nullopt when the result is not
+ * calculated as a sequence.
+ */
+static std::optional<tstorage>
+sequence_operation(const tstorage &lhs, const tstorage &rhs,
+                   tsequence_operation operation,
+                   tstorage (*element_wise)(const tstorage &,
+                                            const tstorage &)) {
+  if (!is_sequence(lhs) && !is_sequence(rhs))
+    return std::nullopt;
+
+  const std::size_t size = result_size(lhs, rhs);
+  if (size == 1 || (operation == tsequence_operation::mul &&
+                    std::holds_alternative<tvector>(lhs) &&
+                    std::holds_alternative<tvector>(rhs)))
+    return std::nullopt;
+
+  const std::optional<tstorage> l = sequence_endpoints(lhs);
+  const std::optional<tstorage> r = sequence_endpoints(rhs);
+  if (!l || !r)
+    return std::nullopt;
+
+  return std::get<tvector>(element_wise(*l, *r))
+      .visit([&]<class T>(
+                 std::span<const T> elements) -> std::optional<tstorage> {
+        if constexpr (std::same_as<T, double>)
+          return std::nullopt;
+        else {
+          const __int128_t step =
+              (static_cast<__int128_t>(elements[1]) - elements[0]) /
+              static_cast<__int128_t>(size - 1);
+          return tvector{
+              tsequence<T>{elements[0], static_cast<T>(step), size}};
+        }
+      });
+}
+
+/*** Deferred operations ***/
+
+// An arithmetic operation on large vectors with a double result is deferred.
+// The result stores the operation and its operands instead of the elements.
+// When the elements are needed a chain of deferred operations is calculated
+// in one pass. The pass processes the elements in parts that fit in the L1
+// cache, so the intermediate results are never stored in memory.
+
+/** Smaller vectors are calculated immediately. */
+static constexpr std::size_t deferred_size_min = 1 << 12;
+
+/** The operands of a longer chain are stored before the operation. */
+static constexpr std::size_t deferred_depth_max = 8;
+
+/** The number of elements calculated in one part. */
+static constexpr std::size_t deferred_part_size = 512;
+
+/** Does the operation on @p value give a @c double result? */
+static bool holds_double(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value))
+    return std::get<tvector>(value).holds<double>();
+  return std::holds_alternative<double>(value) ||
+         std::holds_alternative<trational>(value);
+}
+
+static std::size_t deferred_depth(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value))
+    return std::get<tvector>(value).depth();
+  return 0;
+}
+
+template <class Operation>
+class tdeferred_operation final : public texpression {
+public:
+  tdeferred_operation(std::size_t size, const tstorage &lhs,
+                      const tstorage &rhs)
+      : texpression(size,
+                    1 + std::max(deferred_depth(lhs), deferred_depth(rhs))),
+        lhs_(make_term(lhs)), rhs_(make_term(rhs)) {}
+
+  void evaluate(std::size_t first, std::size_t size,
+                double *result) const override {
+    std::array<double, deferred_part_size> lhs;
+    std::array<double, deferred_part_size> rhs;
+    for (std::size_t offset = 0; offset < size;
+         offset += deferred_part_size) {
+      const std::size_t count = std::min(deferred_part_size, size - offset);
+      std::visit(
+          [&](auto l, auto r) {
+            simd::transform(result + offset, count, l, r, operation_);
+          },
+          operand(lhs_, first + offset, count, lhs.data()),
+          operand(rhs_, first + offset, count, rhs.data()));
+    }
+  }
+
+private:
+  /** A scalar is stored as the @c double used in the operation. */
+  using tterm = std::variant<double, tvector>;
+
+  static tterm make_term(const tstorage &value) {
+    if (std::holds_alternative<tvector>(value))
+      return std::get<tvector>(value);
+    return double_cast(value);
+  }
+
+  /**
+   * Returns the operand for the elements [first, first + size).
+   *
+   * Stored elements are used directly, else they are calculated in
+   * @p buffer.
+   */
+  static tdouble_operand operand(const tterm &term, std::size_t first,
+                                 std::size_t size, double *buffer) {
+    if (std::holds_alternative<double>(term))
+      return simd::tbroadcast<double>{std::get<double>(term)};
+
+    const tvector &vector = std::get<tvector>(term);
+    if (vector.stored())
+      return vector.visit([first]<class T>(std::span<const T> elements)
+                              -> tdouble_operand {
+        return simd::tarray<T>{elements.data() + first};
+      });
+
+    vector.evaluate(first, size, buffer);
+    return simd::tarray<double>{buffer};
+  }
+
+  tterm lhs_;
+  tterm rhs_;
+  // The operation is stateless, but the transform requires a reference.
+  mutable Operation operation_;
+};
+
+/**
+ * Defers an element-wise @p Operation.
+ *
+ * @returns The deferred result or @c std::nullopt when the operation is
+ * calculated immediately.
+ */
+template <class Operation>
+static std::optional<tstorage> deferred_operation(const tstorage &lhs,
+                                                  const tstorage &rhs) {
+  if (!holds_double(lhs) && !holds_double(rhs))
+    return std::nullopt;
+
+  const std::size_t size = result_size(lhs, rhs);
+  if (size < deferred_size_min)
+    return std::nullopt;
+
+  // Storing an operand limits the work of a part and the recursion depth.
+  auto limit = [](const tstorage &value) {
+    if (deferred_depth(value) >= deferred_depth_max)
+      std::get<tvector>(value).visit([](auto) {});
+  };
+  limit(lhs);
+  limit(rhs);
+
+  return tvector{
+      std::make_unique<const tdeferred_operation<Operation>>(size, lhs, rhs)};
+}
+
+/*** Element-wise operations ***/
+
+/**
+ * Executes an element-wise arithmetic operation.
+ *
+ * The type of the elements in the result is:
+ * - a @c double when either operand is a @c double,
+ * - otherwise @p integral_kernel selects the type.
+ */
+template <class Double, class Integral>
+static tstorage arithmetic_operation(const tstorage &lhs, const tstorage &rhs,
+                                     Double double_kernel,
+                                     Integral integral_kernel) {
+  const std::size_t size = result_size(lhs, rhs);
+  toperand l = make_operand(lhs);
+  toperand r = make_operand(rhs);
+  adjust_scalar(l, r);
+  adjust_scalar(r, l);
+
+  if (holds<double>(l) || holds<double>(r))
+    return double_operation(l, r, size, double_kernel);
+
+  if (std::optional<tstorage> result = integral_kernel(l, r, size))
+    return *result;
+
+  return double_operation(l, r, size, double_kernel);
+}
+
+/** Executes an element-wise addition or subtraction. */
+template <class Signed, class Unsigned>
+static tstorage additive_operation(const tstorage &lhs, const tstorage &rhs,
+                                   auto double_kernel, auto wide_kernel) {
+  return arithmetic_operation(
+      lhs, rhs, double_kernel,
+      [&](const toperand &l, const toperand &r, std::size_t size) {
+        if (holds<std::int64_t>(l) && holds<std::int64_t>(r)) {
+          if (std::optional<tstorage> result =
+                  integral_operation<std::int64_t>(l, r, size, Signed{}))
+            return result;
+
+          return wide_operation<std::int64_t>(l, r, size, wide_kernel);
+        }
+
+        if (holds<std::uint64_t>(l) && holds<std::uint64_t>(r))
+          if (std::optional<tstorage> result =
+                  integral_operation<std::uint64_t>(l, r, size, Unsigned{}))
+            return result;
+
+        return wide_operation(l, r, size, wide_kernel);
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#vector-operations */
+export tstorage element_wise_add(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_matrix(lhs, rhs))
+    return matrix_operation(lhs, rhs, &element_wise_add);
+
+  if (std::optional<tstorage> result = sequence_operation(
+          lhs, rhs, tsequence_operation::add, &element_wise_add))
+    return *result;
+  if (std::optional<tstorage> result =
+          deferred_operation<simd::tplus>(lhs, rhs))
+    return *result;
+
+  return additive_operation<simd::tplus_signed, simd::tplus_unsigned>(
+      lhs, rhs, simd::tplus{},
+      [](__int128_t l, __int128_t r) -> std::optional<__int128_t> {
+        return l + r;
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#vector-operations */
+export tstorage element_wise_sub(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_matrix(lhs, rhs))
+    return matrix_operation(lhs, rhs, &element_wise_sub);
+
+  if (std::optional<tstorage> result = sequence_operation(
+          lhs, rhs, tsequence_operation::sub, &element_wise_sub))
+    return *result;
+  if (std::optional<tstorage> result =
+          deferred_operation<simd::tminus>(lhs, rhs))
+    return *result;
+
+  return additive_operation<simd::tminus_signed, simd::tminus_unsigned>(
+      lhs, rhs, simd::tminus{},
+      [](__int128_t l, __int128_t r) -> std::optional<__int128_t> {
+        return l - r;
+      });
+}
+
+/**
+ * @see https://mordante.github.io/rpn/calculation.html#vector-operations
+ *
+ * @note There are no SIMD instructions for 64-bit integral multiplications
+ * with overflow detection. The integral multiplication is done with the wide
+ * operation.
+ */
+export tstorage element_wise_mul(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_matrix(lhs, rhs))
+    return matrix_operation(lhs, rhs, &element_wise_mul);
+
+  if (std::optional<tstorage> result = sequence_operation(
+          lhs, rhs, tsequence_operation::mul, &element_wise_mul))
+    return *result;
+  if (std::optional<tstorage> result =
+          deferred_operation<simd::tmultiplies>(lhs, rhs))
+    return *result;
+
+  return arithmetic_operation(
+      lhs, rhs, simd::tmultiplies{},
+      [](const toperand &l, const toperand &r, std::size_t size) {
+        auto kernel = [](__int128_t l,
+                         __int128_t r) -> std::optional<__int128_t> {
+          __int128_t result;
+          if (__builtin_mul_overflow(l, r, &result))
+            return std::nullopt;
+          return result;
+        };
+
+        if (holds<std::int64_t>(l) && holds<std::int64_t>(r))
+          return wide_operation<std::int64_t>(l, r, size, kernel);
+
+        return wide_operation(l, r, size, kernel);
+      });
+}
+
+template <class T> static bool holds_zero(const tsequence<T> &sequence) {
+  // The elements are monotonic, so a binary search finds the zero.
+  const bool ascending = sequence[0] <= sequence[sequence.count - 1];
+  const auto indices = std::views::iota(std::size_t(0), sequence.count);
+  const auto zero =
+      std::ranges::partition_point(indices, [&](std::size_t index) {
+        return ascending ? sequence[index] < T(0) : sequence[index] > T(0);
+      });
+  return zero != indices.end() && sequence[*zero] == T(0);
+}
+
+/**
+ * Does the divisor @p value hold a zero?
+ *
+ * This doesn't store the elements of a lazy vector. A sequence is searched
+ * for a zero, the elements of a deferred vector are calculated in parts.
+ */
+static bool holds_zero(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    return double_cast(value) == 0.;
+
+  const tvector &vector = std::get<tvector>(value);
+  if (vector.holds_sequence())
+    return vector.visit_sequence(
+        [](const auto &sequence) { return holds_zero(sequence); });
+
+  bool result = false;
+  vector.visit_parts(0, vector.size(), [&](auto elements) {
+    result = result || std::ranges::find(elements, 0) != elements.end();
+  });
+  return result;
+}
+
+/**
+ * @see https://mordante.github.io/rpn/calculation.html#vector-operations
+ *
+ * @note Unlike the scalar division the result is never a rational. When a
+ * quotient is not exact the result is a vector of @c double.
+ */
+export tstorage element_wise_div(const tstorage &lhs, const tstorage &rhs) {
+  if (holds_matrix(lhs, rhs))
+    return matrix_operation(lhs, rhs, &element_wise_div);
+
+  if (holds_zero(rhs))
+    throw std::domain_error("Division by zero");
+  if (std::optional<tstorage> result =
+          deferred_operation<simd::tdivides>(lhs, rhs))
+    return *result;
+
+  return arithmetic_operation(
+      lhs, rhs, simd::tdivides{},
+      [](const toperand &l, const toperand &r, std::size_t size) {
+        auto kernel = [](__int128_t l,
+                         __int128_t r) -> std::optional<__int128_t> {
+          if (l % r != 0)
+            return std::nullopt;
+          return l / r;
+        };
+
+        if (holds<std::int64_t>(l) && holds<std::int64_t>(r))
+          return wide_operation<std::int64_t>(l, r, size, kernel);
+
+        return wide_operation(l, r, size, kernel);
+      });
+}
+
+/**
+ * Creates the operand for a bitwise operation.
+ *
+ * A scalar uses @ref bitwise_cast. Unlike @ref make_operand this preserves
+ * the value of an integral rational.
+ */
+static toperand bitwise_operand(const tstorage &value) {
+  if (std::holds_alternative<tvector>(value))
+    return make_operand(value);
+
+  return bitwise_cast(value);
+}
+
+/**
+ * Executes an element-wise bitwise operation.
+ *
+ * Like the scalar operations, the result is only signed when both operands
+ * are signed.
+ */
+template <class Operation>
+static tstorage bitwise_operation(const tstorage &lhs, const tstorage &rhs,
+                                  Operation operation) {
+  const std::size_t size = result_size(lhs, rhs);
+  toperand l = make_operand(lhs);
+  toperand r = make_operand(rhs);
+  adjust_scalar(l, r);
+  adjust_scalar(r, l);
+
+  if (holds<std::int64_t>(l) && holds<std::int64_t>(r))
+    return *integral_operation<std::int64_t>(l, r, size, operation);
+
+  return *integral_operation<std::uint64_t>(
+      bitwise_operand(lhs), bitwise_operand(rhs), size, operation);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#vector-operations */
+export tstorage element_wise_and(const tstorage &lhs, const tstorage &rhs) {
+  return bitwise_operation(lhs, rhs, simd::tbit_and{});
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#vector-operations */
+export tstorage element_wise_or(const tstorage &lhs, const tstorage &rhs) {
+  return bitwise_operation(lhs, rhs, simd::tbit_or{});
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#vector-operations */
+export tstorage element_wise_xor(const tstorage &lhs, const tstorage &rhs) {
+  return bitwise_operation(lhs, rhs, simd::tbit_xor{});
+}
+
+/*** Construction ***/
+
+template <class T> static tstorage pack(std::span<const tstorage> values) {
+  std::vector<T> result;
+  result.reserve(values.size());
+  for (const tstorage &value : values) {
+    if constexpr (std::same_as<T, double>)
+      result.push_back(double_cast(value));
+    else if (std::holds_alternative<std::int64_t>(value))
+      result.push_back(static_cast<T>(std::get<std::int64_t>(value)));
+    else
+      result.push_back(static_cast<T>(std::get<std::uint64_t>(value)));
+  }
+
+  return tvector{std::move(result)};
+}
+
+/**
+ * @see https://mordante.github.io/rpn/calculation.html#pack
+ *
+ * @pre @p values is not empty.
+ */
+export tstorage pack(std::span<const tstorage> values) {
+  bool floating_point = false;
+  bool negative = false;
+  bool large = false;
+  bool mixed = false;
+  for (const tstorage &value : values) {
+    if (std::holds_alternative<tvector>(value) ||
+        std::holds_alternative<tmatrix>(value))
+      throw std::domain_error("Not a scalar");
+
+    if (std::holds_alternative<double>(value) ||
+        std::holds_alternative<trational>(value))
+      floating_point = true;
+    else if (std::holds_alternative<std::int64_t>(value))
+      negative |= std::get<std::int64_t>(value) < 0;
+    else
+      large |= std::get<std::uint64_t>(value) >
+               static_cast<std::uint64_t>(
+                   std::numeric_limits<std::int64_t>::max());
+
+    mixed |= value.index() != values.front().index();
+  }
+
+  if (floating_point)
+    return pack<double>(values);
+
+  // Like to_storage, the signed type is only used when the values don't fit
+  // in the unsigned type. When all values have the same type, that type is
+  // used.
+  if (!mixed)
+    return std::holds_alternative<std::int64_t>(values.front())
+               ? pack<std::int64_t>(values)
+               : pack<std::uint64_t>(values);
+
+  if (!negative)
+    return pack<std::uint64_t>(values);
+  if (!large)
+    return pack<std::int64_t>(values);
+
+  return pack<double>(values);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#unpack */
+export std::vector<tstorage> unpack(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    throw std::domain_error("Not a vector");
+
+  return std::get<tvector>(value).visit([](auto elements) {
+    return std::vector<tstorage>(elements.begin(), elements.end());
+  });
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.fft;
+
+export import calculator.math.core;
+import lib.parallel;
+import std;
+
+namespace calculator {
+namespace math {
+
+// A complex vector is stored as a matrix with two columns, the real and the
+// imaginary parts of the elements.
+
+using tcomplex = std::complex<double>;
+
+/**
+ * Multiplies two complex values.
+ *
+ * Unlike the operator of @c std::complex this doesn't handle infinities and
+ * NaNs per Annex G of the C standard. That handling prevents inlining.
+ */
+static tcomplex complex_multiply(tcomplex lhs, tcomplex rhs) {
+  return {lhs.real() * rhs.real() - lhs.imag() * rhs.imag(),
+          lhs.real() * rhs.imag() + lhs.imag() * rhs.real()};
+}
+
+/** @returns The elements of a vector or a complex vector. */
+static std::vector<tcomplex> to_complex(const tstorage &value) {
+  std::vector<tcomplex> result;
+  if (std::holds_alternative<tvector>(value)) {
+    std::get<tvector>(value).visit([&]<class T>(std::span<const T> elements) {
+      result.reserve(elements.size());
+      for (T element : elements)
+        result.emplace_back(static_cast<double>(element), 0.);
+    });
+  } else if (std::holds_alternative<tmatrix>(value) &&
+             std::get<tmatrix>(value).columns() == 2) {
+    std::get<tmatrix>(value).elements().visit(
+        [&]<class T>(std::span<const T> elements) {
+          result.reserve(elements.size() / 2);
+          for (std::size_t i = 0; i < elements.size(); i += 2)
+            result.emplace_back(static_cast<double>(elements[i]),
+                                static_cast<double>(elements[i + 1]));
+        });
+  } else
+    throw std::domain_error("Not a vector");
+
+  return result;
+}
+
+static tstorage from_complex(std::span<const tcomplex> elements) {
+  std::vector<double> result;
+  result.reserve(2 * elements.size());
+  for (tcomplex element : elements) {
+    result.push_back(element.real());
+    result.push_back(element.imag());
+  }
+  return tmatrix{elements.size(), 2, tvector{std::move(result)}};
+}
+
+/*** Plans ***/
+
+/** The plans of every type, see @ref cached. */
+struct tplan_cache {
+  /** The maximum size of the tables of the cached plans, in bytes. */
+  static constexpr std::size_t bytes_max = std::size_t(64) << 20;
+
+  std::mutex mutex;
+  std::map<std::pair<std::type_index, std::size_t>, std::shared_ptr<const void>>
+      plans;
+  /** The size of the tables of the cached plans, in bytes. */
+  std::size_t bytes{0};
+};
+
+static tplan_cache &plan_cache() {
+  static tplan_cache result;
+  return result;
+}
+
+/**
+ * Returns the plan for a transform of @p size elements.
+ *
+ * Creating a plan calculates its tables, the plans are cached per type and
+ * size. Every plan is charged with the size of its tables, @c Plan::bytes(),
+ * against the budget shared by all plans. The cache is reset when it exceeds
+ * the budget, plans larger than the budget aren't cached.
+ */
+template <class Plan>
+static std::shared_ptr<const Plan> cached(std::size_t size) {
+  tplan_cache &cache = plan_cache();
+  const std::pair key{std::type_index{typeid(Plan)}, size};
+  {
+    std::lock_guard lock{cache.mutex};
+    if (auto it = cache.plans.find(key); it != cache.plans.end())
+      return std::static_pointer_cast<const Plan>(it->second);
+  }
+
+  // A plan can use other plans, so it's created without holding the lock.
+  auto plan = std::make_shared<const Plan>(size);
+  const std::size_t bytes = plan->bytes();
+  if (bytes > tplan_cache::bytes_max)
+    return plan;
+
+  std::lock_guard lock{cache.mutex};
+  // Another thread may have created the plan in the meantime.
+  if (auto it = cache.plans.find(key); it != cache.plans.end())
+    return std::static_pointer_cast<const Plan>(it->second);
+
+  if (cache.bytes + bytes > tplan_cache::bytes_max) {
+    cache.plans.clear();
+    cache.bytes = 0;
+  }
+  cache.plans.emplace(key, plan);
+  cache.bytes += bytes;
+  return plan;
+}
+
+/** The tables of a transform where the size is a power of two. */
+struct tplan {
+  explicit tplan(std::size_t size)
+      : size(size), twiddles(std::max<std::size_t>(1, size / 2)),
+        reversed(size) {
+    for (std::size_t k = 0; k < twiddles.size(); ++k)
+      twiddles[k] = std::polar(1., -2. * std::numbers::pi *
+                                       static_cast<double>(k) /
+                                       static_cast<double>(size));
+
+    const int bits = std::countr_zero(size);
+    for (std::size_t i = 0; i < size; ++i)
+      reversed[i] = bits ? __builtin_bitreverse64(i) >> (64 - bits) : 0;
+  }
+
+  [[nodiscard]] std::size_t bytes() const noexcept {
+    return twiddles.size() * sizeof(tcomplex) +
+           reversed.size() * sizeof(std::size_t);
+  }
+
+  std::size_t size;
+  /** The twiddle factors exp(-2 pi i k / size) for k in [0, size / 2). */
+  std::vector<tcomplex> twiddles;
+  /** The bit-reversed index of every index. */
+  std::vector<std::size_t> reversed;
+};
+
+/**
+ * Transforms the @p data in place.
+ *
+ * This is an iterative decimation in time transform. Two radix-2 stages are
+ * fused in one radix-4 pass, this halves the number of passes over the data.
+ * When the number of stages is odd the first stage is a radix-2 pass.
+ *
+ * @pre @p data has @c plan.size elements.
+ */
+static void transform(const tplan &plan, std::span<tcomplex> data) {
+  const std::size_t size = plan.size;
+  for (std::size_t i = 0; i < size; ++i)
+    if (std::size_t j = plan.reversed[i]; i < j)
+      std::swap(data[i], data[j]);
+
+  // The distance between the elements of the butterflies of the first stage.
+  std::size_t half = 1;
+  if (std::countr_zero(size) % 2) {
+    for (std::size_t k = 0; k < size; k += 2) {
+      const tcomplex a = data[k];
+      const tcomplex b = data[k + 1];
+      data[k] = a + b;
+      data[k + 1] = a - b;
+    }
+    half = 2;
+  }
+
+  for (; 4 * half <= size; half *= 4) {
+    const std::size_t stride = size / (4 * half);
+    const std::size_t shift = std::countr_zero(half);
+    lib::parallel_for(size / 4, [&](std::size_t first, std::size_t last) {
+      for (std::size_t q = first; q < last; ++q) {
+        const std::size_t j = q & (half - 1);
+        const std::size_t k = ((q >> shift) << (shift + 2)) + j;
+
+        const tcomplex u = plan.twiddles[j * stride];
+        const tcomplex u2 = plan.twiddles[2 * j * stride];
+
+        const tcomplex t1 = complex_multiply(u2, data[k + half]);
+        const tcomplex y0 = data[k] + t1;
+        const tcomplex y1 = data[k] - t1;
+        const tcomplex t3 = complex_multiply(u2, data[k + 3 * half]);
+        const tcomplex y2 = data[k + 2 * half] + t3;
+        const tcomplex y3 = data[k + 2 * half] - t3;
+
+        // The twiddle of the second pair is u * exp(-pi i / 2) = -i * u.
+        const tcomplex v2 = complex_multiply(u, y2);
+        const tcomplex w3 = complex_multiply(u, y3);
+        const tcomplex v3{w3.imag(), -w3.real()};
+
+        data[k] = y0 + v2;
+        data[k + 2 * half] = y0 - v2;
+        data[k + half] = y1 + v3;
+        data[k + 3 * half] = y1 - v3;
+      }
+    });
+  }
+}
+
+/**
+ * The tables of Bluestein's algorithm for a transform of any size.
+ *
+ * The transform is rewritten as a convolution with a chirp, the convolution
+ * is calculated with a power of two transform.
+ */
+struct tchirp {
+  explicit tchirp(std::size_t size)
+      : size(size), plan(cached<tplan>(std::bit_ceil(2 * size - 1))),
+        chirp(size), filter(plan->size) {
+    // The angle uses k^2 modulo 2 * size to avoid losing precision for large
+    // values of k.
+    for (std::size_t k = 0; k < size; ++k) {
+      const auto square = static_cast<std::size_t>(
+          static_cast<__uint128_t>(k) * k % (2 * size));
+      chirp[k] = std::polar(1., -std::numbers::pi *
+                                    static_cast<double>(square) /
+                                    static_cast<double>(size));
+    }
+
+    filter[0] = std::conj(chirp[0]);
+    for (std::size_t k = 1; k < size; ++k)
+      filter[k] = filter[plan->size - k] = std::conj(chirp[k]);
+    transform(*plan, filter);
+  }
+
+  /** Includes the tables of its plan, which it keeps alive. */
+  [[nodiscard]] std::size_t bytes() const noexcept {
+    return (chirp.size() + filter.size()) * sizeof(tcomplex) + plan->bytes();
+  }
+
+  std::size_t size;
+  std::shared_ptr<const tplan> plan;
+  /** The chirp exp(-pi i k^2 / size) for k in [0, size). */
+  std::vector<tcomplex> chirp;
+  /** The transform of the conjugated chirp, wrapped around. */
+  std::vector<tcomplex> filter;
+};
+
+static void conjugate(std::span<tcomplex> data) {
+  for (tcomplex &element : data)
+    element = std::conj(element);
+}
+
+/**
+ * Calculates the inverse transform of a power of two size without scaling.
+ *
+ * The inverse is the conjugate of the transform of the conjugated data.
+ */
+static void inverse_transform(const tplan &plan, std::span<tcomplex> data) {
+  conjugate(data);
+  transform(plan, data);
+  conjugate(data);
+}
+
+/** Transforms the @p data in place, the size may be any value. */
+static void transform(std::vector<tcomplex> &data) {
+  const std::size_t size = data.size();
+  if (std::has_single_bit(size))
+    return transform(*cached<tplan>(size), data);
+
+  const std::shared_ptr<const tchirp> plan = cached<tchirp>(size);
+  const tplan &convolution = *plan->plan;
+
+  std::vector<tcomplex> buffer(convolution.size);
+  for (std::size_t k = 0; k < size; ++k)
+    buffer[k] = complex_multiply(data[k], plan->chirp[k]);
+
+  transform(convolution, buffer);
+  for (std::size_t k = 0; k < buffer.size(); ++k)
+    buffer[k] = complex_multiply(buffer[k], plan->filter[k]);
+  inverse_transform(convolution, buffer);
+
+  const double scale = 1. / static_cast<double>(convolution.size);
+  for (std::size_t k = 0; k < size; ++k)
+    data[k] = complex_multiply(buffer[k], plan->chirp[k]) * scale;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#fft */
+export tstorage fft(tstorage value) {
+  std::vector<tcomplex> data = to_complex(value);
+  transform(data);
+  return from_complex(data);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#fft */
+export tstorage ifft(tstorage value) {
+  // The inverse transform is the transform with the indices reversed. Unlike
+  // conjugating, this doesn't turn a zero imaginary part into -0.
+  std::vector<tcomplex> data = to_complex(value);
+  transform(data);
+  std::reverse(data.begin() + 1, data.end());
+  const double scale = 1. / static_cast<double>(data.size());
+  for (tcomplex &element : data)
+    element *= scale;
+  return from_complex(data);
+}
+
+/*** Convolution ***/
+
+/**
+ * The length of the shortest vector where the transform is faster.
+ *
+ * The direct method takes n * m multiplications, the transform based method
+ * takes O((n + m) log(n + m)) with a larger constant.
+ */
+static constexpr std::size_t convolution_threshold = 64;
+
+static const tvector &convolution_operand(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    throw std::domain_error("Not a vector");
+  return std::get<tvector>(value);
+}
+
+static std::vector<double> to_doubles(const tvector &vector) {
+  return vector.visit([]<class T>(std::span<const T> elements) {
+    return std::vector<double>(elements.begin(), elements.end());
+  });
+}
+
+static std::vector<double> direct_convolution(std::span<const double> lhs,
+                                              std::span<const double> rhs) {
+  std::vector<double> result(lhs.size() + rhs.size() - 1);
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    const double factor = lhs[i];
+    double *output = result.data() + i;
+    for (std::size_t j = 0; j < rhs.size(); ++j)
+      output[j] += factor * rhs[j];
+  }
+  return result;
+}
+
+/**
+ * Convolves with a transform.
+ *
+ * Both real inputs are transformed at once, @p lhs is stored in the real and
+ * @p rhs in the imaginary parts. With Z the transform of this combination the
+ * product of the transforms is (Z[k]^2 - conj(Z[-k])^2) / 4i.
+ */
+static std::vector<double> transform_convolution(std::span<const double> lhs,
+                                                 std::span<const double> rhs) {
+  const std::size_t size = lhs.size() + rhs.size() - 1;
+  const std::shared_ptr<const tplan> plan =
+      cached<tplan>(std::bit_ceil(size));
+
+  std::vector<tcomplex> data(plan->size);
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    data[i].real(lhs[i]);
+  for (std::size_t i = 0; i < rhs.size(); ++i)
+    data[i].imag(rhs[i]);
+
+  transform(*plan, data);
+  std::vector<tcomplex> product(plan->size);
+  for (std::size_t k = 0; k < plan->size; ++k) {
+    const tcomplex z = data[k];
+    const tcomplex mirror =
+        std::conj(data[(plan->size - k) & (plan->size - 1)]);
+    const tcomplex difference =
+        complex_multiply(z, z) - complex_multiply(mirror, mirror);
+    // Dividing by 4i is multiplying by -i / 4.
+    product[k] = {difference.imag() / 4., -difference.real() / 4.};
+  }
+  inverse_transform(*plan, product);
+
+  const double scale = 1. / static_cast<double>(plan->size);
+  std::vector<double> result(size);
+  for (std::size_t i = 0; i < size; ++i)
+    result[i] = product[i].real() * scale;
+  return result;
+}
+
+static std::vector<double> convolution(std::span<const double> lhs,
+                                       std::span<const double> rhs) {
+  if (std::min(lhs.size(), rhs.size()) <= convolution_threshold)
+    return direct_convolution(lhs, rhs);
+  return transform_convolution(lhs, rhs);
+}
+
+/** @returns The largest magnitude of the integral @p elements. */
+template <class T> static double magnitude(std::span<const T> elements) {
+  double result = 0.;
+  for (T element : elements)
+    result = std::max(result, std::abs(static_cast<double>(element)));
+  return result;
+}
+
+/**
+ * Convolves integral vectors exactly.
+ *
+ * @returns The result or @c std::nullopt when an intermediate result doesn't
+ * fit in an @c __int128_t.
+ */
+template <class Lhs, class Rhs>
+static std::optional<std::vector<__int128_t>>
+exact_convolution(std::span<const Lhs> lhs, std::span<const Rhs> rhs) {
+  std::vector<__int128_t> result(lhs.size() + rhs.size() - 1);
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      __int128_t product;
+      if (__builtin_mul_overflow(__int128_t(lhs[i]), __int128_t(rhs[j]),
+                                 &product) ||
+          __builtin_add_overflow(result[i + j], product, &result[i + j]))
+        return std::nullopt;
+    }
+  return result;
+}
+
+/**
+ * Convolves integral vectors.
+ *
+ * The transform is exact after rounding as long as the elements of the result
+ * are well below 2^53. Otherwise the direct method with exact arithmetic is
+ * used.
+ */
+template <class Lhs, class Rhs>
+static tstorage integral_convolution(std::span<const Lhs> lhs,
+                                     std::span<const Rhs> rhs) {
+  static constexpr bool is_signed =
+      std::same_as<Lhs, std::int64_t> || std::same_as<Rhs, std::int64_t>;
+  using R = std::conditional_t<is_signed, std::int64_t, std::uint64_t>;
+
+  const double bound = magnitude(lhs) * magnitude(rhs) *
+                       static_cast<double>(std::min(lhs.size(), rhs.size()));
+  if (std::min(lhs.size(), rhs.size()) > convolution_threshold &&
+      bound < 0x1p40) {
+    const std::vector<double> result = transform_convolution(
+        std::vector<double>(lhs.begin(), lhs.end()),
+        std::vector<double>(rhs.begin(), rhs.end()));
+    std::vector<__int128_t> rounded;
+    rounded.reserve(result.size());
+    for (double element : result)
+      rounded.push_back(static_cast<__int128_t>(std::llround(element)));
+    return to_vector<R>(rounded);
+  }
+
+  if (std::optional<std::vector<__int128_t>> result =
+          exact_convolution(lhs, rhs))
+    return to_vector<R>(*result);
+
+  return tvector{convolution(std::vector<double>(lhs.begin(), lhs.end()),
+                             std::vector<double>(rhs.begin(), rhs.end()))};
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#convolution */
+export tstorage conv(tstorage lhs, tstorage rhs) {
+  const tvector &a = convolution_operand(lhs);
+  const tvector &b = convolution_operand(rhs);
+  if (a.holds<double>() || b.holds<double>())
+    return tvector{convolution(to_doubles(a), to_doubles(b))};
+
+  return a.visit([&]<class Lhs>(std::span<const Lhs> lhs_elements) {
+    return b.visit(
+        [&]<class Rhs>(std::span<const Rhs> rhs_elements) -> tstorage {
+          if constexpr (std::same_as<Lhs, double> ||
+                        std::same_as<Rhs, double>)
+            std::unreachable();
+          else
+            return integral_convolution(lhs_elements, rhs_elements);
+        });
+  });
+}
+
+} // namespace math
+} // namespace calculator
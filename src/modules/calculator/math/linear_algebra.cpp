@@ -0,0 +1,819 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.linear_algebra;
+
+export import calculator.math.core;
+import calculator.math.simd;
+import lib.parallel;
+import std;
+
+namespace calculator {
+namespace math {
+
+/** @throws std::domain_error when @p value is not a matrix. */
+static const tmatrix &get_matrix(const tstorage &value) {
+  if (!std::holds_alternative<tmatrix>(value))
+    throw std::domain_error("Not a matrix");
+  return std::get<tmatrix>(value);
+}
+
+/**
+ * Returns the vector @p value as a matrix with one row.
+ *
+ * This converts the elements to the types a matrix can store.
+ *
+ * @throws std::domain_error when @p value is not a vector.
+ */
+static tmatrix get_vector(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    throw std::domain_error("Not a vector");
+  const tvector &vector = std::get<tvector>(value);
+  return make_matrix(1, vector.size(), vector);
+}
+
+static tmatrix to_double(const tmatrix &matrix) {
+  if (matrix.holds<double>())
+    return matrix;
+
+  const std::span<const std::int64_t> elements =
+      matrix.elements().get<std::int64_t>();
+  return tmatrix{matrix.rows(), matrix.columns(),
+                 tvector{std::vector<double>(elements.begin(),
+                                             elements.end())}};
+}
+
+/**
+ * Stores the exact @p elements in a matrix.
+ *
+ * @returns The matrix or @c std::nullopt when an element doesn't fit in an
+ * @c std::int64_t.
+ */
+static std::optional<tmatrix> to_matrix(std::size_t rows, std::size_t columns,
+                                        std::span<const __int128_t> elements) {
+  std::vector<std::int64_t> result;
+  result.reserve(elements.size());
+  for (__int128_t element : elements) {
+    if (element < std::numeric_limits<std::int64_t>::min() ||
+        element > std::numeric_limits<std::int64_t>::max())
+      return std::nullopt;
+    result.push_back(static_cast<std::int64_t>(element));
+  }
+  return tmatrix{rows, columns, tvector{std::move(result)}};
+}
+
+/*** Construction ***/
+
+/** @see https://mordante.github.io/rpn/calculation.html#reshape */
+export tstorage reshape(tstorage value, tstorage columns) {
+  const std::uint64_t c = positive_integral_cast(columns);
+  const tmatrix matrix = std::holds_alternative<tmatrix>(value)
+                             ? std::get<tmatrix>(value)
+                             : get_vector(value);
+  const tvector &elements = matrix.elements();
+  if (elements.size() % c != 0)
+    throw std::domain_error("The size isn't a multiple of the columns");
+
+  return make_matrix(elements.size() / c, c, elements);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#flatten */
+export tstorage flatten(tstorage value) {
+  return get_matrix(value).elements();
+}
+
+/*** Transpose ***/
+
+/**
+ * Transposes the matrix in tiles.
+ *
+ * Either the reads or the writes of a naive transpose use a stride of a
+ * complete row. Processing a tile at a time keeps the cache lines of both
+ * the source and the destination in the cache.
+ */
+template <class T>
+static std::vector<T> transposed(std::span<const T> elements, std::size_t rows,
+                                 std::size_t columns) {
+  static constexpr std::size_t tile = 32;
+
+  std::vector<T> result(elements.size());
+  for (std::size_t i = 0; i < rows; i += tile)
+    for (std::size_t j = 0; j < columns; j += tile)
+      for (std::size_t r = i; r < std::min(i + tile, rows); ++r)
+        for (std::size_t c = j; c < std::min(j + tile, columns); ++c)
+          result[c * rows + r] = elements[r * columns + c];
+
+  return result;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#transpose */
+export tstorage transpose(tstorage value) {
+  const tmatrix &matrix = get_matrix(value);
+  return matrix.visit([&matrix](auto elements) -> tstorage {
+    return tmatrix{matrix.columns(), matrix.rows(),
+                   tvector{transposed(elements, matrix.rows(),
+                                      matrix.columns())}};
+  });
+}
+
+/*** Dot product ***/
+
+[[gnu::always_inline]] inline double
+dot_kernel(const double *lhs, const double *rhs, std::size_t size) {
+  using tregister = simd::tregister<double>;
+  static constexpr std::size_t lanes = simd::lanes<double>;
+
+  // Two accumulators hide the latency of the additions.
+  tregister sum0{};
+  tregister sum1{};
+  std::size_t index = 0;
+  for (; index + 2 * lanes <= size; index += 2 * lanes) {
+    tregister l0, l1, r0, r1;
+    __builtin_memcpy(&l0, lhs + index, sizeof(l0));
+    __builtin_memcpy(&l1, lhs + index + lanes, sizeof(l1));
+    __builtin_memcpy(&r0, rhs + index, sizeof(r0));
+    __builtin_memcpy(&r1, rhs + index + lanes, sizeof(r1));
+    sum0 += l0 * r0;
+    sum1 += l1 * r1;
+  }
+
+  const tregister sum = sum0 + sum1;
+  double result = 0.;
+  for (std::size_t i = 0; i < lanes; ++i)
+    result += sum[i];
+
+  for (; index < size; ++index)
+    result += lhs[index] * rhs[index];
+
+  return result;
+}
+
+#if defined(__x86_64__)
+[[gnu::target("avx2,fma")]] static double
+dot_avx2(const double *lhs, const double *rhs, std::size_t size) {
+  return dot_kernel(lhs, rhs, size);
+}
+#endif
+
+static double dot_default(const double *lhs, const double *rhs,
+                          std::size_t size) {
+  return dot_kernel(lhs, rhs, size);
+}
+
+static double dot(std::span<const double> lhs, std::span<const double> rhs) {
+#if defined(__x86_64__)
+  static const bool avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if (avx2)
+    return dot_avx2(lhs.data(), rhs.data(), lhs.size());
+#endif
+  return dot_default(lhs.data(), rhs.data(), lhs.size());
+}
+
+/**
+ * Calculates the exact dot product.
+ *
+ * @returns The result or @c std::nullopt when an intermediate result doesn't
+ * fit in an @c __int128_t.
+ */
+static std::optional<tstorage> dot(std::span<const std::int64_t> lhs,
+                                   std::span<const std::int64_t> rhs) {
+  __int128_t result = 0;
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    if (__builtin_add_overflow(result, static_cast<__int128_t>(lhs[i]) * rhs[i],
+                               &result))
+      return std::nullopt;
+
+  return to_storage<std::int64_t>(result);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#dot-product */
+export tstorage dot(tstorage lhs, tstorage rhs) {
+  const tmatrix l = get_vector(lhs);
+  const tmatrix r = get_vector(rhs);
+  if (l.columns() != r.columns())
+    throw std::domain_error("Vector sizes differ");
+
+  if (l.holds<std::int64_t>() && r.holds<std::int64_t>())
+    if (std::optional<tstorage> result =
+            dot(l.elements().get<std::int64_t>(),
+                r.elements().get<std::int64_t>()))
+      return *result;
+
+  return dot(to_double(l).elements().get<double>(),
+             to_double(r).elements().get<double>());
+}
+
+/*** Outer product ***/
+
+/** @see https://mordante.github.io/rpn/calculation.html#outer-product */
+export tstorage outer(tstorage lhs, tstorage rhs) {
+  const tmatrix l = get_vector(lhs);
+  const tmatrix r = get_vector(rhs);
+  const std::size_t rows = l.columns();
+  const std::size_t columns = r.columns();
+
+  if (l.holds<std::int64_t>() && r.holds<std::int64_t>()) {
+    const std::span<const std::int64_t> a = l.elements().get<std::int64_t>();
+    const std::span<const std::int64_t> b = r.elements().get<std::int64_t>();
+    std::vector<std::int64_t> result(rows * columns);
+    bool overflow = false;
+    for (std::size_t i = 0; i < rows; ++i)
+      for (std::size_t j = 0; j < columns; ++j)
+        overflow |=
+            __builtin_mul_overflow(a[i], b[j], &result[i * columns + j]);
+
+    if (!overflow)
+      return tmatrix{rows, columns, tvector{std::move(result)}};
+  }
+
+  const tmatrix a = to_double(l);
+  const tmatrix b = to_double(r);
+  const std::span<const double> elements = b.elements().get<double>();
+  std::vector<double> result(rows * columns);
+  simd::tmultiplies multiplies;
+  for (std::size_t i = 0; i < rows; ++i)
+    simd::transform(result.data() + i * columns, columns,
+                    simd::tbroadcast<double>{a.elements().get<double>()[i]},
+                    simd::tarray<double>{elements.data()}, multiplies);
+
+  return tmatrix{rows, columns, tvector{std::move(result)}};
+}
+
+/*** Matrix multiplication ***/
+
+// The floating-point multiplication uses the structure of GotoBLAS:
+// - The matrices are split in blocks that fit in the caches; the block of B
+//   in the L3 cache, the block of A in the L2 cache.
+// - The blocks are packed in panels. This copy stores the elements in the
+//   order the micro-kernel reads them.
+// - The micro-kernel calculates a tile of C in registers.
+
+/** The number of rows of a tile of C. */
+static constexpr std::size_t mr = 4;
+/** The number of columns of a tile of C, two SIMD registers. */
+static constexpr std::size_t nr = 2 * simd::lanes<double>;
+
+/** The depth of the blocks of A and B. */
+static constexpr std::size_t kc = 256;
+/** The number of rows of a block of A. */
+static constexpr std::size_t mc = 128;
+/** The number of columns of a block of B. */
+static constexpr std::size_t nc = 2048;
+
+/** The minimal number of multiply-adds processed by one thread. */
+static constexpr std::size_t matmul_grain_size = std::size_t(1) << 22;
+
+/**
+ * Calculates a tile of C += A * B.
+ *
+ * The @p a panel stores the @ref mr elements of a column contiguously, the
+ * @p b panel stores the @ref nr elements of a row contiguously. The panels
+ * are padded with zeros, only the @p rows by @p columns elements of the tile
+ * are stored in @p c.
+ */
+[[gnu::always_inline]] inline void
+micro_kernel(std::size_t depth, const double *a, const double *b, double *c,
+             std::size_t stride, std::size_t rows, std::size_t columns) {
+  using tregister = simd::tregister<double>;
+  static constexpr std::size_t lanes = simd::lanes<double>;
+
+  tregister c00{}, c01{}, c10{}, c11{}, c20{}, c21{}, c30{}, c31{};
+  for (std::size_t p = 0; p < depth; ++p, a += mr, b += nr) {
+    tregister b0, b1;
+    __builtin_memcpy(&b0, b, sizeof(b0));
+    __builtin_memcpy(&b1, b + lanes, sizeof(b1));
+
+    const tregister a0 = tregister{} + a[0];
+    c00 += a0 * b0;
+    c01 += a0 * b1;
+    const tregister a1 = tregister{} + a[1];
+    c10 += a1 * b0;
+    c11 += a1 * b1;
+    const tregister a2 = tregister{} + a[2];
+    c20 += a2 * b0;
+    c21 += a2 * b1;
+    const tregister a3 = tregister{} + a[3];
+    c30 += a3 * b0;
+    c31 += a3 * b1;
+  }
+
+  const std::array<tregister, 2 * mr> registers{c00, c01, c10, c11,
+                                                c20, c21, c30, c31};
+  double tile[mr][nr];
+  __builtin_memcpy(tile, registers.data(), sizeof(tile));
+  for (std::size_t i = 0; i < rows; ++i)
+    for (std::size_t j = 0; j < columns; ++j)
+      c[i * stride + j] += tile[i][j];
+}
+
+/** Calculates C += A * B for packed blocks of A and B. */
+[[gnu::always_inline]] inline void
+block_kernel(const double *a, const double *b, double *c, std::size_t stride,
+             std::size_t rows, std::size_t columns, std::size_t depth) {
+  for (std::size_t j = 0; j < columns; j += nr)
+    for (std::size_t i = 0; i < rows; i += mr)
+      micro_kernel(depth, a + i * depth, b + j * depth, c + i * stride + j,
+                   stride, std::min(mr, rows - i), std::min(nr, columns - j));
+}
+
+#if defined(__x86_64__)
+[[gnu::target("avx2,fma")]] static void
+block_avx2(const double *a, const double *b, double *c, std::size_t stride,
+           std::size_t rows, std::size_t columns, std::size_t depth) {
+  block_kernel(a, b, c, stride, rows, columns, depth);
+}
+#endif
+
+static void block_default(const double *a, const double *b, double *c,
+                          std::size_t stride, std::size_t rows,
+                          std::size_t columns, std::size_t depth) {
+  block_kernel(a, b, c, stride, rows, columns, depth);
+}
+
+static void block(const double *a, const double *b, double *c,
+                  std::size_t stride, std::size_t rows, std::size_t columns,
+                  std::size_t depth) {
+#if defined(__x86_64__)
+  static const bool avx2 =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  if (avx2)
+    return block_avx2(a, b, c, stride, rows, columns, depth);
+#endif
+  block_default(a, b, c, stride, rows, columns, depth);
+}
+
+/** Packs @p rows rows of A in panels of @ref mr rows. */
+static void pack_a(const double *a, std::size_t stride, std::size_t rows,
+                   std::size_t depth, double *packed) {
+  for (std::size_t i = 0; i < rows; i += mr)
+    for (std::size_t p = 0; p < depth; ++p)
+      for (std::size_t r = 0; r < mr; ++r)
+        *packed++ = i + r < rows ? a[(i + r) * stride + p] : 0.;
+}
+
+/** Packs @p columns columns of B in panels of @ref nr columns. */
+static void pack_b(const double *b, std::size_t stride, std::size_t depth,
+                   std::size_t columns, double *packed) {
+  for (std::size_t j = 0; j < columns; j += nr)
+    for (std::size_t p = 0; p < depth; ++p)
+      for (std::size_t c = 0; c < nr; ++c)
+        *packed++ = j + c < columns ? b[p * stride + j + c] : 0.;
+}
+
+/**
+ * Calculates the rows [@p first, @p last) of C += A * B.
+ *
+ * A is a matrix with @p k columns, B and C have @p n columns. The rows of the
+ * matrices are @p lda, @p ldb, and @p ldc elements apart, this allows to
+ * multiply submatrices in place.
+ */
+static void multiply(const double *a, std::size_t lda, const double *b,
+                     std::size_t ldb, double *c, std::size_t ldc,
+                     std::size_t k, std::size_t n, std::size_t first,
+                     std::size_t last) {
+  // The panels are padded to a multiple of the tile size.
+  auto padded = [](std::size_t size, std::size_t multiple) {
+    return (size + multiple - 1) / multiple * multiple;
+  };
+  std::vector<double> packed_a(std::min(mc, padded(last - first, mr)) *
+                               std::min(kc, k));
+  std::vector<double> packed_b(std::min(nc, padded(n, nr)) * std::min(kc, k));
+  for (std::size_t jc = 0; jc < n; jc += nc) {
+    const std::size_t columns = std::min(nc, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += kc) {
+      const std::size_t depth = std::min(kc, k - pc);
+      pack_b(b + pc * ldb + jc, ldb, depth, columns, packed_b.data());
+      for (std::size_t ic = first; ic < last; ic += mc) {
+        const std::size_t rows = std::min(mc, last - ic);
+        pack_a(a + ic * lda + pc, lda, rows, depth, packed_a.data());
+        block(packed_a.data(), packed_b.data(), c + ic * ldc + jc, ldc, rows,
+              columns, depth);
+      }
+    }
+  }
+}
+
+/** The number of rows of C processed by one thread. */
+static std::size_t grain_size(std::size_t k, std::size_t n) {
+  return std::max<std::size_t>(1, matmul_grain_size / std::max<std::size_t>(
+                                                          1, k * n));
+}
+
+/** Multiplies the m x k matrix @p a with the k x n matrix @p b. */
+static std::vector<double> multiply(std::span<const double> a,
+                                    std::span<const double> b, std::size_t m,
+                                    std::size_t k, std::size_t n) {
+  std::vector<double> result(m * n);
+  lib::parallel_for(
+      m,
+      [&](std::size_t first, std::size_t last) {
+        multiply(a.data(), k, b.data(), n, result.data(), n, k, n, first,
+                 last);
+      },
+      grain_size(k, n));
+  return result;
+}
+
+/**
+ * Multiplies the m x k matrix @p a with the k x n matrix @p b exactly.
+ *
+ * There are no SIMD instructions for 64-bit integral multiplications with
+ * overflow detection, so this uses a scalar loop.
+ *
+ * @returns The result or @c std::nullopt when an element of the result
+ * doesn't fit in an @c std::int64_t.
+ */
+static std::optional<tmatrix> multiply(std::span<const std::int64_t> a,
+                                       std::span<const std::int64_t> b,
+                                       std::size_t m, std::size_t k,
+                                       std::size_t n) {
+  std::vector<__int128_t> result(m * n);
+  std::atomic<bool> overflow{false};
+  lib::parallel_for(
+      m,
+      [&](std::size_t first, std::size_t last) {
+        bool failed = false;
+        for (std::size_t i = first; i < last; ++i) {
+          __int128_t *row = result.data() + i * n;
+          for (std::size_t p = 0; p < k; ++p) {
+            const __int128_t value = a[i * k + p];
+            for (std::size_t j = 0; j < n; ++j)
+              failed |= __builtin_add_overflow(row[j], value * b[p * n + j],
+                                               &row[j]);
+          }
+        }
+        if (failed)
+          overflow.store(true, std::memory_order_relaxed);
+      },
+      grain_size(k, n));
+
+  if (overflow.load(std::memory_order_relaxed))
+    return std::nullopt;
+
+  return to_matrix(m, n, result);
+}
+
+/**
+ * @see https://mordante.github.io/rpn/calculation.html#matrix-multiplication
+ */
+export tstorage matmul(tstorage lhs, tstorage rhs) {
+  const tmatrix &l = get_matrix(lhs);
+  const tmatrix &r = get_matrix(rhs);
+  if (l.columns() != r.rows())
+    throw std::domain_error("Matrix sizes differ");
+
+  const std::size_t m = l.rows();
+  const std::size_t k = l.columns();
+  const std::size_t n = r.columns();
+  if (l.holds<std::int64_t>() && r.holds<std::int64_t>())
+    if (std::optional<tmatrix> result =
+            multiply(l.elements().get<std::int64_t>(),
+                     r.elements().get<std::int64_t>(), m, k, n))
+      return *result;
+
+  return tmatrix{m, n,
+                 tvector{multiply(to_double(l).elements().get<double>(),
+                                  to_double(r).elements().get<double>(), m, k,
+                                  n)}};
+}
+
+/*** LU decomposition ***/
+
+/** @throws std::domain_error when @p value is not a square matrix. */
+static const tmatrix &get_square_matrix(const tstorage &value) {
+  const tmatrix &matrix = get_matrix(value);
+  if (matrix.rows() != matrix.columns())
+    throw std::domain_error("Not a square matrix");
+  return matrix;
+}
+
+/** The number of columns of a panel of the blocked LU decomposition. */
+static constexpr std::size_t lu_block = 64;
+
+/**
+ * The LU decomposition with partial pivoting P * A = L * U.
+ *
+ * Like LAPACK the factors are stored in one matrix; L below the diagonal, its
+ * unit diagonal isn't stored, and U on and above the diagonal.
+ */
+struct tlu {
+  std::size_t size;
+  std::vector<double> elements;
+  /** Row @c i of P * A is row @c permutation[i] of A. */
+  std::vector<std::size_t> permutation;
+  /** Whether P is an odd permutation. */
+  bool odd{false};
+
+  [[nodiscard]] bool singular() const noexcept {
+    for (std::size_t i = 0; i < size; ++i)
+      if (elements[i * size + i] == 0.)
+        return true;
+    return false;
+  }
+};
+
+/**
+ * Factorizes the columns [@p first, @p last) of the matrix.
+ *
+ * The rows of the panel are swapped in the entire matrix, the columns right of
+ * the panel are updated by the caller.
+ */
+static void factorize_panel(tlu &lu, std::size_t first, std::size_t last) {
+  const std::size_t n = lu.size;
+  double *a = lu.elements.data();
+  for (std::size_t j = first; j < last; ++j) {
+    std::size_t pivot = j;
+    for (std::size_t i = j + 1; i < n; ++i)
+      if (std::abs(a[i * n + j]) > std::abs(a[pivot * n + j]))
+        pivot = i;
+
+    // The column is zero, so there is nothing to eliminate.
+    if (a[pivot * n + j] == 0.)
+      continue;
+
+    if (pivot != j) {
+      std::swap_ranges(a + j * n, a + (j + 1) * n, a + pivot * n);
+      std::swap(lu.permutation[j], lu.permutation[pivot]);
+      lu.odd = !lu.odd;
+    }
+
+    const double *row = a + j * n;
+    for (std::size_t i = j + 1; i < n; ++i) {
+      double *target = a + i * n;
+      const double l = target[j] /= row[j];
+      for (std::size_t c = j + 1; c < last; ++c)
+        target[c] -= l * row[c];
+    }
+  }
+}
+
+/**
+ * Calculates the blocked right-looking LU decomposition.
+ *
+ * After factorizing a panel of @ref lu_block columns the block row right of it
+ * is solved for U and the trailing matrix is updated with a matrix
+ * multiplication. This multiplication does nearly all floating-point
+ * operations, so it uses the cache-blocked kernel and multiple threads.
+ */
+static tlu decompose(const tmatrix &matrix) {
+  const std::size_t n = matrix.rows();
+  const tmatrix values = to_double(matrix);
+  const std::span<const double> elements = values.elements().get<double>();
+  tlu lu{n, std::vector<double>(elements.begin(), elements.end()),
+         std::vector<std::size_t>(n)};
+  std::iota(lu.permutation.begin(), lu.permutation.end(), 0);
+
+  double *a = lu.elements.data();
+  for (std::size_t k = 0; k < n; k += lu_block) {
+    const std::size_t b = std::min(lu_block, n - k);
+    factorize_panel(lu, k, k + b);
+
+    const std::size_t trailing = n - k - b;
+    if (trailing == 0)
+      break;
+
+    // U12 = L11^-1 * A12, the columns are independent.
+    double *a12 = a + k * n + k + b;
+    lib::parallel_for(
+        trailing,
+        [&](std::size_t first, std::size_t last) {
+          for (std::size_t i = 1; i < b; ++i)
+            for (std::size_t p = 0; p < i; ++p) {
+              const double l = a[(k + i) * n + k + p];
+              for (std::size_t c = first; c < last; ++c)
+                a12[i * n + c] -= l * a12[p * n + c];
+            }
+        },
+        grain_size(b, b));
+
+    // A22 -= L21 * U12
+    std::vector<double> l21(trailing * b);
+    for (std::size_t i = 0; i < trailing; ++i)
+      for (std::size_t p = 0; p < b; ++p)
+        l21[i * b + p] = -a[(k + b + i) * n + k + p];
+
+    lib::parallel_for(
+        trailing,
+        [&](std::size_t first, std::size_t last) {
+          multiply(l21.data(), b, a12, n, a12 + b * n, n, b, trailing, first,
+                   last);
+        },
+        grain_size(b, trailing));
+  }
+
+  return lu;
+}
+
+/**
+ * Solves A * X = B for the @p columns columns of B.
+ *
+ * The triangular systems are solved in blocks of @ref lu_block rows. Within a
+ * block the rows are solved one at a time, the other rows are updated with a
+ * matrix multiplication. The micro-kernel calculates @ref nr columns at once,
+ * for fewer columns the system is solved as one block. The columns of X are
+ * independent, so they are distributed over the threads.
+ *
+ * @pre @p lu is not singular.
+ */
+static std::vector<double> substitute(const tlu &lu, std::span<const double> b,
+                                      std::size_t columns) {
+  const std::size_t n = lu.size;
+  const double *a = lu.elements.data();
+  std::vector<double> x(n * columns);
+  for (std::size_t i = 0; i < n; ++i)
+    std::ranges::copy(b.subspan(lu.permutation[i] * columns, columns),
+                      x.begin() + i * columns);
+
+  const std::size_t block = columns < nr ? n : lu_block;
+
+  // The matrix multiplication calculates C += A * B, the negated factors
+  // calculate C -= A * B.
+  std::vector<double> negated;
+  if (block != n) {
+    negated.resize(lu.elements.size());
+    std::ranges::transform(lu.elements, negated.begin(), std::negate{});
+  }
+
+  // Updates the range [first, last) of the rows of X.
+  auto update = [&](std::size_t row, std::size_t p, double factor,
+                    std::size_t first, std::size_t last) {
+    double *target = x.data() + row * columns;
+    const double *source = x.data() + p * columns;
+    for (std::size_t c = first; c < last; ++c)
+      target[c] -= factor * source[c];
+  };
+
+  lib::parallel_for(
+      columns,
+      [&](std::size_t first, std::size_t last) {
+        const std::size_t width = last - first;
+        double *y = x.data() + first;
+
+        // L * Y = P * B, L has a unit diagonal.
+        for (std::size_t k = 0; k < n; k += block) {
+          const std::size_t size = std::min(block, n - k);
+          for (std::size_t i = k + 1; i < k + size; ++i)
+            for (std::size_t p = k; p < i; ++p)
+              update(i, p, a[i * n + p], first, last);
+
+          if (k + size < n)
+            multiply(negated.data() + (k + size) * n + k, n, y + k * columns,
+                     columns, y + (k + size) * columns, columns, size, width,
+                     0, n - k - size);
+        }
+
+        // U * X = Y
+        for (std::size_t end = n; end > 0;) {
+          const std::size_t k = end > block ? end - block : 0;
+          if (end < n)
+            multiply(negated.data() + k * n + end, n, y + end * columns,
+                     columns, y + k * columns, columns, n - end, width, 0,
+                     end - k);
+
+          for (std::size_t i = end; i-- > k;) {
+            for (std::size_t p = i + 1; p < end; ++p)
+              update(i, p, a[i * n + p], first, last);
+            const double u = a[i * n + i];
+            for (std::size_t c = first; c < last; ++c)
+              x[i * columns + c] /= u;
+          }
+          end = k;
+        }
+      },
+      grain_size(n, n));
+
+  return x;
+}
+
+/** @throws std::domain_error when the matrix is singular. */
+static tlu decompose_regular(const tmatrix &matrix) {
+  tlu lu = decompose(matrix);
+  if (lu.singular())
+    throw std::domain_error("The matrix is singular");
+  return lu;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#lu-decomposition */
+export std::array<tstorage, 3> lu(tstorage value) {
+  const tlu lu = decompose(get_square_matrix(value));
+  const std::size_t n = lu.size;
+
+  std::vector<std::int64_t> p(n * n);
+  std::vector<double> l(n * n);
+  std::vector<double> u(n * n);
+  for (std::size_t i = 0; i < n; ++i) {
+    p[i * n + lu.permutation[i]] = 1;
+    l[i * n + i] = 1.;
+    for (std::size_t j = 0; j < n; ++j)
+      (j < i ? l : u)[i * n + j] = lu.elements[i * n + j];
+  }
+
+  return {tmatrix{n, n, tvector{std::move(p)}},
+          tmatrix{n, n, tvector{std::move(l)}},
+          tmatrix{n, n, tvector{std::move(u)}}};
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#solve */
+export tstorage solve(tstorage lhs, tstorage rhs) {
+  const tmatrix &a = get_square_matrix(lhs);
+  const bool vector = std::holds_alternative<tvector>(rhs);
+  tmatrix b = vector ? get_vector(rhs) : get_matrix(rhs);
+  // A vector is used as a column, its elements are in the same order.
+  if (vector)
+    b = tmatrix{b.columns(), 1, b.elements()};
+  if (b.rows() != a.rows())
+    throw std::domain_error("Matrix sizes differ");
+
+  std::vector<double> x = substitute(
+      decompose_regular(a), to_double(b).elements().get<double>(), b.columns());
+  if (vector)
+    return tvector{std::move(x)};
+
+  return tmatrix{b.rows(), b.columns(), tvector{std::move(x)}};
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#inverse */
+export tstorage inv(tstorage value) {
+  const tmatrix &a = get_square_matrix(value);
+  const std::size_t n = a.rows();
+  std::vector<double> identity(n * n);
+  for (std::size_t i = 0; i < n; ++i)
+    identity[i * n + i] = 1.;
+
+  return tmatrix{n, n,
+                 tvector{substitute(decompose_regular(a), identity, n)}};
+}
+
+/**
+ * Calculates the exact determinant with the Bareiss algorithm.
+ *
+ * The algorithm only uses exact divisions, every intermediate result is a
+ * minor of the matrix.
+ *
+ * @returns The determinant or @c std::nullopt when an intermediate result
+ * doesn't fit in an @c __int128_t.
+ */
+static std::optional<tstorage>
+determinant(std::span<const std::int64_t> elements, std::size_t n) {
+  std::vector<__int128_t> a(elements.begin(), elements.end());
+  __int128_t previous = 1;
+  bool odd = false;
+  for (std::size_t k = 0; k + 1 < n; ++k) {
+    if (a[k * n + k] == 0) {
+      std::size_t pivot = k + 1;
+      while (pivot < n && a[pivot * n + k] == 0)
+        ++pivot;
+      if (pivot == n)
+        return std::int64_t(0);
+
+      std::swap_ranges(a.begin() + k * n, a.begin() + (k + 1) * n,
+                       a.begin() + pivot * n);
+      odd = !odd;
+    }
+
+    for (std::size_t i = k + 1; i < n; ++i)
+      for (std::size_t j = k + 1; j < n; ++j) {
+        __int128_t lhs;
+        __int128_t rhs;
+        if (__builtin_mul_overflow(a[i * n + j], a[k * n + k], &lhs) ||
+            __builtin_mul_overflow(a[i * n + k], a[k * n + j], &rhs) ||
+            __builtin_sub_overflow(lhs, rhs, &lhs))
+          return std::nullopt;
+        a[i * n + j] = lhs / previous;
+      }
+    previous = a[k * n + k];
+  }
+
+  const __int128_t result = a.back();
+  return to_storage<std::int64_t>(odd ? -result : result);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#determinant */
+export tstorage det(tstorage value) {
+  const tmatrix &a = get_square_matrix(value);
+  if (a.holds<std::int64_t>())
+    if (std::optional<tstorage> result =
+            determinant(a.elements().get<std::int64_t>(), a.rows()))
+      return *result;
+
+  const tlu lu = decompose(a);
+  double result = lu.odd ? -1. : 1.;
+  for (std::size_t i = 0; i < lu.size; ++i)
+    result *= lu.elements[i * lu.size + i];
+  return result;
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.matrix;
+
+export import calculator.math.vector;
+import std;
+
+namespace calculator {
+namespace math {
+
+/**
+ * A dense matrix of numeric values.
+ *
+ * The elements are stored in row-major order in a @ref tvector, so like a
+ * vector the elements are shared between copies. The elements are either
+ * @c std::int64_t or @c double values.
+ */
+export class tmatrix final {
+public:
+  /**
+   * @pre @p rows * @p columns == @c elements.size().
+   * @pre @p elements holds @c std::int64_t or @c double values.
+   */
+  tmatrix(std::size_t rows, std::size_t columns, tvector elements) noexcept
+      : rows_(rows), columns_(columns), elements_(std::move(elements)) {}
+
+  /** Two matrices are equal when their shapes and elements are equal. */
+  friend bool operator==(const tmatrix &lhs, const tmatrix &rhs) = default;
+
+  [[nodiscard]] std::size_t rows() const noexcept { return rows_; }
+  [[nodiscard]] std::size_t columns() const noexcept { return columns_; }
+
+  /** The elements in row-major order. */
+  [[nodiscard]] const tvector &elements() const noexcept { return elements_; }
+
+  template <is_element T> [[nodiscard]] bool holds() const noexcept {
+    return elements_.holds<T>();
+  }
+
+  /**
+   * Calls @p visitor with a @c std::span<const T> of the elements in
+   * row-major order.
+   */
+  template <class Visitor> decltype(auto) visit(Visitor &&visitor) const {
+    return elements_.visit(std::forward<Visitor>(visitor));
+  }
+
+private:
+  std::size_t rows_;
+  std::size_t columns_;
+  tvector elements_;
+};
+
+/**
+ * Creates a matrix from the elements of a vector.
+ *
+ * A matrix doesn't store @c std::uint64_t elements. These are converted to
+ * @c std::int64_t when all elements fit, else to @c double.
+ *
+ * @pre @p rows * @p columns == @c elements.size().
+ */
+export tmatrix make_matrix(std::size_t rows, std::size_t columns,
+                           tvector elements) {
+  if (!elements.holds<std::uint64_t>())
+    return tmatrix{rows, columns, std::move(elements)};
+
+  const std::span<const std::uint64_t> values = elements.get<std::uint64_t>();
+  if (std::ranges::all_of(values, [](std::uint64_t value) {
+        return value <= static_cast<std::uint64_t>(
+                            std::numeric_limits<std::int64_t>::max());
+      }))
+    return tmatrix{rows, columns,
+                   tvector{std::vector<std::int64_t>(values.begin(),
+                                                     values.end())}};
+
+  return tmatrix{rows, columns,
+                 tvector{std::vector<double>(values.begin(), values.end())}};
+}
+
+} // namespace math
+} // namespace calculator
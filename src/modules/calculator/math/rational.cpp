@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.rational;
+
+import std;
+
+namespace calculator {
+namespace math {
+
+/**
+ * An exact fraction.
+ *
+ * The value is normalised; the sign is stored in the numerator and the
+ * denominator is always positive.
+ *
+ * The fraction is not always in its lowest terms. The kernels only reduce
+ * when an intermediate result doesn't fit, which avoids a GCD calculation
+ * for every step in a chain of operations. Use @ref reduce to get the lowest
+ * terms, e.g. before displaying the value.
+ */
+export struct trational {
+  std::int64_t numerator;
+  std::int64_t denominator;
+
+  /** Compares the values, the fractions need not be in their lowest terms. */
+  friend constexpr bool operator==(trational lhs, trational rhs) {
+    return static_cast<__int128_t>(lhs.numerator) * rhs.denominator ==
+           static_cast<__int128_t>(rhs.numerator) * lhs.denominator;
+  }
+};
+
+/**
+ * Calculates the greatest common divisor using Stein's algorithm.
+ *
+ * This replaces the divisions of Euclid's algorithm by shifts, which is a lot
+ * cheaper for 128-bit values.
+ */
+static constexpr __uint128_t gcd(__uint128_t lhs, __uint128_t rhs) {
+  if (lhs == 0)
+    return rhs;
+  if (rhs == 0)
+    return lhs;
+
+  const auto ctz = [](__uint128_t value) {
+    const std::uint64_t low = static_cast<std::uint64_t>(value);
+    if (low)
+      return std::countr_zero(low);
+    return 64 + std::countr_zero(static_cast<std::uint64_t>(value >> 64));
+  };
+
+  const int shift = ctz(lhs | rhs);
+  lhs >>= ctz(lhs);
+  do {
+    rhs >>= ctz(rhs);
+    if (lhs > rhs)
+      std::swap(lhs, rhs);
+    rhs -= lhs;
+  } while (rhs);
+
+  return lhs << shift;
+}
+
+/**
+ * Creates a normalised fraction.
+ *
+ * The fraction is only reduced when it doesn't fit in a @ref trational.
+ *
+ * @pre @p denominator != 0.
+ * @pre The magnitude of @p numerator and @p denominator is less than 2^127.
+ *
+ * @returns The fraction or @c std::nullopt when the reduced fraction doesn't
+ * fit.
+ */
+export constexpr std::optional<trational>
+make_rational(__int128_t numerator, __int128_t denominator) {
+  if (denominator < 0) {
+    numerator = -numerator;
+    denominator = -denominator;
+  }
+
+  const auto fits = [](__int128_t value) {
+    return value >= std::numeric_limits<std::int64_t>::min() &&
+           value <= std::numeric_limits<std::int64_t>::max();
+  };
+
+  if (!fits(numerator) || !fits(denominator)) {
+    const __int128_t divisor = static_cast<__int128_t>(
+        gcd(numerator < 0 ? -static_cast<__uint128_t>(numerator)
+                          : static_cast<__uint128_t>(numerator),
+            static_cast<__uint128_t>(denominator)));
+    numerator /= divisor;
+    denominator /= divisor;
+    if (!fits(numerator) || !fits(denominator))
+      return std::nullopt;
+  }
+
+  return trational{static_cast<std::int64_t>(numerator),
+                   static_cast<std::int64_t>(denominator)};
+}
+
+/** Returns the fraction in its lowest terms. */
+export constexpr trational reduce(trational value) {
+  const __uint128_t numerator =
+      value.numerator < 0 ? -static_cast<__uint128_t>(value.numerator)
+                          : static_cast<__uint128_t>(value.numerator);
+  const std::int64_t divisor = static_cast<std::int64_t>(
+      gcd(numerator, static_cast<__uint128_t>(value.denominator)));
+
+  return trational{value.numerator / divisor, value.denominator / divisor};
+}
+
+} // namespace math
+} // namespace calculator
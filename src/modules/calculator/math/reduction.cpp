@@ -0,0 +1,708 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.reduction;
+
+export import calculator.math.core;
+import calculator.math.arithmetic;
+import calculator.math.simd;
+import lib.parallel;
+import std;
+
+// The SIMD operations are always inlined in the kernels of
+// calculator.math.simd, see there for the ABI warning.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace calculator {
+namespace math {
+
+/**
+ * The algorithm used to sum @c double values.
+ *
+ * @see https://mordante.github.io/rpn/calculation.html#summation
+ */
+export enum class tsummation {
+  /** Adds the values in order, the fastest and least accurate. */
+  naive,
+  /** Adds the values in a binary tree. */
+  pairwise,
+  /** Adds the values with Neumaier's compensated summation. */
+  neumaier
+};
+
+static bool is_nan(const tstorage &value) {
+  return std::holds_alternative<double>(value) &&
+         std::isnan(std::get<double>(value));
+}
+
+/*** SIMD operations ***/
+
+/**
+ * Sums integral elements without overflowing.
+ *
+ * Every lane counts its carries. A signed element is biased by 2^63, which
+ * makes it unsigned, the bias is removed in @ref result.
+ */
+template <bool Signed> struct twide_sum {
+  simd::tregister<std::uint64_t> sum{};
+  simd::tregister<std::uint64_t> carry{};
+  __uint128_t tail{0};
+
+  static constexpr std::uint64_t bias = Signed ? std::uint64_t(1) << 63 : 0;
+
+  [[gnu::always_inline]] void
+  operator()(simd::tregister<std::uint64_t> value) {
+    value ^= bias;
+    const simd::tregister<std::uint64_t> result = sum + value;
+    carry += ((sum & value) | ((sum | value) & ~result)) >> 63;
+    sum = result;
+  }
+
+  [[gnu::always_inline]] void operator()(std::uint64_t value) {
+    tail += value ^ bias;
+  }
+
+  [[nodiscard]] __int128_t result(std::size_t size) const {
+    __uint128_t result = tail;
+    for (std::size_t i = 0; i < simd::lanes<std::uint64_t>; ++i)
+      result += (static_cast<__uint128_t>(carry[i]) << 64) + sum[i];
+
+    return static_cast<__int128_t>(result) -
+           static_cast<__int128_t>(size) * static_cast<__int128_t>(bias);
+  }
+};
+
+struct tdouble_sum {
+  simd::tregister<double> sum{};
+  double tail{0.};
+
+  [[gnu::always_inline]] void operator()(simd::tregister<double> value) {
+    sum += value;
+  }
+  [[gnu::always_inline]] void operator()(double value) { tail += value; }
+
+  [[nodiscard]] double result() const {
+    double result = tail;
+    for (std::size_t i = 0; i < simd::lanes<double>; ++i)
+      result += sum[i];
+    return result;
+  }
+};
+
+/**
+ * Adds @p value to @p sum and adds the rounding error to @p compensation.
+ *
+ * This is Neumaier's improvement of Kahan summation, which is also accurate
+ * when @p value is larger than @p sum. The rounding error is calculated with
+ * Knuth's TwoSum, unlike Neumaier's original this needs no comparison of the
+ * magnitudes, which makes it faster with SIMD instructions.
+ */
+template <class V>
+[[gnu::always_inline]] inline void neumaier_add(V &sum, V &compensation,
+                                                V value) {
+  const V result = sum + value;
+  const V rounded = result - sum;
+  compensation += (sum - (result - rounded)) + (value - rounded);
+  sum = result;
+}
+
+struct tdouble_neumaier_sum {
+  simd::tregister<double> sum{};
+  simd::tregister<double> compensation{};
+  double tail{0.};
+  double tail_compensation{0.};
+
+  [[gnu::always_inline]] void operator()(simd::tregister<double> value) {
+    neumaier_add(sum, compensation, value);
+  }
+  [[gnu::always_inline]] void operator()(double value) {
+    neumaier_add(tail, tail_compensation, value);
+  }
+};
+
+struct tdouble_product {
+  simd::tregister<double> product = simd::tregister<double>{} + 1.;
+  double tail{1.};
+
+  [[gnu::always_inline]] void operator()(simd::tregister<double> value) {
+    product *= value;
+  }
+  [[gnu::always_inline]] void operator()(double value) { tail *= value; }
+
+  [[nodiscard]] double result() const {
+    double result = tail;
+    for (std::size_t i = 0; i < simd::lanes<double>; ++i)
+      result *= product[i];
+    return result;
+  }
+};
+
+/**
+ * Finds the minimum or maximum element.
+ *
+ * A NaN is never selected, instead it's recorded in @c unordered.
+ */
+template <class T, bool Maximum> struct textremum {
+  static constexpr T initial = [] {
+    if constexpr (std::same_as<T, double>)
+      return Maximum ? -std::numeric_limits<double>::infinity()
+                     : std::numeric_limits<double>::infinity();
+    else
+      return Maximum ? std::numeric_limits<T>::min()
+                     : std::numeric_limits<T>::max();
+  }();
+
+  simd::tregister<T> extremum = simd::tregister<T>{} + initial;
+  simd::tregister<std::int64_t> unordered{};
+  T tail{initial};
+  bool unordered_tail{false};
+
+  template <class V>
+  [[gnu::always_inline]] static V select(V value, V current) {
+    if constexpr (Maximum)
+      return value > current ? value : current;
+    else
+      return value < current ? value : current;
+  }
+
+  [[gnu::always_inline]] void operator()(simd::tregister<T> value) {
+    if constexpr (std::same_as<T, double>)
+      unordered |= value != value;
+    extremum = select(value, extremum);
+  }
+
+  [[gnu::always_inline]] void operator()(T value) {
+    if constexpr (std::same_as<T, double>)
+      unordered_tail |= std::isnan(value);
+    tail = select(value, tail);
+  }
+
+  [[nodiscard]] bool nan() const {
+    bool result = unordered_tail;
+    for (std::size_t i = 0; i < simd::lanes<std::int64_t>; ++i)
+      result |= unordered[i] != 0;
+    return result;
+  }
+
+  [[nodiscard]] T result() const {
+    T result = tail;
+    for (std::size_t i = 0; i < simd::lanes<T>; ++i)
+      result = select(extremum[i], result);
+    return result;
+  }
+};
+
+/*** Reducers ***/
+
+// A reducer processes a part of the elements. The parts are processed in
+// parallel and afterwards merged in order.
+
+/**
+ * Sums @c double values.
+ *
+ * The specializations implement the @ref tsummation modes. They accept
+ * single values and spans of elements; the latter are processed with SIMD
+ * instructions.
+ */
+template <tsummation Summation> class tfloating_point_sum;
+
+template <> class tfloating_point_sum<tsummation::naive> final {
+public:
+  void add(double value) { sum_ += value; }
+
+  void add(std::span<const double> elements) {
+    tdouble_sum operation;
+    simd::accumulate(elements.data(), elements.size(), operation);
+    sum_ += operation.result();
+  }
+
+  void merge(const tfloating_point_sum &other) { sum_ += other.sum_; }
+
+  [[nodiscard]] double result() const { return sum_; }
+
+private:
+  double sum_{0.};
+};
+
+/**
+ * Pairwise summation.
+ *
+ * The elements are summed naively in blocks, the sums of the blocks are
+ * combined pairwise. Like a binary counter, level @c i contains the sum of
+ * 2^i blocks. This gives an error of O(log n) instead of O(n) without storing
+ * all elements.
+ */
+template <> class tfloating_point_sum<tsummation::pairwise> final {
+public:
+  void add(double value) {
+    block_ += value;
+    if (++count_ == block_size)
+      flush();
+  }
+
+  void add(std::span<const double> elements) {
+    while (!elements.empty()) {
+      const std::size_t size =
+          std::min(block_size - count_, elements.size());
+      tdouble_sum operation;
+      simd::accumulate(elements.data(), size, operation);
+      block_ += operation.result();
+      count_ += size;
+      if (count_ == block_size)
+        flush();
+
+      elements = elements.subspan(size);
+    }
+  }
+
+  void merge(const tfloating_point_sum &other) { push(other.result()); }
+
+  [[nodiscard]] double result() const {
+    double result = block_;
+    for (std::size_t level = 0; level < levels_.size(); ++level)
+      if (occupied_ & (std::uint64_t(1) << level))
+        result += levels_[level];
+    return result;
+  }
+
+private:
+  static constexpr std::size_t block_size = 128;
+
+  void flush() {
+    push(block_);
+    block_ = 0.;
+    count_ = 0;
+  }
+
+  void push(double value) {
+    std::size_t level = 0;
+    for (; occupied_ & (std::uint64_t(1) << level); ++level) {
+      value += levels_[level];
+      occupied_ &= ~(std::uint64_t(1) << level);
+    }
+    levels_[level] = value;
+    occupied_ |= std::uint64_t(1) << level;
+  }
+
+  double block_{0.};
+  std::size_t count_{0};
+
+  std::array<double, 64> levels_{};
+  /** The set bits are the levels containing a value. */
+  std::uint64_t occupied_{0};
+};
+
+/** Neumaier compensated summation. */
+template <> class tfloating_point_sum<tsummation::neumaier> final {
+public:
+  void add(double value) { neumaier_add(sum_, compensation_, value); }
+
+  void add(std::span<const double> elements) {
+    tdouble_neumaier_sum operation;
+    simd::accumulate(elements.data(), elements.size(), operation);
+    for (std::size_t i = 0; i < simd::lanes<double>; ++i) {
+      add(operation.sum[i]);
+      compensation_ += operation.compensation[i];
+    }
+    add(operation.tail);
+    compensation_ += operation.tail_compensation;
+  }
+
+  void merge(const tfloating_point_sum &other) {
+    add(other.sum_);
+    compensation_ += other.compensation_;
+  }
+
+  [[nodiscard]] double result() const { return sum_ + compensation_; }
+
+private:
+  double sum_{0.};
+  double compensation_{0.};
+};
+
+template <tsummation Summation> class tsum final {
+public:
+  /** Adds the elements [first, last) of @p value. */
+  void add(const tstorage &value, std::size_t first, std::size_t last) {
+    if (const tvector *vector = get_elements(value)) {
+      if (vector->holds_sequence())
+        vector->visit_sequence(
+            [&](const auto &sequence) { add(sequence, first, last); });
+      else
+        vector->visit_parts(first, last,
+                            [&](auto elements) { add(elements); });
+    } else if (std::holds_alternative<std::int64_t>(value))
+      integral_ += std::get<std::int64_t>(value);
+    else if (std::holds_alternative<std::uint64_t>(value)) {
+      integral_ += std::get<std::uint64_t>(value);
+      signed_ = false;
+    } else if (std::holds_alternative<double>(value)) {
+      floating_point_.add(std::get<double>(value));
+      holds_floating_point_ = true;
+    } else
+      add_rational(value);
+  }
+
+  void merge(const tsum &other) {
+    integral_ += other.integral_;
+    signed_ &= other.signed_;
+    floating_point_.merge(other.floating_point_);
+    holds_floating_point_ |= other.holds_floating_point_;
+    if (other.rational_)
+      add_rational(*other.rational_);
+  }
+
+  [[nodiscard]] tstorage result() const {
+    if (holds_floating_point_) {
+      tfloating_point_sum<Summation> result = floating_point_;
+      result.add(static_cast<double>(integral_));
+      if (rational_)
+        result.add(double_cast(*rational_));
+      return result.result();
+    }
+
+    const tstorage integral = signed_ ? to_storage<std::int64_t>(integral_)
+                                      : to_storage(integral_);
+    if (rational_)
+      return math::add(integral, *rational_);
+
+    return integral;
+  }
+
+private:
+  void add(std::span<const std::int64_t> elements) {
+    twide_sum<true> operation;
+    simd::accumulate(
+        reinterpret_cast<const std::uint64_t *>(elements.data()),
+        elements.size(), operation);
+    integral_ += operation.result(elements.size());
+  }
+
+  void add(std::span<const std::uint64_t> elements) {
+    twide_sum<false> operation;
+    simd::accumulate(elements.data(), elements.size(), operation);
+    integral_ += operation.result(elements.size());
+    signed_ = false;
+  }
+
+  void add(std::span<const double> elements) {
+    floating_point_.add(elements);
+    holds_floating_point_ = true;
+  }
+
+  /** Adds the elements [first, last) of @p sequence in closed form. */
+  template <class T>
+  void add(const tsequence<T> &sequence, std::size_t first, std::size_t last) {
+    const std::size_t count = last - first;
+    if constexpr (std::same_as<T, double>) {
+      floating_point_.add((sequence[first] + sequence[last - 1]) *
+                          static_cast<double>(count) / 2.);
+      holds_floating_point_ = true;
+    } else {
+      // Either the count or the sum of the first and last element is even.
+      // The sequence size is limited, so this doesn't overflow.
+      integral_ += (static_cast<__int128_t>(sequence[first]) +
+                    sequence[last - 1]) *
+                   static_cast<__int128_t>(count) / 2;
+      if constexpr (std::same_as<T, std::uint64_t>)
+        signed_ = false;
+    }
+  }
+
+  void add_rational(const tstorage &value) {
+    rational_ = rational_ ? math::add(*rational_, value) : value;
+  }
+
+  /** The sum of the integral elements, this never overflows. */
+  __int128_t integral_{0};
+  /** Are all integral elements signed? */
+  bool signed_{true};
+
+  tfloating_point_sum<Summation> floating_point_;
+  bool holds_floating_point_{false};
+
+  /** The sum of the rational elements. */
+  std::optional<tstorage> rational_;
+};
+
+class tproduct final {
+public:
+  /** Multiplies the elements [first, last) of @p value. */
+  void add(const tstorage &value, std::size_t first, std::size_t last) {
+    if (const tvector *vector = get_elements(value))
+      vector->visit_parts(first, last, [&](auto elements) { add(elements); });
+    else if (std::holds_alternative<std::int64_t>(value))
+      multiply(std::get<std::int64_t>(value));
+    else if (std::holds_alternative<std::uint64_t>(value)) {
+      multiply(std::get<std::uint64_t>(value));
+      signed_ = false;
+    } else if (std::holds_alternative<double>(value)) {
+      floating_point_ *= std::get<double>(value);
+      holds_floating_point_ = true;
+    } else
+      multiply_rational(value);
+  }
+
+  void merge(const tproduct &other) {
+    if (other.integral_)
+      multiply_exact(*other.integral_);
+    else if (integral_ != 0)
+      integral_ = std::nullopt;
+    integral_floating_point_ *= other.integral_floating_point_;
+    signed_ &= other.signed_;
+    floating_point_ *= other.floating_point_;
+    holds_floating_point_ |= other.holds_floating_point_;
+    if (other.rational_)
+      multiply_rational(*other.rational_);
+  }
+
+  [[nodiscard]] tstorage result() const {
+    if (holds_floating_point_ || !integral_)
+      return floating_point_ *
+             (integral_ ? static_cast<double>(*integral_)
+                        : integral_floating_point_) *
+             (rational_ ? double_cast(*rational_) : 1.);
+
+    const tstorage integral = signed_ ? to_storage<std::int64_t>(*integral_)
+                                      : to_storage(*integral_);
+    if (rational_)
+      return math::mul(integral, *rational_);
+
+    return integral;
+  }
+
+private:
+  // There are no SIMD instructions for 64-bit integral multiplications with
+  // overflow detection, so the integral elements use a scalar loop.
+
+  void multiply_exact(__int128_t value) {
+    // After an overflow a zero still gives an exact result.
+    if (value == 0)
+      integral_ = 0;
+    else if (integral_ &&
+             __builtin_mul_overflow(*integral_, value, &*integral_))
+      integral_ = std::nullopt;
+  }
+
+  void multiply(__int128_t value) {
+    multiply_exact(value);
+    integral_floating_point_ *= static_cast<double>(value);
+  }
+
+  void add(std::span<const std::int64_t> elements) {
+    for (std::int64_t element : elements)
+      multiply(element);
+  }
+
+  void add(std::span<const std::uint64_t> elements) {
+    for (std::uint64_t element : elements)
+      multiply(element);
+    signed_ = false;
+  }
+
+  void add(std::span<const double> elements) {
+    tdouble_product operation;
+    simd::accumulate(elements.data(), elements.size(), operation);
+    floating_point_ *= operation.result();
+    holds_floating_point_ = true;
+  }
+
+  void multiply_rational(const tstorage &value) {
+    rational_ = rational_ ? math::mul(*rational_, value) : value;
+  }
+
+  /**
+   * The product of the integral elements.
+   *
+   * Contains @c std::nullopt after an overflow, then only
+   * @ref integral_floating_point_ is valid.
+   */
+  std::optional<__int128_t> integral_{1};
+  double integral_floating_point_{1.};
+  /** Are all integral elements signed? */
+  bool signed_{true};
+
+  double floating_point_{1.};
+  bool holds_floating_point_{false};
+
+  /** The product of the rational elements. */
+  std::optional<tstorage> rational_;
+};
+
+template <bool Maximum> class textremum_reducer final {
+public:
+  /** Selects the extremum of the elements [first, last) of @p value. */
+  void add(const tstorage &value, std::size_t first, std::size_t last) {
+    if (const tvector *vector = get_elements(value)) {
+      if (vector->holds_sequence())
+        // The elements of a sequence are monotonic.
+        vector->visit_sequence([&](const auto &sequence) {
+          const auto [min, max] =
+              std::minmax(sequence[first], sequence[last - 1]);
+          select(tstorage{Maximum ? max : min});
+        });
+      else
+        vector->visit_parts(
+            first, last, [&]<class T>(std::span<const T> elements) {
+              textremum<T, Maximum> operation;
+              simd::accumulate(elements.data(), elements.size(), operation);
+              nan_ |= operation.nan();
+              select(tstorage{operation.result()});
+            });
+    }
+    else if (is_nan(value))
+      nan_ = true;
+    else
+      select(value);
+  }
+
+  void merge(const textremum_reducer &other) {
+    nan_ |= other.nan_;
+    if (other.extremum_)
+      select(*other.extremum_);
+  }
+
+  [[nodiscard]] tstorage result() const {
+    if (nan_)
+      return std::numeric_limits<double>::quiet_NaN();
+    if (!extremum_)
+      throw std::out_of_range("The vectors don't contain an element");
+    return *extremum_;
+  }
+
+private:
+  void select(const tstorage &value) {
+    if (!extremum_)
+      extremum_ = value;
+    else if (Maximum ? compare(value, *extremum_) > 0
+                     : compare(value, *extremum_) < 0)
+      extremum_ = value;
+  }
+
+  std::optional<tstorage> extremum_;
+  bool nan_{false};
+};
+
+class tcount final {
+public:
+  void add(const tstorage &, std::size_t first, std::size_t last) {
+    count_ += last - first;
+  }
+
+  void merge(const tcount &other) { count_ += other.count_; }
+
+  [[nodiscard]] tstorage result() const { return std::uint64_t(count_); }
+
+private:
+  std::size_t count_{0};
+};
+
+/*** Reduction ***/
+
+static std::size_t element_count(const tstorage &value) {
+  if (const tvector *vector = get_elements(value))
+    return vector->size();
+  return 1;
+}
+
+/**
+ * Reduces the elements of @p values with a @p Reducer.
+ *
+ * The elements of a vector are reduced like separate values. Large numbers
+ * of elements are split over multiple threads, a large vector can be split
+ * over multiple threads too.
+ *
+ * @throws std::out_of_range when @p values is empty.
+ */
+template <class Reducer>
+static tstorage reduce(std::span<const tstorage> values) {
+  if (values.empty())
+    throw std::out_of_range("The stack doesn't contain an element");
+
+  // The element offset of every value; only needed when vectors are present.
+  std::vector<std::size_t> offsets;
+  if (std::ranges::any_of(values, [](const tstorage &value) {
+        return get_elements(value) != nullptr;
+      })) {
+    offsets.reserve(values.size() + 1);
+    offsets.push_back(0);
+    for (const tstorage &value : values)
+      offsets.push_back(offsets.back() + element_count(value));
+  }
+
+  auto map = [&](std::size_t first, std::size_t last) {
+    Reducer reducer;
+    if (offsets.empty()) {
+      for (; first < last; ++first)
+        reducer.add(values[first], 0, 1);
+      return reducer;
+    }
+
+    auto index = static_cast<std::size_t>(
+        std::ranges::upper_bound(offsets, first) - offsets.begin() - 1);
+    for (; first < last; ++index) {
+      const std::size_t end = std::min(last, offsets[index + 1]);
+      reducer.add(values[index], first - offsets[index], end - offsets[index]);
+      first = end;
+    }
+    return reducer;
+  };
+
+  return lib::parallel_reduce(offsets.empty() ? values.size() : offsets.back(),
+                              map,
+                              [](Reducer lhs, const Reducer &rhs) {
+                                lhs.merge(rhs);
+                                return lhs;
+                              })
+      .result();
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#sum */
+export tstorage sum(std::span<const tstorage> values,
+                    tsummation summation = tsummation::naive) {
+  switch (summation) {
+  case tsummation::naive:
+    return reduce<tsum<tsummation::naive>>(values);
+  case tsummation::pairwise:
+    return reduce<tsum<tsummation::pairwise>>(values);
+  case tsummation::neumaier:
+    return reduce<tsum<tsummation::neumaier>>(values);
+  }
+  std::unreachable();
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#product */
+export tstorage prod(std::span<const tstorage> values) {
+  return reduce<tproduct>(values);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#minimum-and-maximum */
+export tstorage min(std::span<const tstorage> values) {
+  return reduce<textremum_reducer<false>>(values);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#minimum-and-maximum */
+export tstorage max(std::span<const tstorage> values) {
+  return reduce<textremum_reducer<true>>(values);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#count */
+export tstorage count(std::span<const tstorage> values) {
+  return reduce<tcount>(values);
+}
+
+} // namespace math
+} // namespace calculator
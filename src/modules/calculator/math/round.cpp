@@ -20,10 +20,39 @@ import std;
 namespace calculator {
 namespace math {
 
+// The integral division truncates, so the quotient of a rational only needs
+// an adjustment when there's a remainder.
+
+static std::int64_t trunc(trational value) {
+  return value.numerator / value.denominator;
+}
+
+static std::int64_t floor(trational value) {
+  return trunc(value) - (value.numerator % value.denominator < 0);
+}
+
+static std::int64_t ceil(trational value) {
+  return trunc(value) + (value.numerator % value.denominator > 0);
+}
+
+/** Rounds halfway cases away from zero, like @c std::round. */
+static std::int64_t round(trational value) {
+  const std::int64_t remainder = value.numerator % value.denominator;
+  const std::uint64_t magnitude =
+      remainder < 0 ? -static_cast<std::uint64_t>(remainder)
+                    : static_cast<std::uint64_t>(remainder);
+  if (2 * magnitude < static_cast<std::uint64_t>(value.denominator))
+    return trunc(value);
+
+  return trunc(value) + (value.numerator < 0 ? -1 : 1);
+}
+
 /** @see https://mordante.github.io/rpn/calculation.html#round */
 export tstorage round(tstorage value) {
   if (std::holds_alternative<double>(value))
     return std::round(get<double>(value));
+  if (std::holds_alternative<trational>(value))
+    return round(get<trational>(value));
 
   throw std::domain_error("Not a floating-point");
 }
@@ -32,6 +61,8 @@ export tstorage round(tstorage value) {
 export tstorage floor(tstorage value) {
   if (std::holds_alternative<double>(value))
     return std::floor(get<double>(value));
+  if (std::holds_alternative<trational>(value))
+    return floor(get<trational>(value));
 
   throw std::domain_error("Not a floating-point");
 }
@@ -40,6 +71,8 @@ export tstorage floor(tstorage value) {
 export tstorage ceil(tstorage value) {
   if (std::holds_alternative<double>(value))
     return std::ceil(get<double>(value));
+  if (std::holds_alternative<trational>(value))
+    return ceil(get<trational>(value));
 
   throw std::domain_error("Not a floating-point");
 }
@@ -48,6 +81,8 @@ export tstorage ceil(tstorage value) {
 export tstorage trunc(tstorage value) {
   if (std::holds_alternative<double>(value))
     return std::trunc(get<double>(value));
+  if (std::holds_alternative<trational>(value))
+    return trunc(get<trational>(value));
 
   throw std::domain_error("Not a floating-point");
 }
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.scan;
+
+export import calculator.math.core;
+import calculator.math.simd;
+import lib.parallel;
+import std;
+
+namespace calculator {
+namespace math {
+
+/** @throws std::domain_error when @p value is not a vector. */
+static const tvector &require_vector(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    throw std::domain_error("Not a vector");
+  return std::get<tvector>(value);
+}
+
+template <class Operation> static bool overflowed(const Operation &operation) {
+  if constexpr (requires { operation.overflowed(); })
+    return operation.overflowed();
+  else
+    return false;
+}
+
+/** The part of the elements scanned by one thread. */
+template <class T> struct tchunk {
+  std::size_t first;
+  std::size_t last;
+  /** The last element of the scan of this chunk. */
+  T total;
+  /** The combined totals of the previous chunks. */
+  T offset;
+  bool overflow;
+};
+
+/**
+ * Calculates the inclusive scan of @p elements.
+ *
+ * A large number of elements is scanned in parallel in two passes. First every
+ * thread scans its chunk of the elements. Then the totals of the previous
+ * chunks are combined with the elements of every chunk. This only adds one
+ * operation per element to the sequential scan.
+ *
+ * The result is stored in a vector of @p R, which has the same size as @p T.
+ * This allows the signed operations to use the unsigned representation.
+ *
+ * @returns The scanned elements or @c std::nullopt when the @p Operation
+ * detected an overflow.
+ */
+template <class T, class Operation, class R = T>
+static std::optional<std::vector<R>> scan(std::span<const T> elements,
+                                          T identity) {
+  static_assert(sizeof(R) == sizeof(T));
+  std::vector<R> storage(elements.size());
+  // Signed and unsigned types of the same size may alias.
+  T *result = reinterpret_cast<T *>(storage.data());
+
+  using tchunks = std::vector<tchunk<T>>;
+  tchunks chunks = lib::parallel_reduce(
+      elements.size(),
+      [&](std::size_t first, std::size_t last) {
+        Operation operation;
+        const T total = simd::scan(elements.data() + first, last - first,
+                                   result + first, identity, identity,
+                                   operation);
+        return tchunks{{first, last, total, identity, overflowed(operation)}};
+      },
+      [](tchunks lhs, const tchunks &rhs) {
+        lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+        return lhs;
+      });
+
+  Operation operation;
+  std::atomic<bool> overflow{false};
+  for (std::size_t i = 1; i < chunks.size(); ++i)
+    chunks[i].offset = operation(chunks[i - 1].offset, chunks[i - 1].total);
+  if (overflowed(operation) ||
+      std::ranges::any_of(chunks, &tchunk<T>::overflow))
+    return std::nullopt;
+
+  // Every thread processes one chunk.
+  lib::parallel_for(
+      chunks.size() - 1,
+      [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first + 1; i <= last; ++i) {
+          const tchunk<T> &chunk = chunks[i];
+          Operation operation;
+          simd::transform(result + chunk.first, chunk.last - chunk.first,
+                          simd::tbroadcast<T>{chunk.offset},
+                          simd::tarray<T>{result + chunk.first}, operation);
+          if (overflowed(operation))
+            overflow.store(true, std::memory_order_relaxed);
+        }
+      },
+      1);
+
+  if (overflow.load(std::memory_order_relaxed))
+    return std::nullopt;
+
+  return storage;
+}
+
+/** Calculates the exact cumulative sum of integral elements. */
+template <class T>
+static tstorage exact_sum(std::span<const T> elements) {
+  std::vector<__int128_t> result;
+  result.reserve(elements.size());
+  __int128_t sum = 0;
+  for (T element : elements)
+    result.push_back(sum += element);
+
+  return to_vector<T>(result);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#cumulative-sum */
+export tstorage cumsum(tstorage value) {
+  const tvector &vector = require_vector(value);
+  if (vector.holds<double>())
+    return tvector{*scan<double, simd::tplus>(vector.get<double>(), 0.)};
+
+  if (vector.holds<std::int64_t>()) {
+    const std::span<const std::int64_t> elements =
+        vector.get<std::int64_t>();
+    // The signed operations use the two's complement representation.
+    if (std::optional<std::vector<std::int64_t>> result =
+            scan<std::uint64_t, simd::tplus_signed, std::int64_t>(
+                {reinterpret_cast<const std::uint64_t *>(elements.data()),
+                 elements.size()},
+                0))
+      return tvector{std::move(*result)};
+
+    return exact_sum(elements);
+  }
+
+  const std::span<const std::uint64_t> elements = vector.get<std::uint64_t>();
+  if (std::optional<std::vector<std::uint64_t>> result =
+          scan<std::uint64_t, simd::tplus_unsigned>(elements, 0))
+    return tvector{std::move(*result)};
+
+  return exact_sum(elements);
+}
+
+static std::vector<double> double_product(std::span<const double> elements) {
+  return *scan<double, simd::tmultiplies>(elements, 1.);
+}
+
+/**
+ * Calculates the exact cumulative product of integral elements.
+ *
+ * There are no SIMD instructions for 64-bit integral multiplications with
+ * overflow detection. Unless the elements are mostly 0, 1, or -1 the product
+ * overflows after a few elements, so this uses a scalar loop.
+ */
+template <class T>
+static tstorage exact_product(std::span<const T> elements) {
+  std::vector<__int128_t> result;
+  result.reserve(elements.size());
+  __int128_t product = 1;
+  for (T element : elements) {
+    if (__builtin_mul_overflow(product, element, &product))
+      return tvector{double_product(
+          std::vector<double>(elements.begin(), elements.end()))};
+    result.push_back(product);
+  }
+
+  return to_vector<T>(result);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#cumulative-product */
+export tstorage cumprod(tstorage value) {
+  return require_vector(value).visit(
+      []<class T>(std::span<const T> elements) -> tstorage {
+        if constexpr (std::same_as<T, double>)
+          return tvector{double_product(elements)};
+        else
+          return exact_product(elements);
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#cumulative-extremum */
+export tstorage cummax(tstorage value) {
+  return require_vector(value).visit(
+      []<class T>(std::span<const T> elements) -> tstorage {
+        const T identity = std::numeric_limits<T>::has_infinity
+                               ? -std::numeric_limits<T>::infinity()
+                               : std::numeric_limits<T>::lowest();
+        return tvector{*scan<T, simd::tmaximum>(elements, identity)};
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#cumulative-extremum */
+export tstorage cummin(tstorage value) {
+  return require_vector(value).visit(
+      []<class T>(std::span<const T> elements) -> tstorage {
+        const T identity = std::numeric_limits<T>::has_infinity
+                               ? std::numeric_limits<T>::infinity()
+                               : std::numeric_limits<T>::max();
+        return tvector{*scan<T, simd::tminimum>(elements, identity)};
+      });
+}
+
+} // namespace math
+} // namespace calculator
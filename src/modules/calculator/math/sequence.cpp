@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.sequence;
+
+export import calculator.math.core;
+import std;
+
+namespace calculator {
+namespace math {
+
+/**
+ * The maximum number of elements in a sequence.
+ *
+ * A sequence is stored when its elements are accessed, so it's limited like a
+ * vector. This also makes sure the sum of the elements of an integral
+ * sequence fits in an @c __int128_t.
+ */
+static constexpr std::size_t sequence_max = std::vector<double>{}.max_size();
+
+static std::size_t sequence_size(const tstorage &count) {
+  const std::uint64_t result = positive_integral_cast(count);
+  if (result > sequence_max)
+    throw std::range_error("Value too large");
+  return result;
+}
+
+static bool is_integral(const tstorage &value) {
+  return std::holds_alternative<std::int64_t>(value) ||
+         std::holds_alternative<std::uint64_t>(value);
+}
+
+static __int128_t wide_value(const tstorage &value) {
+  if (std::holds_alternative<std::int64_t>(value))
+    return std::get<std::int64_t>(value);
+  return std::get<std::uint64_t>(value);
+}
+
+/**
+ * Creates a sequence with integral elements.
+ *
+ * Like @ref to_vector the type is selected for all elements, a sequence that
+ * doesn't fit in an integral type has @c double elements.
+ */
+template <class T>
+static tstorage integral_sequence(__int128_t start, __int128_t step,
+                                  std::size_t count) {
+  const __int128_t last = start + static_cast<__int128_t>(count - 1) * step;
+  const std::array endpoints{start, last};
+  return std::get<tvector>(to_vector<T>(endpoints))
+      .visit([&]<class R>(std::span<const R> elements) -> tstorage {
+        if constexpr (std::same_as<R, double>)
+          return tvector{tsequence<double>{static_cast<double>(start),
+                                           static_cast<double>(step), count}};
+        else
+          return tvector{
+              tsequence<R>{elements[0], static_cast<R>(step), count}};
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#sequences */
+export tstorage range(tstorage start, tstorage step, tstorage count) {
+  const std::size_t size = sequence_size(count);
+  if (is_integral(start) && is_integral(step)) {
+    if (std::holds_alternative<std::int64_t>(start) &&
+        std::holds_alternative<std::int64_t>(step))
+      return integral_sequence<std::int64_t>(wide_value(start),
+                                             wide_value(step), size);
+
+    return integral_sequence<std::uint64_t>(wide_value(start),
+                                            wide_value(step), size);
+  }
+
+  const double first = double_cast(start);
+  const double difference = double_cast(step);
+  if (!std::isfinite(first) || !std::isfinite(difference))
+    throw std::domain_error("Not a finite value");
+
+  return tvector{tsequence<double>{first, difference, size}};
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#sequences */
+export tstorage iota(tstorage count) {
+  return range(std::uint64_t(0), std::uint64_t(1), count);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.simd;
+
+import std;
+
+// The kernels use the GNU vector extensions instead of intrinsics. This way
+// the same code is used for every instruction set. A kernel is instantiated
+// twice; once for AVX2 and once for the default target, on x86-64 the latter
+// uses SSE2. The selection is done at run-time, so the binary works on every
+// x86-64 CPU.
+//
+// All helpers are always inlined in the kernel. This avoids passing SIMD
+// registers between functions compiled for different targets. GCC warns about
+// the ABI of these helpers regardless.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace calculator {
+namespace math {
+namespace simd {
+
+template <class T> struct tregister_traits {
+  typedef T type __attribute__((vector_size(32)));
+};
+
+/** A SIMD register, the size matches an AVX2 register. */
+export template <class T> using tregister = typename tregister_traits<T>::type;
+
+/** The number of elements in a @ref tregister. */
+export template <class T>
+inline constexpr std::size_t lanes = sizeof(tregister<T>) / sizeof(T);
+
+/**
+ * An operand whose elements are stored in an array.
+ *
+ * The elements are loaded with @c memcpy. This allows to use an array of
+ * @c double as an array of @c std::uint64_t.
+ */
+export template <class T> struct tarray {
+  const T *data;
+};
+
+/** An operand that has the same value for every element. */
+export template <class T> struct tbroadcast {
+  T value;
+};
+
+template <class R, class T>
+[[gnu::always_inline]] inline tregister<R> load(tarray<T> operand,
+                                                std::size_t index) {
+  tregister<T> result;
+  __builtin_memcpy(&result, operand.data + index, sizeof(result));
+  if constexpr (std::same_as<R, T>)
+    return result;
+  else
+    return __builtin_convertvector(result, tregister<R>);
+}
+
+template <class R, class T>
+[[gnu::always_inline]] inline tregister<R> load(tbroadcast<T> operand,
+                                                std::size_t) {
+  return tregister<R>{} + static_cast<R>(operand.value);
+}
+
+template <class R, class T>
+[[gnu::always_inline]] inline R element(tarray<T> operand, std::size_t index) {
+  T result;
+  __builtin_memcpy(&result, operand.data + index, sizeof(result));
+  return static_cast<R>(result);
+}
+
+template <class R, class T>
+[[gnu::always_inline]] inline R element(tbroadcast<T> operand, std::size_t) {
+  return static_cast<R>(operand.value);
+}
+
+template <class R, class Lhs, class Rhs, class Operation>
+[[gnu::always_inline]] inline void kernel(R *result, std::size_t size, Lhs lhs,
+                                          Rhs rhs, Operation &operation) {
+  std::size_t index = 0;
+  for (; index + lanes<R> <= size; index += lanes<R>) {
+    const tregister<R> value =
+        operation(load<R>(lhs, index), load<R>(rhs, index));
+    __builtin_memcpy(result + index, &value, sizeof(value));
+  }
+
+  for (; index < size; ++index)
+    result[index] = operation(element<R>(lhs, index), element<R>(rhs, index));
+}
+
+#if defined(__x86_64__)
+template <class R, class Lhs, class Rhs, class Operation>
+[[gnu::target("avx2")]] void kernel_avx2(R *result, std::size_t size, Lhs lhs,
+                                         Rhs rhs, Operation &operation) {
+  kernel(result, size, lhs, rhs, operation);
+}
+#endif
+
+template <class R, class Lhs, class Rhs, class Operation>
+void kernel_default(R *result, std::size_t size, Lhs lhs, Rhs rhs,
+                    Operation &operation) {
+  kernel(result, size, lhs, rhs, operation);
+}
+
+/**
+ * Stores @c operation(lhs[i], rhs[i]) in @c result[i] for every element.
+ *
+ * The elements of @p lhs and @p rhs are converted to @p R before the
+ * operation. The @p operation is called with a @ref tregister<R> for the bulk
+ * of the elements and with an @p R for the remaining elements. It is passed
+ * by reference, this allows the operation to accumulate a state, for example
+ * whether an overflow occurred.
+ *
+ * @pre @p result has @p size elements.
+ * @pre @p lhs and @p rhs have @p size elements or are a @ref tbroadcast.
+ */
+export template <class R, class Lhs, class Rhs, class Operation>
+void transform(R *result, std::size_t size, Lhs lhs, Rhs rhs,
+               Operation &operation) {
+#if defined(__x86_64__)
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  if (avx2)
+    return kernel_avx2(result, size, lhs, rhs, operation);
+#endif
+  kernel_default(result, size, lhs, rhs, operation);
+}
+
+template <class T, class Operation>
+[[gnu::always_inline]] inline void
+accumulate_kernel(const T *data, std::size_t size, Operation &operation) {
+  const tarray<T> array{data};
+  std::size_t index = 0;
+  for (; index + lanes<T> <= size; index += lanes<T>)
+    operation(load<T>(array, index));
+
+  for (; index < size; ++index)
+    operation(element<T>(array, index));
+}
+
+#if defined(__x86_64__)
+template <class T, class Operation>
+[[gnu::target("avx2")]] void
+accumulate_avx2(const T *data, std::size_t size, Operation &operation) {
+  accumulate_kernel(data, size, operation);
+}
+#endif
+
+template <class T, class Operation>
+void accumulate_default(const T *data, std::size_t size, Operation &operation) {
+  accumulate_kernel(data, size, operation);
+}
+
+/**
+ * Calls @c operation(data[i]) for every element.
+ *
+ * Like @ref transform the @p operation is called with a @ref tregister<T> for
+ * the bulk of the elements and with a @p T for the remaining elements. The
+ * @p operation accumulates the result in its state.
+ */
+export template <class T, class Operation>
+void accumulate(const T *data, std::size_t size, Operation &operation) {
+#if defined(__x86_64__)
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  if (avx2)
+    return accumulate_avx2(data, size, operation);
+#endif
+  accumulate_default(data, size, operation);
+}
+
+/**
+ * Calculates the inclusive scan of the elements in a register.
+ *
+ * The register is combined with itself shifted by one and then by two lanes,
+ * the shifted-in lanes contain the @p identity.
+ */
+template <class T, class Operation>
+[[gnu::always_inline]] inline tregister<T>
+scan_register(tregister<T> value, tregister<T> identity,
+              Operation &operation) {
+  static_assert(lanes<T> == 4);
+  value =
+      operation(value, __builtin_shufflevector(identity, value, 0, 4, 5, 6));
+  return operation(value,
+                   __builtin_shufflevector(identity, value, 0, 1, 4, 5));
+}
+
+template <class T>
+[[gnu::always_inline]] inline tregister<T> broadcast_last(tregister<T> value) {
+  return __builtin_shufflevector(value, value, 3, 3, 3, 3);
+}
+
+template <class T, class Operation>
+[[gnu::always_inline]] inline T scan_kernel(const T *data, std::size_t size,
+                                            T *result, T identity, T carry,
+                                            Operation &operation) {
+  const tregister<T> identities = tregister<T>{} + identity;
+  tregister<T> carries = tregister<T>{} + carry;
+  std::size_t index = 0;
+  // The carry is a dependency between the iterations. Processing two
+  // registers per iteration halves the length of this dependency chain.
+  for (; index + 2 * lanes<T> <= size; index += 2 * lanes<T>) {
+    tregister<T> lhs;
+    tregister<T> rhs;
+    __builtin_memcpy(&lhs, data + index, sizeof(lhs));
+    __builtin_memcpy(&rhs, data + index + lanes<T>, sizeof(rhs));
+    lhs = scan_register<T>(lhs, identities, operation);
+    rhs = operation(scan_register<T>(rhs, identities, operation),
+                    broadcast_last<T>(lhs));
+    lhs = operation(lhs, carries);
+    rhs = operation(rhs, carries);
+    __builtin_memcpy(result + index, &lhs, sizeof(lhs));
+    __builtin_memcpy(result + index + lanes<T>, &rhs, sizeof(rhs));
+    carries = broadcast_last<T>(rhs);
+  }
+
+  carry = carries[0];
+  for (; index < size; ++index)
+    result[index] = carry = operation(data[index], carry);
+
+  return carry;
+}
+
+#if defined(__x86_64__)
+template <class T, class Operation>
+[[gnu::target("avx2")]] T scan_avx2(const T *data, std::size_t size,
+                                    T *result, T identity, T carry,
+                                    Operation &operation) {
+  return scan_kernel(data, size, result, identity, carry, operation);
+}
+#endif
+
+template <class T, class Operation>
+T scan_default(const T *data, std::size_t size, T *result, T identity, T carry,
+               Operation &operation) {
+  return scan_kernel(data, size, result, identity, carry, operation);
+}
+
+/**
+ * Stores the inclusive scan of @p data in @p result.
+ *
+ * The element @c result[i] contains @p carry combined with the elements
+ * [0, i] of @p data. Within a register the scan is calculated with shifts, so
+ * the @p operation needs to be associative and @p identity needs to be its
+ * identity element. Like @ref transform the @p operation is called with
+ * registers and with scalars.
+ *
+ * @returns The last element of @p result.
+ *
+ * @pre @p data and @p result have @p size elements, they may be the same
+ * array.
+ */
+export template <class T, class Operation>
+T scan(const T *data, std::size_t size, T *result, T identity, T carry,
+       Operation &operation) {
+#if defined(__x86_64__)
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  if (avx2)
+    return scan_avx2(data, size, result, identity, carry, operation);
+#endif
+  return scan_default(data, size, result, identity, carry, operation);
+}
+
+/*** Operations ***/
+
+// The operations can't be replaced by std::plus<> and friends, these aren't
+// always inlined.
+
+export struct tplus {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs + rhs;
+  }
+};
+
+export struct tminus {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs - rhs;
+  }
+};
+
+export struct tmultiplies {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs * rhs;
+  }
+};
+
+export struct tdivides {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs / rhs;
+  }
+};
+
+export struct tbit_and {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs & rhs;
+  }
+};
+
+export struct tbit_or {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs | rhs;
+  }
+};
+
+export struct tbit_xor {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs ^ rhs;
+  }
+};
+
+/** Selects the smallest value, a NaN in either operand is selected. */
+export struct tminimum {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs <= rhs || lhs != lhs ? lhs : rhs;
+  }
+};
+
+/** Selects the largest value, a NaN in either operand is selected. */
+export struct tmaximum {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) const {
+    return lhs >= rhs || lhs != lhs ? lhs : rhs;
+  }
+};
+
+/**
+ * The base of an operation that detects overflows.
+ *
+ * The detection is done by or-ing a value in @ref overflow, only its sign bit
+ * is used. This avoids branches in the loop.
+ */
+struct toverflow {
+  tregister<std::uint64_t> overflow{};
+  std::uint64_t overflow_tail{};
+
+  [[gnu::always_inline]] void
+  record(tregister<std::uint64_t> value) noexcept {
+    overflow |= value;
+  }
+  [[gnu::always_inline]] void record(std::uint64_t value) noexcept {
+    overflow_tail |= value;
+  }
+
+  [[nodiscard]] bool overflowed() const noexcept {
+    std::uint64_t result = overflow_tail;
+    for (std::size_t i = 0; i < lanes<std::uint64_t>; ++i)
+      result |= overflow[i];
+    return result >> 63;
+  }
+};
+
+// The signed operations use unsigned arithmetic on the two's complement
+// representation. Unlike signed overflow, unsigned wrap around is well
+// defined.
+
+/** Adds signed values and detects the overflow. */
+export struct tplus_signed : toverflow {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) {
+    const T result = lhs + rhs;
+    record((lhs ^ result) & (rhs ^ result));
+    return result;
+  }
+};
+
+/** Subtracts signed values and detects the overflow. */
+export struct tminus_signed : toverflow {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) {
+    const T result = lhs - rhs;
+    record((lhs ^ rhs) & (lhs ^ result));
+    return result;
+  }
+};
+
+/** Adds unsigned values and detects the overflow. */
+export struct tplus_unsigned : toverflow {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) {
+    const T result = lhs + rhs;
+    // The carry is the sign bit of the majority of lhs, rhs, and ~result.
+    record((lhs & rhs) | ((lhs | rhs) & ~result));
+    return result;
+  }
+};
+
+/** Subtracts unsigned values and detects the underflow. */
+export struct tminus_unsigned : toverflow {
+  template <class T> [[gnu::always_inline]] T operator()(T lhs, T rhs) {
+    const T result = lhs - rhs;
+    // The borrow is the sign bit of the majority of ~lhs, rhs, and result.
+    record((~lhs & rhs) | ((~lhs | rhs) & result));
+    return result;
+  }
+};
+
+} // namespace simd
+} // namespace math
+} // namespace calculator
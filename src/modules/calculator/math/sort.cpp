@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.sort;
+
+export import calculator.math.core;
+import calculator.math.element_wise;
+import lib.parallel;
+import std;
+
+namespace calculator {
+namespace math {
+
+/** The order of the sorted values. */
+export enum class torder { ascending, descending };
+
+/** @throws std::domain_error when @p value is not a vector. */
+static const tvector &sort_operand(const tstorage &value) {
+  if (!std::holds_alternative<tvector>(value))
+    throw std::domain_error("Not a vector");
+  return std::get<tvector>(value);
+}
+
+/*** Keys ***/
+
+// The radix sort sorts unsigned integral keys. The elements are mapped to
+// keys that have the same order as the elements.
+
+static constexpr std::uint64_t sign_bit = std::uint64_t(1) << 63;
+
+static std::uint64_t to_key(std::uint64_t value) { return value; }
+
+static std::uint64_t to_key(std::int64_t value) {
+  return static_cast<std::uint64_t>(value) ^ sign_bit;
+}
+
+/**
+ * Maps a @c double to a key.
+ *
+ * For positive values the sign bit is set, for negative values all bits are
+ * flipped, which reverses their order. All NaNs are mapped to the largest key,
+ * so they are larger than every other value.
+ */
+static std::uint64_t to_key(double value) {
+  if (std::isnan(value))
+    return std::numeric_limits<std::uint64_t>::max();
+
+  const std::uint64_t bits = std::bit_cast<std::uint64_t>(value);
+  return bits & sign_bit ? ~bits : bits | sign_bit;
+}
+
+template <class T> static T from_key(std::uint64_t key) {
+  if constexpr (std::same_as<T, std::uint64_t>)
+    return key;
+  else if constexpr (std::same_as<T, std::int64_t>)
+    return static_cast<std::int64_t>(key ^ sign_bit);
+  else
+    return std::bit_cast<double>(key & sign_bit ? key & ~sign_bit : ~key);
+}
+
+/**
+ * The key of a descending sort.
+ *
+ * Flipping the bits reverses the order, equal keys remain equal so the sort
+ * remains stable.
+ */
+static std::uint64_t mask(torder order) {
+  return order == torder::descending ? ~std::uint64_t(0) : 0;
+}
+
+/** A key with the index of its value. */
+struct tindexed_key {
+  std::uint64_t key;
+  std::uint64_t index;
+
+  /** Equal keys are ordered by their index, like a stable sort. */
+  friend auto operator<=>(const tindexed_key &, const tindexed_key &) = default;
+};
+
+static std::uint64_t key(std::uint64_t item) { return item; }
+static std::uint64_t key(const tindexed_key &item) { return item.key; }
+
+/*** Radix sort ***/
+
+static constexpr std::size_t radix_bits = 11;
+static constexpr std::size_t radix = std::size_t(1) << radix_bits;
+static constexpr std::size_t passes = (64 + radix_bits - 1) / radix_bits;
+
+using thistogram = std::array<std::size_t, radix>;
+
+/**
+ * Below this size a comparison sort is faster.
+ *
+ * Every pass visits all digits, which dominates for a small number of items.
+ */
+static constexpr std::size_t radix_threshold = 1 << 12;
+
+template <class Item>
+static std::size_t digit(const Item &item, std::size_t pass) {
+  return (key(item) >> (pass * radix_bits)) & (radix - 1);
+}
+
+/** The part of the items distributed by one thread. */
+struct tpartition {
+  std::size_t first;
+  std::size_t last;
+  /** Initially the count of every digit, then the output position. */
+  thistogram histogram;
+};
+
+/**
+ * Distributes the @p items over @p target by the digit of @p pass.
+ *
+ * Every thread counts the digits of its chunk. The output positions are
+ * assigned by digit first and chunk second, so the distribution is stable.
+ */
+template <class Item>
+static void distribute(std::span<const Item> items, std::span<Item> target,
+                       std::size_t pass) {
+  using tpartitions = std::vector<tpartition>;
+  tpartitions chunks = lib::parallel_reduce(
+      items.size(),
+      [&](std::size_t first, std::size_t last) {
+        tpartition chunk{first, last, {}};
+        for (std::size_t i = first; i < last; ++i)
+          ++chunk.histogram[digit(items[i], pass)];
+        return tpartitions{chunk};
+      },
+      [](tpartitions lhs, const tpartitions &rhs) {
+        lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+        return lhs;
+      });
+
+  std::size_t offset = 0;
+  for (std::size_t d = 0; d < radix; ++d)
+    for (tpartition &chunk : chunks)
+      offset += std::exchange(chunk.histogram[d], offset);
+
+  // Every thread processes one chunk.
+  lib::parallel_for(
+      chunks.size(),
+      [&](std::size_t first, std::size_t last) {
+        for (std::size_t c = first; c < last; ++c) {
+          tpartition &chunk = chunks[c];
+          for (std::size_t i = chunk.first; i < chunk.last; ++i)
+            target[chunk.histogram[digit(items[i], pass)]++] = items[i];
+        }
+      },
+      1);
+}
+
+/**
+ * Sorts the @p items with a stable least significant digit radix sort.
+ *
+ * Every pass distributes the items by one digit of @ref radix_bits bits. The
+ * histograms of all digits are calculated up front, a pass where all items
+ * have the same digit doesn't change the order and is skipped. This avoids
+ * most passes for small values.
+ */
+template <class Item> static void radix_sort(std::vector<Item> &items) {
+  if (items.size() < radix_threshold) {
+    std::ranges::sort(items);
+    return;
+  }
+
+  using thistograms = std::array<thistogram, passes>;
+  const thistograms histograms = lib::parallel_reduce(
+      items.size(),
+      [&](std::size_t first, std::size_t last) {
+        thistograms result{};
+        for (std::size_t i = first; i < last; ++i)
+          for (std::size_t pass = 0; pass < passes; ++pass)
+            ++result[pass][digit(items[i], pass)];
+        return result;
+      },
+      [](thistograms lhs, const thistograms &rhs) {
+        for (std::size_t pass = 0; pass < passes; ++pass)
+          for (std::size_t d = 0; d < radix; ++d)
+            lhs[pass][d] += rhs[pass][d];
+        return lhs;
+      });
+
+  std::vector<Item> buffer;
+  for (std::size_t pass = 0; pass < passes; ++pass) {
+    if (std::ranges::find(histograms[pass], items.size()) !=
+        histograms[pass].end())
+      continue;
+
+    buffer.resize(items.size());
+    distribute<Item>(items, buffer, pass);
+    items.swap(buffer);
+  }
+}
+
+/** @returns The permutation that sorts the @p elements. */
+template <class Index, class T>
+static std::vector<Index> radix_order(std::span<const T> elements,
+                                      torder order) {
+  std::vector<tindexed_key> items(elements.size());
+  const std::uint64_t flip = mask(order);
+  lib::parallel_for(elements.size(), [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      items[i] = {to_key(elements[i]) ^ flip, i};
+  });
+
+  radix_sort(items);
+
+  std::vector<Index> result(items.size());
+  lib::parallel_for(items.size(), [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i)
+      result[i] = static_cast<Index>(items[i].index);
+  });
+  return result;
+}
+
+/*** Merge sort ***/
+
+/**
+ * Sorts the @p indices with a stable parallel merge sort.
+ *
+ * Every thread sorts its chunk, then adjacent sorted runs are merged in
+ * parallel until one run remains.
+ */
+template <class Less>
+static void merge_sort(std::vector<std::size_t> &indices, Less less) {
+  using truns = std::vector<std::pair<std::size_t, std::size_t>>;
+  truns runs = lib::parallel_reduce(
+      indices.size(),
+      [&](std::size_t first, std::size_t last) {
+        std::stable_sort(indices.begin() + first, indices.begin() + last, less);
+        return truns{{first, last}};
+      },
+      [](truns lhs, const truns &rhs) {
+        lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+        return lhs;
+      });
+
+  std::vector<std::size_t> buffer(runs.size() > 1 ? indices.size() : 0);
+  while (runs.size() > 1) {
+    truns merged((runs.size() + 1) / 2);
+    lib::parallel_for(
+        merged.size(),
+        [&](std::size_t first, std::size_t last) {
+          for (std::size_t i = first; i < last; ++i) {
+            const auto [begin, middle] = runs[2 * i];
+            if (2 * i + 1 == runs.size()) {
+              std::copy(indices.begin() + begin, indices.begin() + middle,
+                        buffer.begin() + begin);
+              merged[i] = runs[2 * i];
+            } else {
+              const std::size_t end = runs[2 * i + 1].second;
+              std::merge(indices.begin() + begin, indices.begin() + middle,
+                         indices.begin() + middle, indices.begin() + end,
+                         buffer.begin() + begin, less);
+              merged[i] = {begin, end};
+            }
+          }
+        },
+        1);
+    indices.swap(buffer);
+    runs = std::move(merged);
+  }
+}
+
+static bool is_nan_value(const tstorage &value) {
+  return std::holds_alternative<double>(value) &&
+         std::isnan(std::get<double>(value));
+}
+
+/** @returns The permutation that sorts the scalars @p values. */
+static std::vector<std::size_t> merge_order(std::span<const tstorage> values,
+                                            torder order) {
+  std::vector<std::size_t> result(values.size());
+  std::iota(result.begin(), result.end(), 0);
+
+  // A NaN is larger than every other value.
+  auto less = [values](std::size_t lhs, std::size_t rhs) {
+    const bool lhs_nan = is_nan_value(values[lhs]);
+    const bool rhs_nan = is_nan_value(values[rhs]);
+    if (lhs_nan || rhs_nan)
+      return !lhs_nan;
+    return compare(values[lhs], values[rhs]) < 0;
+  };
+
+  if (order == torder::ascending)
+    merge_sort(result, less);
+  else
+    merge_sort(result, [less](std::size_t lhs, std::size_t rhs) {
+      return less(rhs, lhs);
+    });
+
+  return result;
+}
+
+/*** Sort ***/
+
+/**
+ * @returns The values as elements of one type, when they can be sorted by
+ * their keys.
+ */
+static std::optional<tvector> homogeneous(std::span<const tstorage> values) {
+  if (std::ranges::all_of(values, [](const tstorage &value) {
+        return std::holds_alternative<double>(value);
+      }))
+    return std::get<tvector>(pack(values));
+
+  const bool integral = std::ranges::all_of(values, [](const tstorage &value) {
+    return std::holds_alternative<std::int64_t>(value) ||
+           std::holds_alternative<std::uint64_t>(value);
+  });
+  if (!integral)
+    return std::nullopt;
+
+  // A mix of negative values and values larger than the maximum of an
+  // std::int64_t has no common type.
+  tvector result = std::get<tvector>(pack(values));
+  if (result.holds<double>())
+    return std::nullopt;
+  return result;
+}
+
+/**
+ * Returns the permutation that sorts the scalar @p values.
+ *
+ * The values are compared exactly, a NaN is larger than every other value.
+ * The sort is stable. When all values have the same integral or
+ * floating-point type they are sorted with a radix sort, otherwise with a
+ * merge sort.
+ *
+ * @throws std::domain_error when a value is not a scalar.
+ */
+export std::vector<std::size_t> sort_order(std::span<const tstorage> values,
+                                           torder order) {
+  if (std::ranges::any_of(values, [](const tstorage &value) {
+        return std::holds_alternative<tvector>(value) ||
+               std::holds_alternative<tmatrix>(value);
+      }))
+    throw std::domain_error("Not a scalar");
+
+  if (values.empty())
+    return {};
+
+  if (std::optional<tvector> elements = homogeneous(values))
+    return elements->visit([order]<class T>(std::span<const T> elements) {
+      return radix_order<std::size_t>(elements, order);
+    });
+
+  return merge_order(values, order);
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#sort */
+export tstorage sort(tstorage value, torder order = torder::ascending) {
+  return sort_operand(value).visit(
+      [order]<class T>(std::span<const T> elements) -> tstorage {
+        const std::uint64_t flip = mask(order);
+        std::vector<std::uint64_t> keys(elements.size());
+        lib::parallel_for(
+            elements.size(), [&](std::size_t first, std::size_t last) {
+              for (std::size_t i = first; i < last; ++i)
+                keys[i] = to_key(elements[i]) ^ flip;
+            });
+
+        radix_sort(keys);
+
+        std::vector<T> result(keys.size());
+        lib::parallel_for(
+            keys.size(), [&](std::size_t first, std::size_t last) {
+              for (std::size_t i = first; i < last; ++i)
+                result[i] = from_key<T>(keys[i] ^ flip);
+            });
+        return tvector{std::move(result)};
+      });
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#argsort */
+export tstorage argsort(tstorage value) {
+  return sort_operand(value).visit(
+      []<class T>(std::span<const T> elements) -> tstorage {
+        return tvector{radix_order<std::uint64_t>(elements, torder::ascending)};
+      });
+}
+
+} // namespace math
+} // namespace calculator
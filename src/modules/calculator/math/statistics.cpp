@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.statistics;
+
+export import calculator.math.core;
+import calculator.math.simd;
+import lib.parallel;
+import std;
+
+// The SIMD operations are always inlined in the kernels of
+// calculator.math.simd, see there for the ABI warning.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace calculator {
+namespace math {
+
+/*** Selection ***/
+
+/**
+ * The elements of the values, stored in the type used to select them.
+ *
+ * When the elements have one integral or floating-point type they are
+ * selected in that type. Other elements, for example rationals, are selected
+ * as @ref tstorage using the exact comparison.
+ */
+using tselection =
+    std::variant<std::vector<std::int64_t>, std::vector<std::uint64_t>,
+                 std::vector<double>, std::vector<tstorage>>;
+
+template <class T> static T element_cast(const tstorage &value) {
+  if constexpr (std::same_as<T, tstorage>)
+    return value;
+  else
+    return std::visit(
+        []<class U>(const U &element) -> T {
+          if constexpr (std::is_arithmetic_v<U>)
+            return static_cast<T>(element);
+          else
+            std::unreachable();
+        },
+        value);
+}
+
+template <class T>
+static std::vector<T> flatten(std::span<const tstorage> values,
+                              std::size_t size) {
+  std::vector<T> result;
+  result.reserve(size);
+  for (const tstorage &value : values)
+    if (const tvector *vector = get_elements(value))
+      vector->visit([&]<class U>(std::span<const U> elements) {
+        if constexpr (std::same_as<T, U>)
+          result.insert(result.end(), elements.begin(), elements.end());
+        else
+          for (U element : elements)
+            result.push_back(T(element));
+      });
+    else
+      result.push_back(element_cast<T>(value));
+
+  return result;
+}
+
+/**
+ * Gathers the elements of the @p values.
+ *
+ * The elements of a vector or a matrix are used as separate values.
+ *
+ * @throws std::out_of_range when @p values is empty.
+ */
+static tselection gather(std::span<const tstorage> values) {
+  if (values.empty())
+    throw std::out_of_range("The stack doesn't contain an element");
+
+  bool signed_integral = false;
+  bool unsigned_integral = false;
+  bool floating_point = false;
+  bool rational = false;
+  bool negative = false;
+  bool large = false;
+  std::size_t size = 0;
+  auto add = [&]<class T>(std::span<const T> elements) {
+    size += elements.size();
+    if constexpr (std::same_as<T, std::int64_t>) {
+      signed_integral = true;
+      negative = negative || std::ranges::any_of(elements, [](T element) {
+                   return element < 0;
+                 });
+    } else if constexpr (std::same_as<T, std::uint64_t>) {
+      unsigned_integral = true;
+      large = large || std::ranges::any_of(elements, [](T element) {
+                return element > std::uint64_t(
+                                      std::numeric_limits<std::int64_t>::max());
+              });
+    } else if constexpr (std::same_as<T, double>)
+      floating_point = true;
+    else
+      rational = true;
+  };
+
+  for (const tstorage &value : values)
+    if (const tvector *vector = get_elements(value))
+      vector->visit(add);
+    else
+      std::visit(
+          [&]<class T>(const T &element) {
+            if constexpr (!std::same_as<T, tvector> &&
+                          !std::same_as<T, tmatrix>)
+              add(std::span<const T>{&element, 1});
+          },
+          value);
+
+  if (floating_point && !signed_integral && !unsigned_integral && !rational)
+    return flatten<double>(values, size);
+
+  if (!floating_point && !rational) {
+    // Like pack, mixed integrals use the type that can store all values.
+    if (!signed_integral || (unsigned_integral && !negative))
+      return flatten<std::uint64_t>(values, size);
+    if (!unsigned_integral || !large)
+      return flatten<std::int64_t>(values, size);
+  }
+
+  return flatten<tstorage>(values, size);
+}
+
+static bool is_nan_element(double value) { return std::isnan(value); }
+static bool is_nan_element(std::int64_t) { return false; }
+static bool is_nan_element(std::uint64_t) { return false; }
+static bool is_nan_element(const tstorage &value) {
+  return std::holds_alternative<double>(value) &&
+         std::isnan(std::get<double>(value));
+}
+
+/**
+ * Selects the quantiles @p probabilities of the @p elements.
+ *
+ * The quantile q is the element at rank h = q * (n - 1). When h is not an
+ * integral, the elements at the ranks around h are interpolated linearly.
+ *
+ * Every rank is selected with @c std::nth_element, which takes linear time.
+ * After selecting a rank, the larger ranks are in the part after it, so the
+ * next selection only searches that part.
+ *
+ * @pre @p probabilities is sorted and its values are in the range [0, 1].
+ * @pre @p elements doesn't contain a NaN.
+ */
+template <class T>
+static std::vector<tstorage> select(std::vector<T> &elements,
+                                    std::span<const double> probabilities) {
+  auto less = [](const T &lhs, const T &rhs) {
+    if constexpr (std::same_as<T, tstorage>)
+      return compare(lhs, rhs) < 0;
+    else
+      return lhs < rhs;
+  };
+
+  std::vector<tstorage> result;
+  result.reserve(probabilities.size());
+  const std::size_t last = elements.size() - 1;
+  auto first = elements.begin();
+  for (double probability : probabilities) {
+    const double rank = probability * static_cast<double>(last);
+    const auto low = std::min(static_cast<std::size_t>(rank), last);
+    const double fraction = rank - static_cast<double>(low);
+
+    const auto nth = elements.begin() + low;
+    std::nth_element(first, nth, elements.end(), less);
+    first = nth;
+
+    if (fraction == 0. || low == last) {
+      result.push_back(tstorage{*nth});
+      continue;
+    }
+
+    const T &high = *std::min_element(nth + 1, elements.end(), less);
+    if (!less(*nth, high))
+      result.push_back(tstorage{*nth});
+    else
+      result.push_back(std::lerp(double_cast(tstorage{*nth}),
+                                 double_cast(tstorage{high}), fraction));
+  }
+
+  return result;
+}
+
+static double probability_cast(const tstorage &value) {
+  const double result = double_cast(value);
+  if (!(result >= 0. && result <= 1.))
+    throw std::range_error("Not a probability");
+  return result;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#quantile */
+export tstorage quantile(std::span<const tstorage> values,
+                         const tstorage &probability) {
+  std::vector<double> probabilities;
+  if (std::holds_alternative<tvector>(probability))
+    std::get<tvector>(probability)
+        .visit([&]<class T>(std::span<const T> elements) {
+          for (T element : elements)
+            probabilities.push_back(probability_cast(tstorage{element}));
+        });
+  else if (std::holds_alternative<tmatrix>(probability))
+    throw std::domain_error("Not a vector");
+  else
+    probabilities.push_back(probability_cast(probability));
+
+  // The ranks are selected in ascending order, the permutation restores the
+  // order of the probabilities.
+  std::vector<std::size_t> permutation(probabilities.size());
+  std::iota(permutation.begin(), permutation.end(), 0);
+  std::ranges::sort(permutation, {}, [&](std::size_t index) {
+    return probabilities[index];
+  });
+  std::vector<double> sorted;
+  sorted.reserve(probabilities.size());
+  for (std::size_t index : permutation)
+    sorted.push_back(probabilities[index]);
+
+  tselection elements = gather(values);
+  std::vector<tstorage> selected = std::visit(
+      [&]<class T>(std::vector<T> &elements) {
+        if (std::ranges::any_of(elements, [](const T &element) {
+              return is_nan_element(element);
+            }))
+          return std::vector<tstorage>(
+              sorted.size(), std::numeric_limits<double>::quiet_NaN());
+
+        return select(elements, sorted);
+      },
+      elements);
+
+  if (!std::holds_alternative<tvector>(probability))
+    return selected[0];
+
+  std::vector<double> result(selected.size());
+  for (std::size_t i = 0; i < permutation.size(); ++i)
+    result[permutation[i]] = double_cast(selected[i]);
+  return tvector{std::move(result)};
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#median */
+export tstorage median(std::span<const tstorage> values) {
+  return quantile(values, tstorage{0.5});
+}
+
+/*** Histogram ***/
+
+/** Determines the range of the elements, NaNs are ignored. */
+template <class T> class trange final {
+public:
+  [[gnu::always_inline]] void operator()(simd::tregister<T> value) {
+    simd::tregister<double> element;
+    if constexpr (std::same_as<T, double>)
+      element = value;
+    else
+      element = __builtin_convertvector(value, simd::tregister<double>);
+    // A comparison with a NaN is false, so a NaN is never selected.
+    minimum_ = element < minimum_ ? element : minimum_;
+    maximum_ = element > maximum_ ? element : maximum_;
+  }
+
+  [[gnu::always_inline]] void operator()(T value) {
+    const double element = static_cast<double>(value);
+    minimum_[0] = element < minimum_[0] ? element : minimum_[0];
+    maximum_[0] = element > maximum_[0] ? element : maximum_[0];
+  }
+
+  [[nodiscard]] std::pair<double, double> result() const {
+    std::pair result{minimum_[0], maximum_[0]};
+    for (std::size_t i = 1; i < simd::lanes<double>; ++i) {
+      result.first = std::min(result.first, minimum_[i]);
+      result.second = std::max(result.second, maximum_[i]);
+    }
+    return result;
+  }
+
+private:
+  static constexpr double infinity = std::numeric_limits<double>::infinity();
+
+  simd::tregister<double> minimum_{simd::tregister<double>{} + infinity};
+  simd::tregister<double> maximum_{simd::tregister<double>{} - infinity};
+};
+
+/**
+ * Counts the elements per bucket.
+ *
+ * The bucket indices of a register are calculated with SIMD instructions.
+ * Every lane counts in its own histogram, so incrementing the same bucket in
+ * multiple lanes doesn't cause a dependency between the increments.
+ *
+ * The values are halved before subtracting the offset, so the difference
+ * can't overflow. The difference is divided by the width before multiplying
+ * by the number of buckets, so a tiny width can't overflow either. A NaN is
+ * counted in an extra bucket that isn't part of the result.
+ */
+template <class T> class tbucket final {
+public:
+  /** @pre @p width > 0. */
+  tbucket(double offset, double width, std::size_t buckets)
+      : offset_(offset), width_(width),
+        buckets_(static_cast<double>(buckets)),
+        last_(static_cast<double>(buckets - 1)),
+        nan_(static_cast<double>(buckets)), stride_(buckets + 1),
+        counts_(simd::lanes<double> * stride_) {}
+
+  [[gnu::always_inline]] void operator()(simd::tregister<T> value) {
+    simd::tregister<double> element;
+    if constexpr (std::same_as<T, double>)
+      element = value;
+    else
+      element = __builtin_convertvector(value, simd::tregister<double>);
+
+    const simd::tregister<double> last = simd::tregister<double>{} + last_;
+    const simd::tregister<double> nan = simd::tregister<double>{} + nan_;
+    simd::tregister<double> bucket =
+        (element * .5 - offset_) / width_ * buckets_;
+    bucket = bucket < last ? bucket : last;
+    bucket = element != element ? nan : bucket;
+
+    const simd::tregister<std::int64_t> index =
+        __builtin_convertvector(bucket, simd::tregister<std::int64_t>);
+    for (std::size_t i = 0; i < simd::lanes<double>; ++i)
+      ++counts_[i * stride_ + static_cast<std::size_t>(index[i])];
+  }
+
+  [[gnu::always_inline]] void operator()(T value) {
+    const double element = static_cast<double>(value);
+    double bucket = (element * .5 - offset_) / width_ * buckets_;
+    bucket = bucket < last_ ? bucket : last_;
+    bucket = std::isnan(element) ? nan_ : bucket;
+    ++counts_[static_cast<std::size_t>(bucket)];
+  }
+
+  /** Adds the counts of every lane to @p result. */
+  void merge(std::span<std::uint64_t> result) const {
+    for (std::size_t i = 0; i < simd::lanes<double>; ++i)
+      for (std::size_t j = 0; j < result.size(); ++j)
+        result[j] += counts_[i * stride_ + j];
+  }
+
+private:
+  double offset_;
+  double width_;
+  double buckets_;
+  double last_;
+  double nan_;
+  std::size_t stride_;
+  std::vector<std::uint64_t> counts_;
+};
+
+using tcounts = std::vector<std::uint64_t>;
+
+static tcounts merge_histograms(tcounts lhs, const tcounts &rhs) {
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    lhs[i] += rhs[i];
+  return lhs;
+}
+
+/** @see https://mordante.github.io/rpn/calculation.html#histogram */
+export tstorage hist(std::span<const tstorage> values, std::size_t buckets) {
+  if (values.empty())
+    throw std::out_of_range("The stack doesn't contain an element");
+
+  // The scalars are processed like the elements of one extra vector.
+  std::vector<double> scalars;
+  std::vector<tvector> vectors;
+  for (const tstorage &value : values)
+    if (const tvector *vector = get_elements(value))
+      vectors.push_back(*vector);
+    else
+      scalars.push_back(double_cast(value));
+  if (!scalars.empty())
+    vectors.push_back(tvector{std::move(scalars)});
+
+  double minimum = std::numeric_limits<double>::infinity();
+  double maximum = -std::numeric_limits<double>::infinity();
+  for (const tvector &vector : vectors) {
+    const auto [first, last] =
+        vector.visit([]<class T>(std::span<const T> elements) {
+          return lib::parallel_reduce(
+              elements.size(),
+              [elements](std::size_t first, std::size_t last) {
+                trange<T> range;
+                simd::accumulate(elements.data() + first, last - first, range);
+                return range.result();
+              },
+              [](std::pair<double, double> lhs,
+                 std::pair<double, double> rhs) {
+                return std::pair{std::min(lhs.first, rhs.first),
+                                 std::max(lhs.second, rhs.second)};
+              });
+        });
+    minimum = std::min(minimum, first);
+    maximum = std::max(maximum, last);
+  }
+
+  tcounts result(buckets);
+  // Without a range all values are NaNs, these aren't counted.
+  if (minimum > maximum)
+    return tvector{std::move(result)};
+
+  if (std::isinf(minimum) || std::isinf(maximum))
+    throw std::domain_error("Not a finite value");
+
+  const double offset = minimum * .5;
+  // When all values are equal, after halving, they are in the first bucket.
+  const double width =
+      maximum * .5 - offset == 0. ? 1. : maximum * .5 - offset;
+  for (const tvector &vector : vectors)
+    result = merge_histograms(
+        std::move(result),
+        vector.visit([&]<class T>(std::span<const T> elements) {
+          return lib::parallel_reduce(
+              elements.size(),
+              [&](std::size_t first, std::size_t last) {
+                tbucket<T> bucket{offset, width, buckets};
+                simd::accumulate(elements.data() + first, last - first,
+                                 bucket);
+                tcounts counts(buckets);
+                bucket.merge(counts);
+                return counts;
+              },
+              &merge_histograms);
+        }));
+
+  return tvector{std::move(result)};
+}
+
+} // namespace math
+} // namespace calculator
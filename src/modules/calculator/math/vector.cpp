@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module calculator.math.vector;
+
+import lib.parallel;
+import std;
+
+namespace calculator {
+namespace math {
+
+/** The types that can be stored as elements of a @ref tvector. */
+export template <class T>
+concept is_element = std::same_as<T, std::int64_t> ||
+                     std::same_as<T, std::uint64_t> || std::same_as<T, double>;
+
+/**
+ * An arithmetic sequence, the element at index @c i is @c start + @c i *
+ * @c step.
+ *
+ * The integral elements are calculated modulo 2^64. This allows a decreasing
+ * sequence of @c std::uint64_t and a @c step that doesn't fit in @c T. A
+ * valid sequence has elements that fit in @c T when calculated without the
+ * modulo, so the first and last element are its extrema.
+ */
+export template <is_element T> struct tsequence {
+  T start;
+  T step;
+  std::size_t count;
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept { return count; }
+
+  /** @pre @p index < @ref count. */
+  [[nodiscard]] constexpr T operator[](std::size_t index) const noexcept {
+    if constexpr (std::same_as<T, double>)
+      return start + static_cast<double>(index) * step;
+    else
+      return static_cast<T>(static_cast<std::uint64_t>(start) +
+                            index * static_cast<std::uint64_t>(step));
+  }
+};
+
+/**
+ * The calculation of the elements of a deferred vector.
+ *
+ * The elements are @c double values, they are calculated in parts by
+ * @ref evaluate.
+ */
+export class texpression {
+public:
+  texpression(std::size_t size, std::size_t depth) noexcept
+      : size_(size), depth_(depth) {}
+  virtual ~texpression() = default;
+
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+  /** The number of operations in the longest chain of the calculation. */
+  [[nodiscard]] std::size_t depth() const noexcept { return depth_; }
+
+  /** Stores the elements [first, first + size) in @p result. */
+  virtual void evaluate(std::size_t first, std::size_t size,
+                        double *result) const = 0;
+
+private:
+  std::size_t size_;
+  std::size_t depth_;
+};
+
+/**
+ * A vector of numeric values.
+ *
+ * The elements are stored contiguously and all have the same type, this allows
+ * processing them with SIMD instructions.
+ *
+ * The elements are immutable and shared between copies. Values are copied
+ * often, for example every undo step stores a copy. Sharing the elements
+ * makes these copies cheap, regardless of the size of the vector.
+ *
+ * A vector can also be lazy, either a @ref tsequence or a deferred
+ * @ref texpression. Then the elements are only stored when they are accessed
+ * with @ref get or @ref visit. Operations that can use the sequence directly,
+ * like adding a scalar or summing the elements, use @ref visit_sequence
+ * instead. Deferred operations use @ref evaluate, which calculates a part of
+ * the elements without storing them.
+ *
+ * The special member functions are constexpr, so the class can be stored in a
+ * @c std::variant that is used in constant expressions. A vector is never
+ * created during constant evaluation.
+ */
+export class tvector final {
+public:
+  /** @pre @p elements is not empty. */
+  template <is_element T>
+  explicit tvector(std::vector<T> elements)
+      : block_(new tblock{std::move(elements)}) {}
+
+  /** @pre @p sequence is not empty and valid. */
+  template <is_element T>
+  explicit tvector(tsequence<T> sequence)
+      : block_(new tblock{.elements = std::vector<T>{},
+                          .sequence = sequence,
+                          .stored = false}) {}
+
+  /** @pre @p expression has elements. */
+  explicit tvector(std::unique_ptr<const texpression> expression)
+      : block_(new tblock{.elements = std::vector<double>{},
+                          .size = expression->size(),
+                          .depth = expression->depth(),
+                          .expression = std::move(expression),
+                          .stored = false}) {}
+
+  constexpr tvector(const tvector &other) noexcept : block_(other.block_) {
+    acquire();
+  }
+  constexpr tvector(tvector &&other) noexcept
+      : block_(std::exchange(other.block_, nullptr)) {}
+
+  constexpr ~tvector() { release(); }
+
+  constexpr tvector &operator=(const tvector &other) noexcept {
+    tvector copy{other};
+    std::swap(block_, copy.block_);
+    return *this;
+  }
+  constexpr tvector &operator=(tvector &&other) noexcept {
+    std::swap(block_, other.block_);
+    return *this;
+  }
+
+  /** Is the vector a @ref tsequence? */
+  [[nodiscard]] bool holds_sequence() const noexcept {
+    return block_->sequence.has_value();
+  }
+
+  /** Are the elements stored? Only a lazy vector calculates its elements. */
+  [[nodiscard]] bool stored() const noexcept {
+    return block_->stored.load(std::memory_order_acquire);
+  }
+
+  /**
+   * The number of deferred operations needed to calculate the elements.
+   *
+   * This is zero when the elements are stored.
+   */
+  [[nodiscard]] std::size_t depth() const noexcept {
+    return stored() ? 0 : block_->depth;
+  }
+
+  /**
+   * Calls @p visitor with the @ref tsequence<T> of the elements.
+   *
+   * @pre @ref holds_sequence().
+   */
+  template <class Visitor>
+  decltype(auto) visit_sequence(Visitor &&visitor) const {
+    return std::visit(std::forward<Visitor>(visitor), *block_->sequence);
+  }
+
+  /** Two vectors are equal when their elements have the same type and value. */
+  friend bool operator==(const tvector &lhs, const tvector &rhs) {
+    // Equal integral sequences have the same representation, comparing that
+    // avoids storing their elements.
+    if (lhs.holds_sequence() && rhs.holds_sequence() && !lhs.holds<double>() &&
+        lhs.block_->elements.index() == rhs.block_->elements.index())
+      return lhs.visit_sequence([&]<class T>(const tsequence<T> &l) {
+        const tsequence<T> &r = std::get<tsequence<T>>(*rhs.block_->sequence);
+        return l.count == r.count && l.start == r.start &&
+               (l.count == 1 || l.step == r.step);
+      });
+
+    return lhs.elements() == rhs.elements();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    if (holds_sequence())
+      return visit_sequence(
+          [](const auto &sequence) { return sequence.count; });
+    if (!stored())
+      return block_->size;
+
+    return std::visit([](const auto &elements) { return elements.size(); },
+                      block_->elements);
+  }
+
+  template <is_element T> [[nodiscard]] bool holds() const noexcept {
+    return std::holds_alternative<std::vector<T>>(block_->elements);
+  }
+
+  /** @pre @ref holds<T>(). */
+  template <is_element T> [[nodiscard]] std::span<const T> get() const {
+    return std::get<std::vector<T>>(elements());
+  }
+
+  /** Calls @p visitor with a @c std::span<const T> of the elements. */
+  template <class Visitor> decltype(auto) visit(Visitor &&visitor) const {
+    return std::visit(
+        [&visitor]<class T>(const std::vector<T> &elements) -> decltype(auto) {
+          return std::invoke(std::forward<Visitor>(visitor),
+                             std::span<const T>{elements});
+        },
+        elements());
+  }
+
+  /**
+   * Stores the elements [first, first + size) as @c double in @p result.
+   *
+   * Unlike @ref visit this doesn't store the elements of a lazy vector.
+   */
+  void evaluate(std::size_t first, std::size_t size, double *result) const {
+    if (stored())
+      visit([&](auto elements) {
+        for (std::size_t i = 0; i < size; ++i)
+          result[i] = static_cast<double>(elements[first + i]);
+      });
+    else if (holds_sequence())
+      visit_sequence([&](const auto &sequence) {
+        for (std::size_t i = 0; i < size; ++i)
+          result[i] = static_cast<double>(sequence[first + i]);
+      });
+    else if (std::shared_ptr<const texpression> expression = this->expression())
+      expression->evaluate(first, size, result);
+    else
+      // Another thread stored the elements.
+      evaluate(first, size, result);
+  }
+
+  /**
+   * Calls @p visitor with a @c std::span<const T> of consecutive parts of the
+   * elements [first, last).
+   *
+   * Unlike @ref visit this doesn't store the elements of a lazy vector. They
+   * are calculated in parts of at most @ref part_size elements, the elements
+   * of a sequence keep their type.
+   */
+  template <class Visitor>
+  void visit_parts(std::size_t first, std::size_t last,
+                   Visitor &&visitor) const {
+    if (stored())
+      visit([&](auto elements) {
+        std::invoke(visitor, elements.subspan(first, last - first));
+      });
+    else if (holds_sequence())
+      visit_sequence([&]<class T>(const tsequence<T> &sequence) {
+        std::array<T, part_size> buffer;
+        for (; first < last; first += part_size) {
+          const std::size_t size = std::min(part_size, last - first);
+          for (std::size_t i = 0; i < size; ++i)
+            buffer[i] = sequence[first + i];
+          std::invoke(visitor, std::span<const T>{buffer.data(), size});
+        }
+      });
+    else {
+      std::array<double, part_size> buffer;
+      for (; first < last; first += part_size) {
+        const std::size_t size = std::min(part_size, last - first);
+        evaluate(first, size, buffer.data());
+        std::invoke(visitor, std::span<const double>{buffer.data(), size});
+      }
+    }
+  }
+
+  /** The maximum number of elements in a part of @ref visit_parts. */
+  static constexpr std::size_t part_size = 1024;
+
+private:
+  using telements =
+      std::variant<std::vector<std::int64_t>, std::vector<std::uint64_t>,
+                   std::vector<double>>;
+
+  struct tblock {
+    /** For a lazy vector the elements are empty until they are stored. */
+    telements elements;
+    std::optional<std::variant<tsequence<std::int64_t>,
+                               tsequence<std::uint64_t>, tsequence<double>>>
+        sequence{};
+    /** The number of elements of a deferred vector. */
+    std::size_t size{0};
+    /** The depth of a deferred vector, see @ref tvector::depth. */
+    std::size_t depth{0};
+    /**
+     * The calculation of a deferred vector.
+     *
+     * It's released when the elements are stored, this releases its operands.
+     */
+    std::shared_ptr<const texpression> expression{};
+    std::mutex expression_mutex{};
+    std::once_flag materialized{};
+    std::atomic<bool> stored{true};
+    std::atomic<std::size_t> references{1};
+  };
+
+  /** Returns the elements, a lazy vector stores them on the first call. */
+  const telements &elements() const {
+    if (!stored())
+      std::call_once(block_->materialized, [this] {
+        std::visit(
+            [this]<class T>(std::vector<T> &elements) {
+              elements.resize(size());
+              lib::parallel_for(
+                  elements.size(), [&](std::size_t first, std::size_t last) {
+                    calculate(first, last - first, elements.data() + first);
+                  });
+            },
+            block_->elements);
+        block_->stored.store(true, std::memory_order_release);
+
+        // Destroys the expression after unlocking the mutex.
+        std::shared_ptr<const texpression> expression;
+        std::lock_guard lock{block_->expression_mutex};
+        expression.swap(block_->expression);
+      });
+
+    return block_->elements;
+  }
+
+  /** @returns The expression, @c nullptr once the elements are stored. */
+  std::shared_ptr<const texpression> expression() const {
+    std::lock_guard lock{block_->expression_mutex};
+    return block_->expression;
+  }
+
+  /** Calculates the elements [first, first + size) of a lazy vector. */
+  template <is_element T>
+  void calculate(std::size_t first, std::size_t size, T *result) const {
+    if (holds_sequence())
+      visit_sequence([&](const auto &sequence) {
+        for (std::size_t i = 0; i < size; ++i)
+          result[i] = static_cast<T>(sequence[first + i]);
+      });
+    else if constexpr (std::same_as<T, double>)
+      block_->expression->evaluate(first, size, result);
+  }
+
+  constexpr void acquire() noexcept {
+    if !consteval {
+      if (block_)
+        block_->references.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  constexpr void release() noexcept {
+    if !consteval {
+      if (block_ &&
+          block_->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete block_;
+    }
+  }
+
+  tblock *block_;
+};
+
+} // namespace math
+} // namespace calculator
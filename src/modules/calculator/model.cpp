@@ -119,6 +119,13 @@ public:
   /** Toggles the display of type debug info in the output. */
   void debug_mode_toggle() { stack_.debug_mode_toggle(); }
 
+  [[nodiscard]] tnotation notation() const noexcept {
+    return stack_.notation();
+  }
+
+  /** Sets the notation used to display @c double values. */
+  void notation_set(tnotation notation) { stack_.notation_set(notation); }
+
 private:
   /** The execution issues to report to the user. */
   std::string diagnotics_{};
@@ -15,34 +15,455 @@
 export module calculator.stack;
 
 export import calculator.value;
+import calculator.math.rational;
+import calculator.math.vector;
 import lib.base;
+import lib.parallel;
+import lib.table;
 import std;
 
 namespace calculator {
 
+/** The notation used to display @c double values. */
+export struct tnotation {
+  enum class tstyle {
+    /** The shortest output that converts back to the same value. */
+    shortest,
+    /** Shows @ref precision digits after the decimal point. */
+    fixed,
+    /** Shows an exponent and @ref precision digits after the decimal point. */
+    scientific
+  };
+
+  /** The largest supported precision. */
+  static constexpr std::size_t precision_max =
+      std::numeric_limits<double>::max_digits10;
+
+  tstyle style{tstyle::shortest};
+
+  /** Unused for @ref tstyle::shortest. */
+  int precision{0};
+
+  bool operator==(const tnotation &) const = default;
+};
+
+/** The settings used to render the values of a @ref tstack. */
+struct tdisplay_mode {
+  /**
+   * The base used to display the contents of the stack.
+   *
+   * @note The input is always base 10, unless the user enters a base prefix.
+   */
+  lib::tbase base{lib::tbase::decimal};
+
+  /** Whether or not the grouping symbols are shown in the output. */
+  bool grouping{true};
+
+  /** Show debug information in the output? */
+  bool debug_mode{false};
+
+  /** The notation used to display the @c double values. */
+  tnotation notation{};
+
+  bool operator==(const tdisplay_mode &) const = default;
+};
+
+/**
+ * The shadow stack with values rendered as strings in one display mode.
+ *
+ * The size always matches the size of the stack. The display is a cache of the
+ * rendered values. When the generation of a rendered value differs from the
+ * generation of the display its contents are out of sync.
+ *
+ * The characters of the rendered values are stored in one arena. Rendering a
+ * value appends its characters to the arena, the characters of the old value
+ * remain unused until the arena is compacted. This avoids an allocation per
+ * rendered value and keeps the shown values close together.
+ *
+ * The functions rendering values use a @c format function, which renders the
+ * value at the given index of the stack.
+ */
+class tdisplay final {
+public:
+  /** @returns The mode of the display, a display without a mode is unused. */
+  [[nodiscard]] const std::optional<tdisplay_mode> &mode() const noexcept {
+    return mode_;
+  }
+
+  /** @returns The low-water mark, see @ref synced_. */
+  [[nodiscard]] std::size_t synced() const noexcept { return synced_; }
+
+  /** Reuses the display for @p mode, without touching its rendered values. */
+  void reset(tdisplay_mode mode) noexcept {
+    mode_ = mode;
+    ++generation_;
+    synced_ = 0;
+  }
+
+  /**
+   * @returns The rendered values in the range [@p first, @p last).
+   *
+   * The returned views are valid until the display is modified or renders
+   * values.
+   */
+  [[nodiscard]] std::vector<std::string_view>
+  strings(std::size_t first, std::size_t last, auto format) {
+    compact();
+
+    // The values below the low-water mark are in sync.
+    const bool contiguous = first <= synced_;
+    for (std::size_t i = contiguous ? std::max(first, synced_) : first;
+         i < last; ++i)
+      synchronise(i, format);
+
+    if (contiguous)
+      synced_ = std::max(synced_, last);
+
+    std::vector<std::string_view> result;
+    result.reserve(last - first);
+    for (std::size_t i = first; i < last; ++i)
+      result.emplace_back(arena_.data() + entries_[i].offset,
+                          entries_[i].size);
+    return result;
+  }
+
+  /**
+   * Stores the @p strings rendered elsewhere, starting at index @p first.
+   *
+   * Only the values that are out of sync are stored.
+   *
+   * @pre The @p strings are rendered in the mode of the display.
+   */
+  void store(std::size_t first, const std::vector<std::string> &strings) {
+    for (std::size_t i = 0; i < strings.size(); ++i)
+      if (entries_[first + i].generation != generation_)
+        assign(entries_[first + i], strings[i]);
+
+    if (first <= synced_)
+      synced_ = std::max(synced_, first + strings.size());
+  }
+
+  // *** Modifiers of the stack ***
+
+  void push() { entries_.emplace_back(); }
+
+  /** The duplicate shares the characters of the original. */
+  void duplicate() {
+    entries_.push_back(entries_.back());
+    used_ += entries_.back().size;
+  }
+
+  void permute(std::span<const std::size_t> permutation);
+
+  void pop(std::size_t count) {
+    const std::size_t size = entries_.size() - count;
+    for (std::size_t i = size; i < entries_.size(); ++i)
+      used_ -= entries_[i].size;
+    entries_.resize(size);
+    synced_ = std::min(synced_, size);
+    compact();
+  }
+
+private:
+  /** A rendered value in the arena. */
+  struct tentry {
+    std::size_t offset{0};
+    std::size_t size{0};
+
+    /** The generation of the rendered value, 0 is never in sync. */
+    std::uint64_t generation{0};
+  };
+
+  /** Renders the value at @p index when it's out of sync. */
+  void synchronise(std::size_t index, auto format) {
+    if (entries_[index].generation != generation_)
+      assign(entries_[index], format(index));
+  }
+
+  void assign(tentry &entry, std::string_view string) {
+    used_ -= entry.size;
+    entry = {arena_.size(), string.size(), generation_};
+    arena_.append(string);
+    used_ += string.size();
+  }
+
+  /**
+   * Compacts the arena when most of its characters are unused.
+   *
+   * The values that are out of sync are removed from the arena.
+   */
+  void compact();
+
+  /** Below this size the arena isn't compacted. */
+  static constexpr std::size_t compact_size_min = 1 << 16;
+
+  std::optional<tdisplay_mode> mode_{};
+
+  std::vector<tentry> entries_{};
+
+  /** The characters of the rendered values. */
+  std::string arena_{};
+
+  /**
+   * The number of characters in @ref arena_ used by @ref entries_.
+   *
+   * Duplicates are counted for every entry, so the value may exceed the size
+   * of the arena.
+   */
+  std::size_t used_{0};
+
+  /** The generation of the values rendered in the current mode. */
+  std::uint64_t generation_{0};
+
+  /**
+   * The low-water mark of the display.
+   *
+   * The rendered values in the range [0, synced_) are in sync. This avoids
+   * scanning the entire stack after a push or pop.
+   */
+  std::size_t synced_{0};
+};
+
+void tdisplay::permute(std::span<const std::size_t> permutation) {
+  // An out of sync value can be moved below the low-water mark.
+  synced_ = 0;
+
+  std::vector<tentry> entries;
+  entries.reserve(permutation.size());
+  for (std::size_t index : permutation)
+    entries.push_back(entries_[index]);
+  entries_ = std::move(entries);
+}
+
+void tdisplay::compact() {
+  if (arena_.size() < compact_size_min || used_ > arena_.size() / 2)
+    return;
+
+  std::string arena;
+  arena.reserve(std::min(used_, arena_.size()));
+  for (tentry &entry : entries_) {
+    if (entry.generation != generation_) {
+      entry = {};
+      continue;
+    }
+    const std::size_t offset = arena.size();
+    arena.append(arena_, entry.offset, entry.size);
+    entry.offset = offset;
+  }
+  arena_ = std::move(arena);
+  used_ = arena_.size();
+}
+
+static std::string format(const tdisplay_mode &mode, const tvalue &value);
+
+/**
+ * Formats values of a stack on a background thread.
+ *
+ * A job formats a range of values in batches, the values of a batch are
+ * formatted in parallel by the formatter's pool of workers. The batches are
+ * small, so the workers are started once instead of per batch. The formatter doesn't modify a display, instead the
+ * owner of the display collects the results. So the display is only used by
+ * its owner's thread.
+ *
+ * Every job has a number. Starting or cancelling a job changes the number, the
+ * results of older jobs are discarded. The values of a batch are copied while
+ * holding the lock, the owner needs to hold the lock while modifying the
+ * values. When a modification invalidates the range of the job, the job needs
+ * to be cancelled before releasing the lock.
+ */
+class tbackground_formatter final {
+public:
+  /** The strings of the values in [first, first + strings.size()). */
+  struct tresult {
+    std::uint64_t job;
+    std::size_t first;
+    std::vector<std::string> strings;
+  };
+
+  explicit tbackground_formatter(const std::vector<tvalue> &values)
+      : values_(values) {}
+
+  [[nodiscard]] std::unique_lock<std::mutex> lock() {
+    return std::unique_lock{values_mutex_};
+  }
+
+  /**
+   * Starts formatting the values in [@p first, @p last) in @p mode.
+   *
+   * @returns The number of the new job.
+   */
+  std::uint64_t start(tdisplay_mode mode, std::size_t first, std::size_t last);
+
+  /** @returns Whether the cancelled job was still running. */
+  bool cancel();
+
+  /** @returns The results of the finished batches. */
+  [[nodiscard]] std::vector<tresult> collect();
+
+private:
+  void run(std::stop_token stop_token);
+
+  /** The number of values formatted per batch. */
+  static constexpr std::size_t batch_size = 1 << 14;
+
+  /** The number of values formatted per chunk of the @ref pool_. */
+  static constexpr std::size_t grain_size = 1 << 10;
+
+  const std::vector<tvalue> &values_;
+  std::mutex values_mutex_;
+
+  /** Guards the members below. */
+  std::mutex mutex_;
+  std::condition_variable_any condition_;
+  std::uint64_t job_{0};
+  tdisplay_mode mode_{};
+  std::size_t first_{0};
+  std::size_t last_{0};
+  std::vector<tresult> results_{};
+
+  /** Only used by @ref thread_. */
+  lib::tworker_pool pool_{};
+
+  /** Declared last, so the thread stops before the other members die. */
+  std::jthread thread_{[this](std::stop_token token) { run(token); }};
+};
+
+std::uint64_t tbackground_formatter::start(tdisplay_mode mode,
+                                           std::size_t first,
+                                           std::size_t last) {
+  std::uint64_t result;
+  {
+    std::lock_guard lock{mutex_};
+    result = ++job_;
+    mode_ = mode;
+    first_ = first;
+    last_ = last;
+    results_.clear();
+  }
+  condition_.notify_one();
+  return result;
+}
+
+bool tbackground_formatter::cancel() {
+  std::lock_guard lock{mutex_};
+  ++job_;
+  results_.clear();
+  const bool result = first_ != last_;
+  first_ = last_;
+  return result;
+}
+
+std::vector<tbackground_formatter::tresult> tbackground_formatter::collect() {
+  std::lock_guard lock{mutex_};
+  return std::exchange(results_, {});
+}
+
+void tbackground_formatter::run(std::stop_token stop_token) {
+  while (true) {
+    std::unique_lock lock{mutex_};
+    if (!condition_.wait(lock, stop_token, [this] { return first_ != last_; }))
+      return;
+
+    const std::uint64_t job = job_;
+    const tdisplay_mode mode = mode_;
+    const std::size_t first = first_;
+    const std::size_t last = std::min(last_, first + batch_size);
+    lock.unlock();
+
+    std::vector<std::string> strings;
+    try {
+      // Copying a value only shares its elements. Formatting the copies
+      // doesn't block the owner modifying the values.
+      std::vector<tvalue> values;
+      {
+        std::lock_guard values_lock{values_mutex_};
+        if (std::lock_guard guard{mutex_}; job != job_)
+          continue;
+
+        const std::span batch = std::span{values_}.subspan(first, last - first);
+        values.assign(batch.begin(), batch.end());
+      }
+
+      strings.resize(values.size());
+      pool_.parallel_for(
+          strings.size(),
+          [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+              strings[i] = format(mode, values[i]);
+          },
+          grain_size);
+    } catch (...) {
+      // The owner formats the values itself. A newer job is kept.
+      std::lock_guard guard{mutex_};
+      if (job == job_)
+        first_ = last_;
+      continue;
+    }
+
+    lock.lock();
+    if (job != job_)
+      continue;
+
+    results_.push_back({job, first, std::move(strings)});
+    first_ = last;
+  }
+}
+
 export class tstack final {
 public:
+  tstack() noexcept { displays_.front().reset(mode_); }
+
+  // The background formatter refers to the values.
+  tstack(const tstack &) = delete;
+  tstack &operator=(const tstack &) = delete;
+
   // *** Query ***
 
   [[nodiscard]] bool empty() const noexcept { return values_.empty(); }
   [[nodiscard]] std::size_t size() const noexcept { return values_.size(); }
-  [[nodiscard]] const std::vector<std::string> &strings() const noexcept {
-    synchronise_display();
-    return strings_;
-  }
+  [[nodiscard]] std::vector<std::string> strings() const;
+
+  /**
+   * @returns The rendered values in the range [@p first, @p last).
+   *
+   * Only the values in the range are formatted, the other values remain out of
+   * sync until they are requested. This allows a view to only format the
+   * values it shows.
+   *
+   * The returned views are valid until the stack is modified or renders
+   * values.
+   *
+   * @pre @p first <= @p last <= @ref size().
+   */
+  [[nodiscard]] std::vector<std::string_view>
+  strings(std::size_t first, std::size_t last) const;
 
   // *** Modifiers ***
 
   /** Adds the @p value to the back of the stack. */
   void push(tvalue value) {
+    std::unique_lock lock = background_lock();
     values_.emplace_back(std::move(value));
-    strings_.emplace_back();
-    dirty_ = true;
+    std::ranges::for_each(displays_, &tdisplay::push);
   }
 
   /** Duplicates the last entry on the stack. */
   void duplicate();
 
+  /**
+   * Reorders the stack, the value at @c permutation[i] is moved to @c i.
+   *
+   * The rendered values are moved with their values, so they remain valid.
+   *
+   * @pre @p permutation is a permutation of [0, @ref size()).
+   */
+  void permute(std::span<const std::size_t> permutation);
+
+  /** @returns The values on the stack, the first item is the oldest item. */
+  [[nodiscard]] std::span<const tvalue> values() const noexcept {
+    return values_;
+  }
+
   /**
    * @returns The last element at the back of the stack.
    * @throws @ref std::out_of_range when the stack is empty.
@@ -53,30 +474,53 @@ public:
    * Removes the last element at the back of the stack
    * @throws @ref std::out_of_range when the stack is empty.
    */
-  void drop();
+  void drop() { drop(1); }
+
+  /**
+   * Removes the last @p count elements at the back of the stack.
+   *
+   * Unlike calling @ref drop() @p count times, this restarts the background
+   * formatting only once.
+   *
+   * @throws @ref std::out_of_range when the stack has less than @p count
+   * elements.
+   */
+  void drop(std::size_t count);
 
   void base_set(lib::tbase base) {
-    base_ = base;
-    invalidate_cache();
+    mode_.base = base;
+    display_select();
   }
 
   void grouping_toggle() {
-    grouping_ = !grouping_;
-    invalidate_cache();
+    mode_.grouping = !mode_.grouping;
+    display_select();
   }
 
   void debug_mode_toggle() {
-    debug_mode_ = !debug_mode_;
-    invalidate_cache();
+    mode_.debug_mode = !mode_.debug_mode;
+    display_select();
   }
 
-private:
-  void invalidate_cache() {
-    std::ranges::for_each(strings_,
-                          [](std::string &string) { string.clear(); });
-    dirty_ = true;
+  [[nodiscard]] tnotation notation() const noexcept { return mode_.notation; }
+
+  void notation_set(tnotation notation) {
+    mode_.notation = notation;
+    display_select();
   }
 
+  /**
+   * Enables or disables formatting on a background thread.
+   *
+   * When enabled, changing the display mode starts formatting the values on a
+   * background thread. The values are formatted in parallel. The values
+   * requested before the background thread formatted them are formatted on
+   * request. This keeps scrolling through a large stack responsive after
+   * changing the display mode.
+   */
+  void background_formatting_set(bool enable);
+
+private:
   /**
    * The stack with all values of the applications.
    *
@@ -86,45 +530,109 @@ private:
    */
   std::vector<tvalue> values_{};
 
+  /** The mode used to render the values. */
+  tdisplay_mode mode_{};
+
   /**
-   * The shadow stack with values rendered as strings.
+   * The number of display modes with cached rendered values.
    *
-   * The size always matches the size of @ref values_. The display is a cache of
-   * the rendered value. When it contains an empty string its contents are out
-   * of sync. When invalidating a cache entry the @ref dirty_ flag must be set.
+   * Switching back to a cached mode, for example toggling between hexadecimal
+   * and decimal, doesn't format the values again.
    */
-  mutable std::vector<std::string> strings_{};
-
-  /** Is the display in sync with the values? */
-  mutable bool dirty_{false};
+  static constexpr std::size_t display_cache_size = 4;
 
-  void synchronise_display() const;
+  /** The displays of the recently used display modes. */
+  mutable std::array<tdisplay, display_cache_size> displays_{};
 
-  [[nodiscard]] std::string format(const tvalue &value) const;
+  /**
+   * The indices in @ref displays_ from most to least recently used.
+   *
+   * The first element is the display of @ref mode_.
+   */
+  std::array<std::size_t, display_cache_size> recent_{0, 1, 2, 3};
 
-  /** The input buffer used to store the current editting session. */
-  std::string input_{};
+  [[nodiscard]] tdisplay &display() const noexcept {
+    return displays_[recent_.front()];
+  }
 
   /**
-   * The base used to display the contents of the stack.
+   * Selects the display of @ref mode_.
    *
-   * @note The input is always base 10, unless the user enters a base prefix.
+   * When the mode isn't cached the least recently used display is reused.
    */
-  lib::tbase base_{lib::tbase::decimal};
+  void display_select();
 
-  /** Whether or not the grouping symbols are shown in the output. */
-  bool grouping_{true};
+  /** @returns The function to format the value at an index of the stack. */
+  [[nodiscard]] auto formatter() const {
+    return [this](std::size_t index) { return format(mode_, values_[index]); };
+  }
 
-  /** Show debug information in the output? */
-  bool debug_mode_{false};
+  /** The background formatter, when enabled. */
+  std::unique_ptr<tbackground_formatter> background_{};
+
+  /** The job of @ref background_ formatting the current display. */
+  std::uint64_t background_job_{0};
+
+  /** @returns The lock to hold while modifying @ref values_. */
+  [[nodiscard]] std::unique_lock<std::mutex> background_lock() {
+    return background_ ? background_->lock() : std::unique_lock<std::mutex>{};
+  }
+
+  /** Starts formatting the out of sync values of the current display. */
+  void background_start();
+
+  /** Stores the values formatted by the background formatter. */
+  void background_collect() const;
+
+  /**
+   * Cancels the job of the background formatter.
+   *
+   * Used when a modification of the values invalidates the job. The finished
+   * work should be collected before the modification.
+   *
+   * @returns Whether the job needs to be restarted.
+   */
+  bool background_cancel();
 };
 
+std::vector<std::string> tstack::strings() const {
+  const std::vector<std::string_view> result = strings(0, values_.size());
+  return {result.begin(), result.end()};
+}
+
+std::vector<std::string_view>
+tstack::strings(std::size_t first, std::size_t last) const {
+  background_collect();
+  return display().strings(first, last, formatter());
+}
+
 void tstack::duplicate() {
   if (values_.empty())
     throw std::out_of_range("The stack doesn't contain an element");
 
+  std::unique_lock lock = background_lock();
   values_.push_back(values_.back());
-  strings_.push_back(strings_.back());
+  std::ranges::for_each(displays_, &tdisplay::duplicate);
+}
+
+void tstack::permute(std::span<const std::size_t> permutation) {
+  bool restart;
+  {
+    std::unique_lock lock = background_lock();
+    background_collect();
+
+    std::vector<tvalue> values;
+    values.reserve(permutation.size());
+    for (std::size_t index : permutation)
+      values.push_back(std::move(values_[index]));
+    values_ = std::move(values);
+
+    for (tdisplay &display : displays_)
+      display.permute(permutation);
+    restart = background_cancel();
+  }
+  if (restart)
+    background_start();
 }
 
 tvalue tstack::pop() {
@@ -132,28 +640,73 @@ tvalue tstack::pop() {
     throw std::out_of_range("The stack doesn't contain an element");
 
   tvalue result = values_.back();
-  values_.pop_back();
-  strings_.pop_back();
+  drop();
   return result;
 }
 
-void tstack::drop() {
-  if (values_.empty())
-    throw std::out_of_range("The stack doesn't contain an element");
+void tstack::drop(std::size_t count) {
+  if (values_.size() < count)
+    throw std::out_of_range(count == 1
+                                ? "The stack doesn't contain an element"
+                                : "The stack doesn't contain enough elements");
+
+  bool restart;
+  {
+    std::unique_lock lock = background_lock();
+    background_collect();
+    values_.erase(values_.end() - static_cast<std::ptrdiff_t>(count),
+                  values_.end());
+    for (tdisplay &display : displays_)
+      display.pop(count);
+    restart = background_cancel();
+  }
+  if (restart)
+    background_start();
+}
+
+void tstack::background_formatting_set(bool enable) {
+  if (!enable)
+    background_.reset();
+  else if (!background_)
+    background_ = std::make_unique<tbackground_formatter>(values_);
+}
 
-  values_.pop_back();
-  strings_.pop_back();
+void tstack::background_start() {
+  if (!background_)
+    return;
+
+  const tdisplay &current = display();
+  if (current.synced() == values_.size())
+    background_->cancel();
+  else
+    background_job_ =
+        background_->start(mode_, current.synced(), values_.size());
 }
 
-void tstack::synchronise_display() const {
-  if (!dirty_)
+void tstack::background_collect() const {
+  if (!background_)
     return;
 
-  for (std::size_t i = 0; i < strings_.size(); ++i)
-    if (strings_[i].empty())
-      strings_[i] = format(values_[i]);
+  for (const tbackground_formatter::tresult &result : background_->collect())
+    if (result.job == background_job_)
+      display().store(result.first, result.strings);
+}
 
-  dirty_ = false;
+bool tstack::background_cancel() {
+  return background_ && background_->cancel();
+}
+
+void tstack::display_select() {
+  auto iter = std::ranges::find(recent_, std::optional{mode_},
+                                [this](std::size_t index) {
+                                  return displays_[index].mode();
+                                });
+  if (iter == recent_.end()) {
+    iter = std::prev(recent_.end());
+    displays_[*iter].reset(mode_);
+  }
+  std::rotate(recent_.begin(), iter, std::next(iter));
+  background_start();
 }
 
 static std::string format_integral(lib::tbase base, std::string_view debug,
@@ -171,49 +724,138 @@ static std::string format_integral(lib::tbase base, std::string_view debug,
   std::unreachable();
 }
 
-static std::string format_integral_grouped(lib::tbase base,
-                                           std::string_view debug, auto value) {
-  // The hard-code grouping used in the bases.
-  // Note this might becom more generic in the future.
-  struct grouping_3 : std::numpunct<char> {
-    explicit grouping_3(char separator) : separator_(separator) {}
+static constexpr std::size_t digit_table_size(std::size_t base,
+                                              std::size_t width) {
+  std::size_t result = 1;
+  for (std::size_t i = 0; i < width; ++i)
+    result *= base;
+  return result;
+}
 
-    std::string do_grouping() const override { return "\3"; }
-    char do_thousands_sep() const override { return separator_; }
+/**
+ * The digits of every value in [0, Base^Width), zero padded to Width digits.
+ *
+ * Converting Width digits at once reduces the number of divisions.
+ */
+template <unsigned Base, std::size_t Width>
+static constexpr std::array digit_table =
+    lib::make_table<digit_table_size(Base, Width)>([](std::size_t value) {
+      std::array<char, Width> result;
+      for (std::size_t i = Width; i-- > 0; value /= Base)
+        result[i] = "0123456789abcdef"[value % Base];
+      return result;
+    });
 
-    char separator_;
-  };
+/** Writes a string from back to front, separating the groups of digits. */
+class tgrouped_writer final {
+public:
+  tgrouped_writer(char *last, std::size_t group, char separator) noexcept
+      : first_(last), group_(group), separator_(separator) {}
+
+  void digit(char digit) noexcept {
+    if (count_ == group_) {
+      *--first_ = separator_;
+      count_ = 0;
+    }
+    *--first_ = digit;
+    ++count_;
+  }
+
+  void prefix(std::string_view prefix) noexcept {
+    first_ -= prefix.size();
+    std::ranges::copy(prefix, first_);
+  }
+
+  [[nodiscard]] const char *first() const noexcept { return first_; }
+
+private:
+  char *first_;
+  std::size_t group_;
+  char separator_;
+  std::size_t count_{0};
+};
+
+template <unsigned Base, std::size_t Width>
+static void write_digits(tgrouped_writer &writer, std::uint64_t value) {
+  constexpr const auto &table = digit_table<Base, Width>;
+  constexpr std::uint64_t radix = table.size();
+  for (; value >= radix; value /= radix)
+    for (std::size_t i = Width; i-- > 0;)
+      writer.digit(table[value % radix][i]);
+
+  // The leading digits are written without their zero padding.
+  const std::array<char, Width> &digits = table[value];
+  std::size_t first = 0;
+  while (first + 1 < Width && digits[first] == '0')
+    ++first;
+  for (std::size_t i = Width; i-- > first;)
+    writer.digit(digits[i]);
+}
+
+/**
+ * Formats an integral with grouping separators.
+ *
+ * The decimal and octal digits are grouped by three, using the separator of
+ * the locale. The binary and hexadecimal digits are grouped by four, using an
+ * apostrophe. The result is the same as formatting with @c std::format and a
+ * locale with these @c std::numpunct facets, but without their overhead.
+ */
+static std::string format_integral_grouped(lib::tbase base,
+                                           std::string_view debug, auto value) {
   // Use separator of the locale
-  static std::locale locale_3{
-      std::locale(),
-      new grouping_3(
-          std::use_facet<std::numpunct<char>>(std::locale()).thousands_sep())};
-
-  struct grouping_4 : std::numpunct<char> {
-    std::string do_grouping() const override { return "\4"; }
-    char do_thousands_sep() const override { return '\''; }
-  };
+  static const char separator =
+      std::use_facet<std::numpunct<char>>(std::locale()).thousands_sep();
+
+  bool negative = false;
+  auto magnitude = static_cast<std::uint64_t>(value);
+  if constexpr (std::signed_integral<decltype(value)>)
+    if (value < 0) {
+      negative = true;
+      magnitude = std::uint64_t(0) - magnitude;
+    }
 
-  static std::locale locale_4{std::locale(), new grouping_4()};
+  // Fits 64 binary digits, 15 separators, the sign, and the prefix.
+  std::array<char, 96> buffer;
+  char *last = buffer.data() + buffer.size();
+  const bool nibbles =
+      base == lib::tbase::binary || base == lib::tbase::hexadecimal;
+  tgrouped_writer writer{last, nibbles ? 4u : 3u,
+                         nibbles ? '\'' : separator};
 
   switch (base) {
   case lib::tbase::binary:
-    return std::format(locale_4, "{:#Lb}{}", value, debug);
+    write_digits<2, 8>(writer, magnitude);
+    writer.prefix("0b");
+    break;
   case lib::tbase::octal:
-    return std::format(locale_3, "{:#Lo}{}", value, debug);
+    write_digits<8, 2>(writer, magnitude);
+    if (magnitude != 0)
+      writer.prefix("0");
+    break;
   case lib::tbase::decimal:
-    return std::format(locale_3, "{:L}{}", value, debug);
+    write_digits<10, 2>(writer, magnitude);
+    break;
   case lib::tbase::hexadecimal:
-    return std::format(locale_4, "{:#Lx}{}", value, debug);
+    write_digits<16, 2>(writer, magnitude);
+    writer.prefix("0x");
+    break;
   }
-  std::unreachable();
+  if (negative)
+    writer.prefix("-");
+
+  const std::size_t size = static_cast<std::size_t>(last - writer.first());
+  std::string result;
+  result.reserve(size + debug.size());
+  result.append(writer.first(), size);
+  result += debug;
+  return result;
 }
 
 /** The integral types used in the value class. */
 template <class T>
   requires std::same_as<T, std::int64_t> || std::same_as<T, std::uint64_t>
-static std::string format(lib::tbase base, bool grouping, bool debug_mode,
-                          T value) {
+static std::string format(lib::tbase base, bool grouping, tnotation,
+                          bool debug_mode, T value) {
   std::string_view debug = [&] {
     if (!debug_mode)
       return "";
@@ -229,27 +871,177 @@ static std::string format(lib::tbase base, bool grouping, bool debug_mode,
   return format_integral(base, debug, value);
 }
 
-static std::string format(lib::tbase, bool, bool debug_mode, double value) {
-  char buf[128];
+/**
+ * Formats a @c double in the requested @p notation.
+ *
+ * The conversion uses @c std::to_chars, which is independent of the locale.
+ * The shortest notation converts back to the same value.
+ */
+static std::string format(lib::tbase, bool, tnotation notation, bool debug_mode,
+                          double value) {
+  // Fits the sign, the digits of the largest value, the decimal point, and
+  // the precision of the fixed notation.
+  std::array<char, 1 + std::numeric_limits<double>::max_exponent10 + 1 + 1 +
+                       tnotation::precision_max>
+      buffer;
+  char *first = buffer.data();
+  char *last = buffer.data() + buffer.size();
+  const std::to_chars_result result = [&] {
+    switch (notation.style) {
+    case tnotation::tstyle::shortest:
+      break;
+    case tnotation::tstyle::fixed:
+      return std::to_chars(first, last, value, std::chars_format::fixed,
+                           notation.precision);
+    case tnotation::tstyle::scientific:
+      return std::to_chars(first, last, value, std::chars_format::scientific,
+                           notation.precision);
+    }
+    return std::to_chars(first, last, value);
+  }();
+
+  std::string_view debug = debug_mode ? " |d" : "";
+  const std::size_t size = static_cast<std::size_t>(result.ptr - first);
+  std::string string;
+  string.reserve(size + debug.size());
+  string.append(first, size);
+  string += debug;
+  return string;
+}
+
+/** The rational is shown in its lowest terms, the integral parts in @p base. */
+static std::string format(lib::tbase base, bool grouping, tnotation notation,
+                          bool debug_mode, math::trational value) {
+  value = math::reduce(value);
+  std::string result = format(base, grouping, notation, false, value.numerator);
+  if (value.denominator != 1) {
+    result += '/';
+    result += format(base, grouping, notation, false, value.denominator);
+  }
   if (debug_mode)
-    std::sprintf(buf, "%g |d", value);
-  else
-    std::sprintf(buf, "%g", value);
-  return std::string{buf};
+    result += " |r";
+  return result;
+}
+
+/** The number of leading and trailing items shown of a long sequence. */
+static constexpr std::size_t head = 3;
+static constexpr std::size_t tail = 2;
+
+/**
+ * Formats @p size items enclosed in brackets.
+ *
+ * A long sequence only shows its first and last items.
+ */
+static std::string format_items(std::size_t size, auto format_item) {
+  std::string result{'['};
+  auto append = [&](std::size_t index) {
+    if (index != 0)
+      result += ", ";
+    result += format_item(index);
+  };
+
+  if (size <= head + tail) {
+    for (std::size_t i = 0; i < size; ++i)
+      append(i);
+  } else {
+    for (std::size_t i = 0; i < head; ++i)
+      append(i);
+    result += ", ...";
+    for (std::size_t i = size - tail; i < size; ++i)
+      append(i);
+  }
+  result += ']';
+  return result;
+}
+
+/**
+ * A long vector only shows its first and last elements, the debug tag shows
+ * the type of the elements.
+ *
+ * A lazy vector only calculates the shown elements, they are not stored.
+ */
+static std::string format(lib::tbase base, bool grouping, tnotation notation,
+                          bool debug_mode, const math::tvector &value) {
+  auto format_elements = [&](std::size_t size, auto element) {
+    using T = decltype(element(std::size_t(0)));
+    std::string result = format_items(size, [&](std::size_t i) {
+      return format(base, grouping, notation, false, element(i));
+    });
+
+    if (debug_mode) {
+      if constexpr (std::same_as<T, std::int64_t>)
+        result += " |vi";
+      else if constexpr (std::same_as<T, std::uint64_t>)
+        result += " |vu";
+      else
+        result += " |vd";
+    }
+    return result;
+  };
+
+  if (value.holds_sequence())
+    return value.visit_sequence([&](const auto &sequence) {
+      return format_elements(sequence.size(),
+                             [&](std::size_t i) { return sequence[i]; });
+    });
+
+  if (value.stored())
+    return value.visit([&](auto elements) {
+      return format_elements(elements.size(),
+                             [&](std::size_t i) { return elements[i]; });
+    });
+
+  // The shown elements of a deferred vector, the leading elements followed
+  // by the trailing elements.
+  const std::size_t size = value.size();
+  std::array<double, head + tail> shown;
+  const std::size_t leading = std::min(size, head);
+  const std::size_t trailing = std::min(size - leading, tail);
+  value.evaluate(0, leading, shown.data());
+  value.evaluate(size - trailing, trailing, shown.data() + leading);
+  return format_elements(size, [&](std::size_t i) {
+    return i < leading ? shown[i] : shown[leading + i - (size - trailing)];
+  });
+}
+
+/**
+ * A matrix is shown as a list of rows, like a vector only the first and last
+ * rows and columns of a large matrix are shown.
+ */
+static std::string format(lib::tbase base, bool grouping, tnotation notation,
+                          bool debug_mode, const math::tmatrix &value) {
+  return value.visit([&]<class T>(std::span<const T> elements) {
+    const std::size_t columns = value.columns();
+    std::string result = format_items(value.rows(), [&](std::size_t row) {
+      return format_items(columns, [&](std::size_t column) {
+        return format(base, grouping, notation, false,
+                      elements[row * columns + column]);
+      });
+    });
+
+    if (debug_mode) {
+      if constexpr (std::same_as<T, std::int64_t>)
+        result += " |mi";
+      else
+        result += " |md";
+    }
+    return result;
+  });
 }
 
 /** Catches changes of @ref tstorage. */
 template <class T> static std::uint64_t format(lib::tbase, bool, T) = delete;
 
-static std::string format(lib::tbase base, bool grouping, bool debug_mode,
-                          const tvalue &value) {
-  return value.visit([base, debug_mode, grouping](auto v) {
-    return format(base, grouping, debug_mode, v);
+static std::string format(lib::tbase base, bool grouping, tnotation notation,
+                          bool debug_mode, const tvalue &value) {
+  return value.visit([base, debug_mode, grouping, notation](auto v) {
+    return format(base, grouping, notation, debug_mode, v);
   });
 }
 
-[[nodiscard]] std::string tstack::format(const tvalue &value) const {
-  return calculator::format(base_, grouping_, debug_mode_, value);
+static std::string format(const tdisplay_mode &mode, const tvalue &value) {
+  return format(mode.base, mode.grouping, mode.notation, mode.debug_mode,
+                value);
 }
 
 } // namespace calculator
@@ -76,6 +76,60 @@ private:
   tvalue value_;
 };
 
+class tpop_range final : public tstep_ {
+public:
+  /** Handles the popping of @p values from the model's stack. */
+  explicit tpop_range(std::vector<tvalue> values)
+      : values_(std::move(values)) {}
+
+  void undo(tmodel &model) override {
+    std::ranges::for_each(
+        values_, [&model](tvalue &value) { model.stack().push(value); });
+  }
+  void redo(tmodel &model) override { model.stack().drop(values_.size()); }
+
+private:
+  std::vector<tvalue> values_;
+};
+
+class tpush_range final : public tstep_ {
+public:
+  /** Handles the pushing of @p values on the model's stack. */
+  explicit tpush_range(std::vector<tvalue> values)
+      : values_(std::move(values)) {}
+
+  void undo(tmodel &model) override { model.stack().drop(values_.size()); }
+  void redo(tmodel &model) override {
+    std::ranges::for_each(
+        values_, [&model](tvalue &value) { model.stack().push(value); });
+  }
+
+private:
+  std::vector<tvalue> values_;
+};
+
+class tpermute final : public tstep_ {
+public:
+  /**
+   * Handles the reordering of the model's stack.
+   *
+   * Only the permutation is stored, not the values.
+   */
+  explicit tpermute(std::vector<std::size_t> permutation)
+      : permutation_(std::move(permutation)) {}
+
+  void undo(tmodel &model) override {
+    std::vector<std::size_t> inverse(permutation_.size());
+    for (std::size_t i = 0; i < permutation_.size(); ++i)
+      inverse[permutation_[i]] = i;
+    model.stack().permute(inverse);
+  }
+  void redo(tmodel &model) override { model.stack().permute(permutation_); }
+
+private:
+  std::vector<std::size_t> permutation_;
+};
+
 class tduplicate final : public tstep_ {
 public:
   /** Handles the duplicating model's stack last entry. */
@@ -91,6 +145,20 @@ public:
   void redo(tmodel &model) override { model.debug_mode_toggle(); }
 };
 
+class tnotation_set final : public tstep_ {
+public:
+  /** Handles the changing of the notation. */
+  tnotation_set(tnotation old, tnotation notation)
+      : old_(old), notation_(notation) {}
+
+  void undo(tmodel &model) override { model.notation_set(old_); }
+  void redo(tmodel &model) override { model.notation_set(notation_); }
+
+private:
+  tnotation old_;
+  tnotation notation_;
+};
+
 /**
  * The action class to undo and redo actions.
  *
@@ -182,6 +250,11 @@ public:
       undo();
   }
 
+  /** @returns The values on the model's stack. */
+  [[nodiscard]] std::span<const tvalue> values() const noexcept {
+    return model_.stack().values();
+  }
+
   /** Handles the stealing of @p input from the model's input. */
   void input_reset() {
     std::string result = model_.input_get();
@@ -196,12 +269,13 @@ public:
    * offset 0, the second at offset 1, etc.
    */
   template <std::size_t N = 1>
-    requires(N >= 1 && N <= 2)
+    requires(N >= 1 && N <= 3)
   [[nodiscard]] auto pop() {
     if (model_.stack().size() < N) {
       static constexpr std::array messages{
           "The stack doesn't contain an element",
-          "The stack doesn't contain two elements"};
+          "The stack doesn't contain two elements",
+          "The stack doesn't contain three elements"};
       static_assert(N <= messages.size());
       throw std::out_of_range(messages[N - 1]);
     }
@@ -216,18 +290,78 @@ public:
     }(std::make_index_sequence<N>{});
   }
 
+  /**
+   * Handles the popping of @p count values from the model's stack.
+   *
+   * Unlike @ref pop<N> the values are returned in stack order, the last
+   * popped element is at offset 0. The values are recorded in one step.
+   */
+  [[nodiscard]] std::vector<tvalue> pop(std::size_t count) {
+    if (model_.stack().size() < count)
+      throw std::out_of_range("The stack doesn't contain enough elements");
+
+    const std::span<const tvalue> values = model_.stack().values().last(count);
+    std::vector<tvalue> result{values.begin(), values.end()};
+    model_.stack().drop(count);
+
+    steps_.push_back(std::make_unique<tpop_range>(result));
+    return result;
+  }
+
+  /** Handles the popping of all values from the model's stack. */
+  [[nodiscard]] std::vector<tvalue> pop_all() {
+    return pop(model_.stack().size());
+  }
+
   /** Handles the dropping of @p value from the model's stack. */
   void drop() {
     tvalue result = model_.stack().pop();
     steps_.push_back(std::make_unique<tpop>(result));
   }
 
+  /**
+   * Handles the dropping of @p count values from the model's stack.
+   *
+   * Like @ref pop(std::size_t), but the values aren't returned. This avoids
+   * a copy when the caller already used the @ref values.
+   */
+  void drop(std::size_t count) {
+    if (model_.stack().size() < count)
+      throw std::out_of_range("The stack doesn't contain enough elements");
+
+    const std::span<const tvalue> values = model_.stack().values().last(count);
+    steps_.push_back(std::make_unique<tpop_range>(
+        std::vector<tvalue>{values.begin(), values.end()}));
+    model_.stack().drop(count);
+  }
+
   /** Handles the pushing of @p value from the model's stack. */
   void push(tvalue value) {
     model_.stack().push(value);
     steps_.push_back(std::make_unique<tpush>(value));
   }
 
+  /**
+   * Handles the pushing of @p values on the model's stack.
+   *
+   * The values are pushed in order and recorded in one step.
+   */
+  void push(std::vector<tvalue> values) {
+    std::ranges::for_each(
+        values, [this](tvalue &value) { model_.stack().push(value); });
+    steps_.push_back(std::make_unique<tpush_range>(std::move(values)));
+  }
+
+  /**
+   * Handles the reordering of the model's stack.
+   *
+   * @see tstack::permute for the meaning of @p permutation.
+   */
+  void permute(std::vector<std::size_t> permutation) {
+    model_.stack().permute(permutation);
+    steps_.push_back(std::make_unique<tpermute>(std::move(permutation)));
+  }
+
   /** Handles the duplicating model's stack last entry. */
   void duplicate() {
     model_.stack().duplicate();
@@ -239,6 +373,12 @@ public:
     steps_.push_back(std::make_unique<tdebug_mode_toggle>());
   }
 
+  void notation_set(tnotation notation) {
+    const tnotation old = model_.notation();
+    model_.notation_set(notation);
+    steps_.push_back(std::make_unique<tnotation_set>(old, notation));
+  }
+
   /**
    * Finalises the transaction as succesful.
    *
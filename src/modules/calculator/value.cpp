@@ -37,8 +37,18 @@ public:
   explicit constexpr tvalue(std::int64_t value) noexcept : value_(value) {}
   explicit constexpr tvalue(std::uint64_t value) noexcept : value_(value) {}
   explicit constexpr tvalue(double value) noexcept : value_(value) {}
+  explicit constexpr tvalue(math::trational value) noexcept : value_(value) {}
+  explicit tvalue(math::tvector value) noexcept : value_(std::move(value)) {}
+  explicit tvalue(math::tmatrix value) noexcept : value_(std::move(value)) {}
 
   constexpr tvalue(math::tstorage value) noexcept : value_(value) {}
+
+  // The copy of a vector only shares its elements, so copying can't throw.
+  // The copy constructor of the variant doesn't know that.
+  constexpr tvalue(const tvalue &) noexcept = default;
+  constexpr tvalue(tvalue &&) noexcept = default;
+  constexpr tvalue &operator=(const tvalue &) noexcept = default;
+  constexpr tvalue &operator=(tvalue &&) noexcept = default;
   constexpr operator math::tstorage() const { return value_; }
 
   /**
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module lib.parallel;
+
+import std;
+
+namespace lib {
+/**
+ * The minimal number of elements processed by one thread.
+ *
+ * Below this size starting a thread costs more than it gains.
+ */
+export inline constexpr std::size_t parallel_grain_size = 1 << 18;
+
+/**
+ * Reduces the range [0, @p size) in parallel.
+ *
+ * The range is split in consecutive chunks, for every chunk
+ * @c map(first, last) is called. The results are combined in order with
+ * @c combine(lhs, rhs). So @p combine needs to be associative, but not
+ * commutative.
+ *
+ * The number of threads depends on the hardware concurrency and
+ * @p grain_size. For small ranges @p map is called once on the current
+ * thread.
+ *
+ * When @p map throws, the exception is rethrown after all threads finished.
+ */
+export template <class Map, class Combine>
+  requires std::invocable<Map &, std::size_t, std::size_t>
+auto parallel_reduce(std::size_t size, Map map, Combine combine,
+                     std::size_t grain_size = parallel_grain_size) {
+  using R = std::invoke_result_t<Map &, std::size_t, std::size_t>;
+
+  const std::size_t threads =
+      std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                            size / std::max<std::size_t>(1, grain_size));
+  if (threads <= 1)
+    return std::invoke(map, 0, size);
+
+  auto first = [&](std::size_t thread) { return size * thread / threads; };
+
+  std::vector<std::optional<R>> results(threads);
+  std::vector<std::exception_ptr> exceptions(threads);
+  auto execute = [&](std::size_t thread) {
+    try {
+      results[thread] = std::invoke(map, first(thread), first(thread + 1));
+    } catch (...) {
+      exceptions[thread] = std::current_exception();
+    }
+  };
+
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(threads - 1);
+    for (std::size_t thread = 1; thread < threads; ++thread)
+      workers.emplace_back(execute, thread);
+
+    execute(0);
+  }
+
+  for (const std::exception_ptr &exception : exceptions)
+    if (exception)
+      std::rethrow_exception(exception);
+
+  R result = std::move(*results[0]);
+  for (std::size_t thread = 1; thread < threads; ++thread)
+    result =
+        std::invoke(combine, std::move(result), std::move(*results[thread]));
+
+  return result;
+}
+
+/**
+ * Calls @c function(first, last) for consecutive chunks of [0, @p size) in
+ * parallel.
+ *
+ * Like @ref parallel_reduce, but for a @p function that stores its results
+ * itself. Chunks never overlap, so the @p function may write to the elements
+ * of its chunk without synchronization.
+ */
+export template <class Function>
+  requires std::invocable<Function &, std::size_t, std::size_t>
+void parallel_for(std::size_t size, Function function,
+                  std::size_t grain_size = parallel_grain_size) {
+  parallel_reduce(
+      size,
+      [&function](std::size_t first, std::size_t last) {
+        std::invoke(function, first, last);
+        return std::monostate{};
+      },
+      [](std::monostate, std::monostate) { return std::monostate{}; },
+      grain_size);
+}
+
+/**
+ * A pool of threads calling a function for consecutive chunks of a range.
+ *
+ * Unlike @ref parallel_for the threads are started once, between ranges they
+ * wait for the next range. This suits processing many small ranges, where
+ * starting and joining threads per range would cost a large part of the work.
+ */
+export class tworker_pool final {
+public:
+  /** Starts @p threads workers, the calling thread processes chunks too. */
+  explicit tworker_pool(
+      std::size_t threads = std::max(1u, std::thread::hardware_concurrency()) -
+                            1) {
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+      workers_.emplace_back(
+          [this](std::stop_token stop_token) { work(stop_token); });
+  }
+
+  tworker_pool(const tworker_pool &) = delete;
+  tworker_pool &operator=(const tworker_pool &) = delete;
+
+  /**
+   * Calls @c function(first, last) for consecutive chunks of [0, @p size).
+   *
+   * The chunks have @p grain_size elements, except the last chunk. They are
+   * processed by the workers and the calling thread, this returns when all
+   * chunks are processed. Like @ref parallel_for the @p function may write to
+   * the elements of its chunk without synchronization.
+   *
+   * When @p function throws, no new chunks are started and the exception is
+   * rethrown after the running chunks finished.
+   *
+   * @pre No other thread calls this function of the same pool.
+   */
+  template <class Function>
+    requires std::invocable<Function &, std::size_t, std::size_t>
+  void parallel_for(std::size_t size, Function function,
+                    std::size_t grain_size = parallel_grain_size) {
+    std::unique_lock lock{mutex_};
+    function_ = &function;
+    invoke_ = [](void *function, std::size_t first, std::size_t last) {
+      std::invoke(*static_cast<Function *>(function), first, last);
+    };
+    size_ = size;
+    grain_size_ = std::max<std::size_t>(1, grain_size);
+    next_ = 0;
+    work_.notify_all();
+
+    while (execute(lock))
+      ;
+    finished_.wait(lock, [this] { return running_ == 0; });
+    if (exception_)
+      std::rethrow_exception(std::exchange(exception_, nullptr));
+  }
+
+private:
+  /**
+   * Processes the next chunk of the current range.
+   *
+   * @pre @p lock holds @ref mutex_.
+   *
+   * @returns Whether a chunk was processed.
+   */
+  bool execute(std::unique_lock<std::mutex> &lock) {
+    if (next_ == size_)
+      return false;
+
+    const std::size_t first = next_;
+    const std::size_t last = first + std::min(grain_size_, size_ - first);
+    next_ = last;
+    ++running_;
+    void (*invoke)(void *, std::size_t, std::size_t) = invoke_;
+    void *function = function_;
+    lock.unlock();
+
+    std::exception_ptr exception;
+    try {
+      invoke(function, first, last);
+    } catch (...) {
+      exception = std::current_exception();
+    }
+
+    lock.lock();
+    if (exception) {
+      if (!exception_)
+        exception_ = exception;
+      next_ = size_;
+    }
+    if (--running_ == 0 && next_ == size_)
+      finished_.notify_one();
+    return true;
+  }
+
+  void work(std::stop_token stop_token) {
+    std::unique_lock lock{mutex_};
+    while (work_.wait(lock, stop_token, [this] { return next_ != size_; }))
+      execute(lock);
+  }
+
+  /** Guards the members below. */
+  std::mutex mutex_;
+  std::condition_variable_any work_;
+  std::condition_variable finished_;
+  /** The function of the current range, type-erased by @ref invoke_. */
+  void *function_{nullptr};
+  void (*invoke_)(void *, std::size_t, std::size_t){nullptr};
+  std::size_t size_{0};
+  std::size_t grain_size_{1};
+  /** The first element of the next chunk, @ref size_ when all are taken. */
+  std::size_t next_{0};
+  /** The number of chunks being processed. */
+  std::size_t running_{0};
+  std::exception_ptr exception_{};
+
+  /** Declared last, so the workers stop before the other members die. */
+  std::vector<std::jthread> workers_;
+};
+} // namespace lib
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+export module lib.table;
+
+import std;
+
+namespace lib {
+/**
+ * Creates a lookup table.
+ *
+ * A lookup table is an array where the element at index @c I contains the
+ * value @c generator(I).
+ *
+ * Like @ref make_dictionary the table is created at compile time. This allows
+ * to replace run-time calculations with a simple array access.
+ *
+ * @pre @p generator can be evaluated at compile time.
+ * @pre @p generator returns the same type for every index.
+ */
+export template <std::size_t N, class Generator>
+  requires(N != 0 && std::invocable<Generator, std::size_t>)
+consteval auto make_table(Generator generator) {
+  return [&generator]<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array{std::invoke(generator, I)...};
+  }(std::make_index_sequence<N>());
+}
+} // namespace lib
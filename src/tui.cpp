@@ -17,6 +17,7 @@ module;
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/terminal.hpp>
 
 export module tui;
 
@@ -25,6 +26,9 @@ import std;
 
 namespace {
 
+/** @returns The height of @p box. */
+int height(const ftxui::Box &box) { return box.y_max - box.y_min + 1; }
+
 // When not in an anonymous namespace the twindow classes in tui and gui give
 // issues. This seems like a bug in Clang.
 class tinput final : public ftxui::ComponentBase {
@@ -39,15 +43,29 @@ public:
            | ftxui::size(ftxui::HEIGHT, ftxui::EQUAL, 1)                   //
            | ftxui::border;
   }
+
+  /** @returns The number of rows the stack is scrolled up. */
+  std::size_t scroll() const { return scroll_; }
+
+  /** Sets the number of rows the stack shows, this limits the scrolling. */
+  void stack_rows_set(std::size_t rows) { stack_rows_ = rows; }
+
   bool OnEvent(ftxui::Event event) override {
-    if (event == ftxui::Event::Backspace) {
+    if (event == ftxui::Event::ArrowUp) {
+      const std::size_t size = model_.stack().size();
+      scroll_ = std::min(scroll_ + 1, size - std::min(stack_rows_, size));
+    } else if (event == ftxui::Event::ArrowDown) {
+      scroll_ -= scroll_ != 0;
+    } else if (event == ftxui::Event::Backspace) {
       controller_.handle_keyboard_input(calculator::tkey::backspace);
       control_ = false;
+      scroll_ = 0;
     } else if (event == ftxui::Event::Tab) {
       control_ = true;
     } else if (event == ftxui::Event::Return) {
       controller_.handle_keyboard_input(calculator::tkey::enter);
       control_ = false;
+      scroll_ = 0;
     } else if (event.is_character()) {
 
       const std::string text = event.character();
@@ -72,6 +90,7 @@ public:
         break;
       }
       control_ = false;
+      scroll_ = 0;
     }
 
     // Swallow all events
@@ -84,13 +103,19 @@ private:
   // The special keys using control don't work properly in the terminal. Using
   // alt is iffy too. Instead we set control pressed after a tab key.
   bool control_{false};
+  // The number of rows the stack is scrolled up. Input shows the top of the
+  // stack again.
+  std::size_t scroll_{0};
+  std::size_t stack_rows_{0};
   calculator::tmodel &model_;
   calculator::tcontroller controller_;
 };
 
 class twindow {
 public:
-  twindow() : input_{std::make_shared<tinput>(model_)} {}
+  twindow() : input_{std::make_shared<tinput>(model_)} {
+    model_.stack().background_formatting_set(true);
+  }
 
   ftxui::Component screen() {
     return ftxui::Container::Vertical({
@@ -98,7 +123,8 @@ public:
                                [&] {
                                  return ftxui::vbox({diagnostics(), //
                                                      stack(),       //
-                                                     input_->Render()});
+                                                     input_->Render()}) |
+                                        ftxui::reflect(screen_box_);
                                }),
            }) |
            ftxui::size(ftxui::WIDTH, ftxui::EQUAL, 61);
@@ -110,22 +136,60 @@ private:
            | ftxui::size(ftxui::HEIGHT, ftxui::EQUAL, 1) //
            | ftxui::border;
   }
+
+  /**
+   * @returns The number of stack rows fitting in the terminal.
+   *
+   * The rows of the terminal not used by the stack's rows are taken from the
+   * layout of the previous frame. So the other elements, and the border of
+   * the stack, may change their height.
+   */
+  std::size_t stack_rows() const {
+    const int other = height(screen_box_) - height(stack_box_);
+    return static_cast<std::size_t>(
+        std::max(ftxui::Terminal::Size().dimy - other, 4));
+  }
+
+  /**
+   * Renders the visible part of the stack.
+   *
+   * Only the shown values are formatted and turned into elements, so the
+   * time to render doesn't depend on the size of the stack.
+   */
   ftxui::Element stack() const {
-    ftxui::Elements stack;
-    for (auto value : model_.stack().strings())
-      stack.emplace_back(
-          ftxui::hbox({ftxui::filler(), ftxui::text(std::move(value))}));
-
-    return ftxui::vbox(stack)                                   //
-           | ftxui::vscroll_indicator                           //
-           | ftxui::focusPositionRelative(0.0, 1.0)             //
-           | ftxui::yframe                                      //
-           | ftxui::size(ftxui::HEIGHT, ftxui::GREATER_THAN, 4) //
-           | ftxui::border;
+    const calculator::tstack &stack = model_.stack();
+    const std::size_t rows = std::min(stack_rows(), stack.size());
+    const std::size_t last =
+        stack.size() - std::min(input_->scroll(), stack.size() - rows);
+    input_->stack_rows_set(rows);
+
+    ftxui::Elements elements;
+    elements.reserve(rows);
+    for (std::string_view value : stack.strings(last - rows, last))
+      elements.emplace_back(
+          ftxui::hbox({ftxui::filler(), ftxui::text(std::string{value})}));
+
+    // Before the layout is known the frame clips the rows at the top.
+    ftxui::Element result =
+        ftxui::vbox(std::move(elements))         //
+        | ftxui::focusPositionRelative(0.0, 1.0) //
+        | ftxui::yframe                          //
+        | ftxui::reflect(stack_box_)             //
+        | ftxui::size(ftxui::HEIGHT, ftxui::GREATER_THAN, 4);
+    if (rows == stack.size())
+      return result | ftxui::border;
+
+    // Shows the position of the rows, like a scroll indicator.
+    return ftxui::window(ftxui::text(std::format("{}-{}/{}", last - rows + 1,
+                                                 last, stack.size())),
+                         result);
   }
 
   calculator::tmodel model_;
-  ftxui::Component input_;
+  std::shared_ptr<tinput> input_;
+  // The boxes of the previous frame, used to calculate the stack_rows.
+  mutable ftxui::Box screen_box_{};
+  mutable ftxui::Box stack_box_{};
 };
 
 } // namespace
@@ -70,15 +70,15 @@ TEST(controller, constant_unsigned_integral) {
 }
 
 TEST(controller, constant_floating_point) {
-  validate("float_min", "1.17549e-38");
-  validate("double_min", "2.22507e-308");
+  validate("float_min", "1.1754943508222875e-38");
+  validate("double_min", "2.2250738585072014e-308");
 
-  validate("float_max", "3.40282e+38");
-  validate("double_max", "1.79769e+308");
+  validate("float_max", "3.4028234663852886e+38");
+  validate("double_max", "1.7976931348623157e+308");
 }
 
 TEST(controller, constant_special) {
-  validate("e", "2.71828");
-  validate("pi", "3.14159");
+  validate("e", "2.718281828459045");
+  validate("pi", "3.141592653589793");
 }
 } // namespace calculator
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+// TODO import std; fails.
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+static void test_unary(std::string_view input, std::string_view output) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, input);
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            std::vector<std::string>{std::string{output}});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, bitwise_too_few_elements) {
+  for (std::string_view input : {"popcount", "clz", "ctz", "bswap", "bitrev"}) {
+    tmodel model;
+    tcontroller controller{model};
+
+    handle_input(controller, model, input);
+    EXPECT_EQ(model.diagnostics_get(),
+              format_error("The stack doesn't contain an element"));
+    EXPECT_TRUE(model.stack().empty());
+    EXPECT_EQ(model.input_get(), input);
+  }
+
+  for (std::string_view input : {"pdep", "pext", "rotl", "rotr"}) {
+    tmodel model;
+    tcontroller controller{model};
+
+    handle_input(controller, model, "42");
+    handle_input(controller, model, input);
+    EXPECT_EQ(model.diagnostics_get(),
+              format_error("The stack doesn't contain two elements"));
+    EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"42"});
+    EXPECT_EQ(model.input_get(), input);
+  }
+}
+
+TEST(controller, popcount) { test_unary("0b1011 popcount", "3"); }
+
+TEST(controller, clz) { test_unary("0x10 clz", "59"); }
+
+TEST(controller, ctz) { test_unary("0x10 ctz", "4"); }
+
+TEST(controller, bswap) { test_unary("0x0100000000000000 bswap", "1"); }
+
+TEST(controller, bitrev) { test_unary("0x8000000000000000 bitrev", "1"); }
+
+TEST(controller, pdep) { test_unary("0b11 0b1010 pdep", "10"); }
+
+TEST(controller, pext) { test_unary("0b1000 0b1010 pext", "2"); }
+
+TEST(controller, rotl) { test_unary("0x8000000000000000 1 rotl", "1"); }
+
+TEST(controller, rotr) { test_unary("0x0100000000000000 56 rotr", "1"); }
+
+TEST(controller, rotl_invalid_rotation) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 65 rotl");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Rotation too large"));
+  EXPECT_TRUE(model.stack().empty());
+  EXPECT_EQ(model.input_get(), "1 65 rotl");
+}
+
+} // namespace calculator
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+/*** *** FACT *** ***/
+
+TEST(controller, fact_too_few_elements) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "fact");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain an element"));
+  EXPECT_TRUE(model.stack().empty());
+  EXPECT_EQ(model.input_get(), "fact");
+}
+
+TEST(controller, fact_stack) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "5");
+  handle_input(controller, model, "fact");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"120"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, fact_input) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "5 fact");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"120"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, fact_invalid_value) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "i-5 fact");
+
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a non-negative value"));
+  EXPECT_TRUE(model.stack().empty());
+  EXPECT_EQ(model.input_get(), "i-5 fact");
+}
+
+/*** *** CHOOSE *** ***/
+
+TEST(controller, choose_too_few_elements) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "42");
+  handle_input(controller, model, "choose");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain two elements"));
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"42"});
+  EXPECT_EQ(model.input_get(), "choose");
+}
+
+TEST(controller, choose_stack) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "10");
+  handle_input(controller, model, "3");
+  handle_input(controller, model, "choose");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"120"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, choose_input) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "10 3 choose");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"120"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+} // namespace calculator
@@ -50,6 +50,25 @@ TEST(controller, debug_basic) {
   EXPECT_TRUE(model.input_get().empty());
 }
 
+TEST(controller, debug_rational) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1");
+  model.input_append("3");
+  controller.handle_keyboard_input(tmodifiers::none, '/');
+  handle_input(controller, model, "6");
+  model.input_append("3");
+  controller.handle_keyboard_input(tmodifiers::none, '/');
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1/3"}, {"2"}}));
+
+  handle_input(controller, model, "debug");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1/3 |r"}, {"2 |u"}}));
+}
+
 TEST(controller, debug_base_2) {
   tmodel model;
   model.base_set(lib::tbase::binary);
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, fft) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 1 1 1 4 pack");
+  handle_input(controller, model, "fft");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[4, 0], [0, 0], [0, 0], [0, 0]]"}}));
+
+  handle_input(controller, model, "ifft");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[1, 0], [1, 0], [1, 0], [1, 0]]"}}));
+
+  handle_input(controller, model, "1 ifft");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a vector"));
+}
+
+TEST(controller, conv) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 3 pack 1 1 2 pack");
+  handle_input(controller, model, "conv");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 3, 5, 3]"}}));
+}
+
+} // namespace calculator
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, fma_too_few_elements) {
+  {
+    tmodel model;
+    tcontroller controller{model};
+
+    handle_input(controller, model, "fma");
+    EXPECT_EQ(model.diagnostics_get(),
+              format_error("The stack doesn't contain three elements"));
+    EXPECT_TRUE(model.stack().empty());
+    EXPECT_EQ(model.input_get(), "fma");
+  }
+  {
+    tmodel model;
+    tcontroller controller{model};
+
+    handle_input(controller, model, "1 2");
+    handle_input(controller, model, "fma");
+    EXPECT_EQ(model.diagnostics_get(),
+              format_error("The stack doesn't contain three elements"));
+    EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(model.input_get(), "fma");
+  }
+}
+
+TEST(controller, fma_stack) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "2 3 4");
+  handle_input(controller, model, "fma");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"10"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, fma_input) {
+  tmodel model;
+  tcontroller controller{model};
+  model.diagnostics_set("Cleared");
+
+  handle_input(controller, model, "2 3 4 fma");
+
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"10"});
+  EXPECT_TRUE(model.input_get().empty());
+}
+
+TEST(controller, fma_undo) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "2 3 4");
+  handle_input(controller, model, "fma");
+  ASSERT_EQ(model.stack().strings(), std::vector<std::string>{"10"});
+
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{"2", "3", "4"}));
+  EXPECT_EQ(model.input_get(), "fma");
+}
+
+} // namespace calculator
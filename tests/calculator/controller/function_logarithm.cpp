@@ -82,7 +82,8 @@ TEST(controller, ln_stack) {
 
   EXPECT_TRUE(model.diagnostics_get().empty());
   // Note this test is fragile, the exact result is 1.
-  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"0.999999"});
+  EXPECT_EQ(model.stack().strings(),
+            std::vector<std::string>{"0.999999327347282"});
   EXPECT_TRUE(model.input_get().empty());
 }
 
@@ -95,7 +96,8 @@ TEST(controller, ln_input) {
 
   EXPECT_TRUE(model.diagnostics_get().empty());
   // Note this test is fragile, the exact result is 1.
-  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"0.999999"});
+  EXPECT_EQ(model.stack().strings(),
+            std::vector<std::string>{"0.999999327347282"});
   EXPECT_TRUE(model.input_get().empty());
 }
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, matrix_reshape) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 4 pack 2 reshape");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[1, 2], [3, 4]]"}}));
+
+  handle_input(controller, model, "transpose");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[1, 3], [2, 4]]"}}));
+
+  handle_input(controller, model, "flatten");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 3, 2, 4]"}}));
+
+  handle_input(controller, model, "3 reshape");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The size isn't a multiple of the columns"));
+}
+
+TEST(controller, matrix_multiplication) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 4 pack 2 reshape");
+  handle_input(controller, model, "5 6 2 pack 1 reshape");
+  handle_input(controller, model, "matmul");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[17], [39]]"}}));
+
+  handle_input(controller, model, "2");
+  controller.handle_keyboard_input(tmodifiers::none, '*');
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[34], [78]]"}}));
+
+  controller.handle_keyboard_input(tkey::enter);
+  handle_input(controller, model, "matmul");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Matrix sizes differ"));
+}
+
+TEST(controller, matrix_products) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 3 pack 4 5 6 3 pack dot");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"32"}}));
+
+  handle_input(controller, model, "1 2 2 pack 3 4 2 pack outer");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"32"}, {"[[3, 4], [6, 8]]"}}));
+
+  handle_input(controller, model, "sum");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"53"}}));
+}
+
+TEST(controller, matrix_solve) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "2 1 1 1 4 pack 2 reshape");
+  handle_input(controller, model, "det");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"1"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "inv");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[1, -1], [-1, 2]]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "3 2 2 pack solve");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"[1, 1]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "lu");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[[1, 0], [0, 1]]"},
+                                      {"[[1, 0], [0.5, 1]]"},
+                                      {"[[2, 1], [0, 0.5]]"}}));
+
+  handle_input(controller, model, "1 2 2 4 4 pack 2 reshape inv");
+  EXPECT_EQ(model.diagnostics_get(), format_error("The matrix is singular"));
+}
+
+} // namespace calculator
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, notation) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "0.1 0.2");
+  controller.handle_keyboard_input(tmodifiers::none, '+');
+  handle_input(controller, model, "42");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"0.30000000000000004"}, {"42"}}));
+
+  handle_input(controller, model, "2 fix");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"0.30"}, {"42"}}));
+
+  handle_input(controller, model, "3 sci");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"3.000e-01"}, {"42"}}));
+
+  // The notation is undone with its command.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"0.30"}, {"42"}}));
+
+  handle_input(controller, model, "i0 fix");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"0"}, {"42"}}));
+
+  handle_input(controller, model, "shortest");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"0.30000000000000004"}, {"42"}}));
+}
+
+TEST(controller, notation_invalid) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "18 fix");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Value too large"));
+  model.input_reset();
+
+  handle_input(controller, model, "i-1 sci");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a non-negative value"));
+  model.input_reset();
+
+  handle_input(controller, model, "0.5 fix");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not an integral"));
+}
+
+} // namespace calculator
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, pack_too_few_elements) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2");
+  handle_input(controller, model, "3 pack");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain enough elements"));
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1"}, {"2"}}));
+  EXPECT_EQ(model.input_get(), "3 pack");
+}
+
+TEST(controller, pack_unpack) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 5 6 6 pack");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2, 3, ..., 5, 6]"}}));
+
+  handle_input(controller, model, "debug");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2, 3, ..., 5, 6] |vu"}}));
+  handle_input(controller, model, "debug");
+
+  handle_input(controller, model, "unpack");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{
+                {"1"}, {"2"}, {"3"}, {"4"}, {"5"}, {"6"}}));
+
+  handle_input(controller, model, "1");
+  controller.handle_keyboard_input(tmodifiers::control, 'n');
+  handle_input(controller, model, "2 pack");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{
+                {"1"}, {"2"}, {"3"}, {"4"}, {"5"}, {"[6, -1]"}}));
+}
+
+TEST(controller, pack_element_wise) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 3 pack");
+  handle_input(controller, model, "10");
+  controller.handle_keyboard_input(tmodifiers::none, '*');
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[10, 20, 30]"}}));
+
+  // The operation is undone in one step.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2, 3]"}, {"10"}}));
+}
+
+TEST(controller, pack_not_a_scalar) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 2 pack");
+  handle_input(controller, model, "1 pack");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a scalar"));
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"[1, 2]"}}));
+
+  controller.handle_keyboard_input(tmodifiers::control, 'n');
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a scalar"));
+}
+
+} // namespace calculator
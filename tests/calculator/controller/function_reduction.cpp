@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, reduction_stack) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4");
+  handle_input(controller, model, "sum");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"10"}}));
+
+  // The reduction is undone in one step.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1"}, {"2"}, {"3"}, {"4"}}));
+  EXPECT_EQ(model.input_get(), "sum");
+
+  controller.handle_keyboard_input(tkey::enter);
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"10"}}));
+
+  handle_input(controller, model, "3 prod");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"30"}}));
+
+  handle_input(controller, model, "5 min");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"5"}}));
+
+  handle_input(controller, model, "7 max");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"7"}}));
+
+  handle_input(controller, model, "1 2 count");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"3"}}));
+}
+
+TEST(controller, reduction_top) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 2 nsum");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1"}, {"2"}, {"7"}}));
+
+  handle_input(controller, model, "2 nprod");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1"}, {"14"}}));
+
+  handle_input(controller, model, "2 nmin");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"1"}}));
+
+  handle_input(controller, model, "5 1 nmax");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"1"}, {"5"}}));
+
+  handle_input(controller, model, "2 ncount");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"2"}}));
+
+  handle_input(controller, model, "2 nsum");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain enough elements"));
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"2"}}));
+}
+
+TEST(controller, reduction_summation) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1. 1e100 1. 1e100");
+  controller.handle_keyboard_input(tmodifiers::control, 'n');
+  handle_input(controller, model, "sum");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"0"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "psum");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"0"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "ksum");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"2"}}));
+
+  handle_input(controller, model, "1e100 1. 1e100");
+  controller.handle_keyboard_input(tmodifiers::control, 'n');
+  handle_input(controller, model, "3 nksum");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"2"}, {"1"}}));
+}
+
+TEST(controller, reduction_vector) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 3 pack 4");
+  handle_input(controller, model, "sum");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"10"}}));
+
+  handle_input(controller, model, "1 2 2 pack count");
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"3"}}));
+}
+
+TEST(controller, reduction_empty_stack) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "sum");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain an element"));
+  EXPECT_TRUE(model.stack().strings().empty());
+}
+
+} // namespace calculator
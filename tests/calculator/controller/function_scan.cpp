@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, scan) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 4 pack");
+  handle_input(controller, model, "cumsum");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 3, 6, 10]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "cumprod");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2, 6, 24]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "cummax");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2, 3, 4]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "cummin");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 1, 1, 1]"}}));
+
+  handle_input(controller, model, "1 cumsum");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a vector"));
+}
+
+} // namespace calculator
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, iota) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "4 iota");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[0, 1, 2, 3]"}}));
+
+  // Only the shown elements are calculated.
+  handle_input(controller, model, "999 iota 1");
+  controller.handle_keyboard_input(tmodifiers::none, '+');
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[0, 1, 2, 3]"},
+                                      {"[1, 2, 3, ..., 998, 999]"}}));
+
+  handle_input(controller, model, "1 nmax");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[0, 1, 2, 3]"}, {"999"}}));
+
+  handle_input(controller, model, "i-1 iota");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a positive value"));
+}
+
+TEST(controller, range) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "10 i-3 4");
+  handle_input(controller, model, "range");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[10, 7, 4, 1]"}}));
+
+  // The range is undone in one step.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"10"}, {"-3"}, {"4"}}));
+
+  handle_input(controller, model, "range 2.5");
+  controller.handle_keyboard_input(tmodifiers::none, '*');
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[25, 17.5, 10, 2.5]"}}));
+}
+
+} // namespace calculator
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, sort_stack) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "3 i-1 2.5 1 2");
+  handle_input(controller, model, "sort");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"-1"}, {"1"}, {"2"}, {"2.5"}, {"3"}}));
+
+  handle_input(controller, model, "rsort");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"3"}, {"2.5"}, {"2"}, {"1"}, {"-1"}}));
+
+  // The sort is undone in one step.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"-1"}, {"1"}, {"2"}, {"2.5"}, {"3"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"3"}, {"-1"}, {"2.5"}, {"1"}, {"2"}}));
+
+  handle_input(controller, model, "argsort");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 3, 4, 2, 0]"}}));
+}
+
+TEST(controller, sort_vector) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "5 3 i-1 4 1 4 pack");
+  handle_input(controller, model, "sort");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"5"}, {"[-1, 1, 3, 4]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "rsort");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"5"}, {"[4, 3, 1, -1]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+
+  handle_input(controller, model, "argsort");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"5"}, {"[1, 3, 0, 2]"}}));
+}
+
+TEST(controller, sort_invalid) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "sort");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain an element"));
+  model.input_reset();
+
+  handle_input(controller, model, "1 2 2 pack 3");
+  handle_input(controller, model, "sort");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a scalar"));
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2]"}, {"3"}}));
+  model.input_reset();
+
+  handle_input(controller, model, "argsort");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a scalar"));
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[1, 2]"}, {"3"}}));
+}
+
+} // namespace calculator
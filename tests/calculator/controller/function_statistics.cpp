@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.controller;
+
+import calculator.model;
+import tests.format_error;
+import tests.handle_input;
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+
+TEST(controller, median) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "5 1 4 2 3");
+  handle_input(controller, model, "median");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(), (std::vector<std::string>{{"3"}}));
+
+  // The reduction is undone in one step.
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  handle_input(controller, model, "2 nmedian");
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"5"}, {"1"}, {"4"}, {"2.5"}}));
+}
+
+TEST(controller, quantile) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 5 4 pack 1 0.75 2 pack");
+  handle_input(controller, model, "quantile");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[5, 4]"}}));
+
+  handle_input(controller, model, "2 quantile");
+  EXPECT_EQ(model.diagnostics_get(), format_error("Not a probability"));
+}
+
+TEST(controller, hist) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "1 2 3 4 5 6 7 8 3");
+  handle_input(controller, model, "hist");
+  EXPECT_TRUE(model.diagnostics_get().empty());
+  EXPECT_EQ(model.stack().strings(),
+            (std::vector<std::string>{{"[3, 2, 3]"}}));
+  controller.handle_keyboard_input(tmodifiers::control, 'z');
+  model.input_reset();
+  EXPECT_EQ(model.stack().size(), 9);
+
+}
+
+TEST(controller, hist_empty) {
+  tmodel model;
+  tcontroller controller{model};
+
+  handle_input(controller, model, "3 hist");
+  EXPECT_EQ(model.diagnostics_get(),
+            format_error("The stack doesn't contain an element"));
+  EXPECT_TRUE(model.stack().strings().empty());
+}
+
+} // namespace calculator
@@ -60,7 +60,7 @@ TEST(controller, key_char_forward_slash_stack_stack) {
 
   controller.handle_keyboard_input(tmodifiers::none, '/');
   EXPECT_TRUE(model.diagnostics_get().empty());
-  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"2.5"});
+  EXPECT_EQ(model.stack().strings(), std::vector<std::string>{"5/2"});
   EXPECT_TRUE(model.input_get().empty());
 }
 
@@ -14,8 +14,12 @@
 
 import calculator.stack;
 
+import calculator.math.matrix;
+import calculator.math.rational;
+import calculator.math.vector;
 import lib.base;
 
+#include <memory>
 #include <type_traits>
 
 #include <gtest/gtest.h>
@@ -31,6 +35,17 @@ TEST(stack, drop) {
 
   stack.drop();
   EXPECT_TRUE(stack.empty());
+
+  for (uint64_t i = 1; i <= 4; ++i)
+    stack.push(tvalue{i});
+
+  EXPECT_THROW(stack.drop(5), std::out_of_range);
+  EXPECT_EQ(stack.size(), 4);
+
+  stack.drop(3);
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{{"1"}}));
+  stack.drop(0);
+  EXPECT_EQ(stack.size(), 1);
 }
 
 TEST(stack, display_double) {
@@ -44,6 +59,87 @@ TEST(stack, display_double) {
                                  {"-42"}, {"0.1"}, {"42.23"}, {"100.456"}}));
 }
 
+TEST(stack, display_rational) {
+  tstack stack;
+  stack.push(tvalue{math::trational{1, 3}});
+  stack.push(tvalue{math::trational{-4, 6}});
+  stack.push(tvalue{math::trational{6, 3}});
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"1/3"}, {"-2/3"}, {"2"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0x1/0x3"}, {"-0x2/0x3"}, {"0x2"}}));
+}
+
+TEST(stack, display_vector) {
+  tstack stack;
+  stack.push(tvalue{math::tvector{std::vector<uint64_t>{1, 2, 3}}});
+  stack.push(tvalue{math::tvector{std::vector<int64_t>{-1, 2, -3, 4, -5, 6}}});
+  stack.push(tvalue{math::tvector{std::vector<double>{.5}}});
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"[1, 2, 3]"}, {"[-1, 2, -3, ..., -5, 6]"}, {"[0.5]"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{
+                                 {"[0x1, 0x2, 0x3]"},
+                                 {"[-0x1, 0x2, -0x3, ..., -0x5, 0x6]"},
+                                 {"[0.5]"}}));
+
+  stack.debug_mode_toggle();
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{
+                                 {"[0x1, 0x2, 0x3] |vu"},
+                                 {"[-0x1, 0x2, -0x3, ..., -0x5, 0x6] |vi"},
+                                 {"[0.5] |vd"}}));
+}
+
+TEST(stack, display_deferred_vector) {
+  // The element at index i is i.
+  class texpression_index final : public math::texpression {
+  public:
+    texpression_index() : texpression(1'000'000, 1) {}
+
+    void evaluate(std::size_t first, std::size_t count,
+                  double *result) const override {
+      for (std::size_t i = 0; i < count; ++i)
+        result[i] = static_cast<double>(first + i);
+    }
+  };
+
+  const math::tvector vector{std::make_unique<const texpression_index>()};
+  tstack stack;
+  stack.push(tvalue{vector});
+  stack.debug_mode_toggle();
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{
+                                 {"[0, 1, 2, ..., 999998, 999999] |vd"}}));
+
+  // Only the shown elements are calculated.
+  EXPECT_FALSE(vector.stored());
+}
+
+TEST(stack, display_matrix) {
+  tstack stack;
+  stack.push(tvalue{math::tmatrix{
+      2, 2, math::tvector{std::vector<int64_t>{1, -2, 3, 4}}}});
+  stack.push(tvalue{math::tmatrix{
+      1, 6, math::tvector{std::vector<int64_t>{1, 2, 3, 4, 5, 6}}}});
+  stack.push(tvalue{math::tmatrix{
+      6, 1, math::tvector{std::vector<double>{1, 2, 3, 4, 5, .5}}}});
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"[[1, -2], [3, 4]]"},
+                                      {"[[1, 2, 3, ..., 5, 6]]"},
+                                      {"[[1], [2], [3], ..., [5], [0.5]]"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  stack.debug_mode_toggle();
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"[[0x1, -0x2], [0x3, 0x4]] |mi"},
+                {"[[0x1, 0x2, 0x3, ..., 0x5, 0x6]] |mi"},
+                {"[[1], [2], [3], ..., [5], [0.5]] |md"}}));
+}
+
 TEST(stack, empty) {
   const tstack stack;
   static_assert(noexcept(stack.empty()));
@@ -55,11 +151,6 @@ TEST(stack, size) {
 }
 
 TEST(stack, base_default) {
-  {
-    const tstack stack;
-    static_assert(noexcept(stack.strings()));
-  }
-
   tstack stack;
   stack.push(tvalue{uint64_t(42)});
   stack.push(tvalue{uint64_t(100)});
@@ -111,6 +202,60 @@ TEST(stack, base_16) {
   EXPECT_EQ(stack.strings(), std::vector<std::string>{});
 }
 
+TEST(stack, grouping) {
+  // Uses the separator of the current locale.
+  const std::string separator{
+      std::use_facet<std::numpunct<char>>(std::locale()).thousands_sep()};
+  auto group = [&](std::vector<std::string> groups, std::string separator) {
+    std::string result = groups[0];
+    for (std::size_t i = 1; i < groups.size(); ++i)
+      result += separator + groups[i];
+    return result;
+  };
+
+  tstack stack;
+  stack.push(tvalue{uint64_t(0)});
+  stack.push(tvalue{uint64_t(UINT64_MAX)});
+  stack.push(tvalue{int64_t(INT64_MIN)});
+  stack.push(tvalue{int64_t(-1000)});
+
+  stack.base_set(lib::tbase::binary);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"0b0"},
+                {"0b" + group(std::vector<std::string>(16, "1111"), "'")},
+                {"-0b" + group(std::vector<std::string>(16, "0000"), "'")
+                             .replace(0, 1, "1")},
+                {"-0b11'1110'1000"}}));
+
+  stack.base_set(lib::tbase::octal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"0"},
+                {"01" + separator +
+                 group(std::vector<std::string>(7, "777"), separator)},
+                {"-01" + separator +
+                 group(std::vector<std::string>(7, "000"), separator)},
+                {"-01" + separator + "750"}}));
+
+  stack.base_set(lib::tbase::decimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"0"},
+                {group({"18", "446", "744", "073", "709", "551", "615"},
+                       separator)},
+                {"-" + group({"9", "223", "372", "036", "854", "775", "808"},
+                             separator)},
+                {"-1" + separator + "000"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0x0"},
+                                      {"0xffff'ffff'ffff'ffff"},
+                                      {"-0x8000'0000'0000'0000"},
+                                      {"-0x3e8"}}));
+}
+
 TEST(stack, push) {
   tstack stack;
 
@@ -156,4 +301,195 @@ TEST(stack, pop) {
   EXPECT_THROW(stack.drop(), std::out_of_range);
 }
 
+static std::vector<std::string> strings(const tstack &stack, std::size_t first,
+                                        std::size_t last) {
+  const std::vector<std::string_view> result = stack.strings(first, last);
+  return {result.begin(), result.end()};
+}
+
+TEST(stack, strings_window) {
+  tstack stack;
+  for (uint64_t i = 1; i <= 5; ++i)
+    stack.push(tvalue{i});
+
+  EXPECT_TRUE(stack.strings(0, 0).empty());
+  EXPECT_EQ(strings(stack, 3, 5), (std::vector<std::string>{{"4"}, {"5"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(strings(stack, 3, 5), (std::vector<std::string>{{"0x4"}, {"0x5"}}));
+  EXPECT_EQ(strings(stack, 0, 1), (std::vector<std::string>{{"0x1"}}));
+
+  stack.push(tvalue{uint64_t(6)});
+  stack.duplicate();
+  EXPECT_EQ(strings(stack, 5, 7), (std::vector<std::string>{{"0x6"}, {"0x6"}}));
+
+  // The values rendered in an older base are out of sync.
+  stack.base_set(lib::tbase::octal);
+  EXPECT_EQ(strings(stack, 4, 6), (std::vector<std::string>{{"05"}, {"06"}}));
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{
+                {"01"}, {"02"}, {"03"}, {"04"}, {"05"}, {"06"}, {"06"}}));
+}
+
+TEST(stack, strings_synchronise) {
+  tstack stack;
+  stack.push(tvalue{uint64_t(1)});
+  stack.push(tvalue{uint64_t(2)});
+  stack.push(tvalue{uint64_t(3)});
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{{"1"}, {"2"}, {"3"}}));
+
+  stack.drop();
+  stack.drop();
+  stack.push(tvalue{uint64_t(4)});
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{{"1"}, {"4"}}));
+
+  // A window above the out of sync values.
+  stack.base_set(lib::tbase::hexadecimal);
+  stack.push(tvalue{uint64_t(5)});
+  EXPECT_EQ(strings(stack, 1, 3), (std::vector<std::string>{{"0x4"}, {"0x5"}}));
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0x1"}, {"0x4"}, {"0x5"}}));
+
+  // A window at the low-water mark.
+  stack.base_set(lib::tbase::decimal);
+  EXPECT_EQ(strings(stack, 0, 1), (std::vector<std::string>{{"1"}}));
+  stack.duplicate();
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"1"}, {"4"}, {"5"}, {"5"}}));
+
+  const std::array<std::size_t, 4> permutation{3, 2, 1, 0};
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(strings(stack, 3, 4), (std::vector<std::string>{{"0x5"}}));
+  stack.permute(permutation);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0x5"}, {"0x5"}, {"0x4"}, {"0x1"}}));
+}
+
+TEST(stack, display_cache) {
+  tstack stack;
+  stack.push(tvalue{uint64_t(10)});
+  stack.push(tvalue{uint64_t(11)});
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{{"10"}, {"11"}}));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(), (std::vector<std::string>{{"0xa"}, {"0xb"}}));
+
+  // The cached display is updated when the stack changes.
+  stack.drop();
+  stack.push(tvalue{uint64_t(12)});
+  stack.push(tvalue{uint64_t(13)});
+  stack.base_set(lib::tbase::decimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"10"}, {"12"}, {"13"}}));
+
+  const std::array<std::size_t, 3> permutation{2, 0, 1};
+  stack.permute(permutation);
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0xd"}, {"0xa"}, {"0xc"}}));
+
+  // Uses more modes than cached, the least recently used mode is reused.
+  stack.base_set(lib::tbase::binary);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0b1101"}, {"0b1010"}, {"0b1100"}}));
+  stack.base_set(lib::tbase::octal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"015"}, {"012"}, {"014"}}));
+  stack.debug_mode_toggle();
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"015 |u"}, {"012 |u"}, {"014 |u"}}));
+  stack.debug_mode_toggle();
+  stack.base_set(lib::tbase::decimal);
+  stack.duplicate();
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"13"}, {"10"}, {"12"}, {"12"}}));
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(),
+            (std::vector<std::string>{{"0xd"}, {"0xa"}, {"0xc"}, {"0xc"}}));
+}
+
+TEST(stack, display_arena) {
+  // Large enough to compact the arena.
+  static constexpr std::size_t size = 2'000;
+  static constexpr uint64_t bias = uint64_t(1) << 63;
+  auto expected_binary = [](std::size_t size) {
+    std::vector<std::string> result;
+    for (uint64_t i = 0; i < size; ++i)
+      result.push_back(std::format("{:#b}", bias + i));
+    return result;
+  };
+
+  tstack stack;
+  stack.grouping_toggle();
+  stack.base_set(lib::tbase::binary);
+  for (uint64_t i = 0; i < size; ++i)
+    stack.push(tvalue{bias + i});
+  EXPECT_EQ(stack.strings(), expected_binary(size));
+
+  // Reusing the displays renders the values again.
+  for (int i = 0; i < 3; ++i) {
+    stack.base_set(lib::tbase::octal);
+    stack.base_set(lib::tbase::decimal);
+    stack.base_set(lib::tbase::hexadecimal);
+    stack.debug_mode_toggle();
+    stack.debug_mode_toggle();
+    stack.base_set(lib::tbase::binary);
+    EXPECT_EQ(stack.strings(), expected_binary(size));
+  }
+
+  for (std::size_t i = 0; i < size - 10; ++i)
+    stack.drop();
+  stack.duplicate();
+  std::vector<std::string> strings = expected_binary(10);
+  strings.push_back(strings.back());
+  EXPECT_EQ(stack.strings(), strings);
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings().back(), "0x8000000000000009");
+}
+
+TEST(stack, background_formatting) {
+  static constexpr std::size_t size = 100'000;
+  auto expected = [](auto format) {
+    std::vector<std::string> result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+      result.push_back(format(i));
+    return result;
+  };
+
+  tstack stack;
+  stack.background_formatting_set(true);
+  for (uint64_t i = 0; i < size; ++i)
+    stack.push(tvalue{i});
+
+  // The requested values are available while the background thread runs.
+  stack.grouping_toggle();
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(strings(stack, size - 2, size),
+            (std::vector<std::string>{{"0x1869e"}, {"0x1869f"}}));
+
+  // Modifying the stack while the background thread runs.
+  stack.drop();
+  stack.push(tvalue{uint64_t(size - 1)});
+  stack.base_set(lib::tbase::octal);
+  std::vector<std::size_t> permutation(size);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  stack.permute(permutation);
+  EXPECT_EQ(stack.strings(), expected([](std::size_t i) {
+              return std::format("{:#o}", i);
+            }));
+
+  stack.base_set(lib::tbase::hexadecimal);
+  EXPECT_EQ(stack.strings(), expected([](std::size_t i) {
+              return std::format("{:#x}", i);
+            }));
+
+  stack.background_formatting_set(false);
+  stack.base_set(lib::tbase::decimal);
+  EXPECT_EQ(stack.strings(), expected([](std::size_t i) {
+              return std::format("{}", i);
+            }));
+}
+
 } // namespace calculator
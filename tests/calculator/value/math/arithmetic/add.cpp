@@ -311,5 +311,31 @@ TEST(arithmetic, add_double_double) {
       add(tstorage{limit::signaling_NaN()}, tstorage{double(0)}))));
 }
 
+TEST(arithmetic, add_rational) {
+  const tstorage third{trational{1, 3}};
+  EXPECT_EQ(std::get<trational>(add(third, third)), (trational{2, 3}));
+  EXPECT_EQ(std::get<trational>(add(third, tstorage{int64_t(-1)})),
+            (trational{-2, 3}));
+  EXPECT_EQ(std::get<trational>(add(tstorage{uint64_t(1)}, third)),
+            (trational{4, 3}));
+  EXPECT_EQ(std::get<trational>(add(third, tstorage{trational{1, 6}})),
+            (trational{1, 2}));
+  EXPECT_EQ(std::get<double>(add(third, tstorage{0.5})), 1. / 3. + 0.5);
+
+  // Adding fractions with the same denominator doesn't reduce the result.
+  tstorage sum{trational{0, 8}};
+  for (int i = 0; i < 8; ++i)
+    sum = add(sum, tstorage{trational{1, 8}});
+  EXPECT_EQ(std::get<trational>(sum).numerator, 8);
+  EXPECT_EQ(std::get<trational>(sum).denominator, 8);
+
+  // Overflows are stored as a double.
+  EXPECT_EQ(std::get<double>(add(tstorage{trational{INT64_MAX, 3}},
+                                 tstorage{trational{INT64_MAX, 3}})),
+            static_cast<double>(INT64_MAX) / 3. * 2.);
+  EXPECT_EQ(std::get<double>(add(third, tstorage{UINT64_MAX})),
+            static_cast<double>(UINT64_MAX) + 1. / 3.);
+}
+
 } // namespace math
 } // namespace calculator
@@ -23,30 +23,47 @@ namespace calculator {
 namespace math {
 
 TEST(arithmetic, div_int64_t_int64_t) {
-  ASSERT_TRUE(std::holds_alternative<double>(
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
       div(tstorage{int64_t(1)}, tstorage{int64_t(1)})));
 
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(-1)}, tstorage{int64_t(-1)})),
-            1.);
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(0)}, tstorage{int64_t(-1)})),
-            0.);
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(-1)}, tstorage{int64_t(1)})),
-            -1.);
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(3)}, tstorage{int64_t(2)})),
-            1.5);
+  EXPECT_EQ(
+      std::get<int64_t>(div(tstorage{int64_t(-1)}, tstorage{int64_t(-1)})), 1);
+  EXPECT_EQ(std::get<int64_t>(div(tstorage{int64_t(0)}, tstorage{int64_t(-1)})),
+            0);
+  EXPECT_EQ(std::get<int64_t>(div(tstorage{int64_t(-1)}, tstorage{int64_t(1)})),
+            -1);
+  EXPECT_EQ(std::get<uint64_t>(div(tstorage{INT64_MIN}, tstorage{int64_t(-1)})),
+            uint64_t(INT64_MAX) + 1);
+
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{int64_t(3)}, tstorage{int64_t(2)})),
+      (trational{3, 2}));
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{int64_t(3)}, tstorage{int64_t(-2)})),
+      (trational{-3, 2}));
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{int64_t(-4)}, tstorage{int64_t(-6)})),
+      (trational{2, 3}));
 
   EXPECT_THROW(div(tstorage{int64_t(3)}, tstorage{int64_t(0)}),
                std::domain_error);
 }
 
 TEST(arithmetic, div_int64_t_uint64_t) {
-  ASSERT_TRUE(std::holds_alternative<double>(
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
       div(tstorage{int64_t(1)}, tstorage{uint64_t(1)})));
 
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(1)}, tstorage{uint64_t(1)})),
-            1);
-  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(3)}, tstorage{uint64_t(2)})),
-            1.5);
+  EXPECT_EQ(
+      std::get<uint64_t>(div(tstorage{int64_t(1)}, tstorage{uint64_t(1)})), 1);
+  EXPECT_EQ(
+      std::get<int64_t>(div(tstorage{int64_t(-2)}, tstorage{uint64_t(1)})), -2);
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{int64_t(3)}, tstorage{uint64_t(2)})),
+      (trational{3, 2}));
+
+  // The denominator doesn't fit in a rational.
+  EXPECT_EQ(std::get<double>(div(tstorage{int64_t(-1)}, tstorage{UINT64_MAX})),
+            -1. / static_cast<double>(UINT64_MAX));
 
   EXPECT_THROW(div(tstorage{int64_t(3)}, tstorage{uint64_t(0)}),
                std::domain_error);
@@ -74,22 +91,39 @@ TEST(arithmetic, div_int64_t_double) {
 }
 
 TEST(arithmetic, div_uint64_t_int64_t) {
-  ASSERT_TRUE(std::holds_alternative<double>(
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
       div(tstorage{uint64_t(1)}, tstorage{int64_t(1)})));
 
-  EXPECT_EQ(std::get<double>(div(tstorage{uint64_t(3)}, tstorage{int64_t(2)})),
-            1.5);
+  EXPECT_EQ(
+      std::get<int64_t>(div(tstorage{uint64_t(4)}, tstorage{int64_t(-2)})), -2);
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{uint64_t(3)}, tstorage{int64_t(2)})),
+      (trational{3, 2}));
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{uint64_t(3)}, tstorage{int64_t(-2)})),
+      (trational{-3, 2}));
 
   EXPECT_THROW(div(tstorage{uint64_t(3)}, tstorage{int64_t(0)}),
                std::domain_error);
 }
 
 TEST(arithmetic, div_uint64_t_uint64_t) {
-  ASSERT_TRUE(std::holds_alternative<double>(
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
       div(tstorage{uint64_t(1)}, tstorage{uint64_t(1)})));
 
-  EXPECT_EQ(std::get<double>(div(tstorage{uint64_t(3)}, tstorage{uint64_t(2)})),
-            1.5);
+  EXPECT_EQ(std::get<uint64_t>(div(tstorage{UINT64_MAX}, tstorage{UINT64_MAX})),
+            1);
+  EXPECT_EQ(
+      std::get<trational>(div(tstorage{uint64_t(3)}, tstorage{uint64_t(2)})),
+      (trational{3, 2}));
+
+  // Only the reduced fraction fits in a rational.
+  EXPECT_EQ(std::get<trational>(
+                div(tstorage{uint64_t(2)}, tstorage{UINT64_MAX - 1})),
+            (trational{1, INT64_MAX}));
+  // The numerator doesn't fit in a rational.
+  EXPECT_EQ(std::get<double>(div(tstorage{UINT64_MAX}, tstorage{uint64_t(2)})),
+            static_cast<double>(UINT64_MAX) / 2.);
 
   EXPECT_THROW(div(tstorage{uint64_t(3)}, tstorage{uint64_t(0)}),
                std::domain_error);
@@ -158,5 +192,18 @@ TEST(arithmetic, div_double_double) {
                std::domain_error);
 }
 
+TEST(arithmetic, div_rational) {
+  const tstorage third{trational{1, 3}};
+  EXPECT_EQ(std::get<trational>(div(third, third)), (trational{1, 1}));
+  EXPECT_EQ(std::get<trational>(div(third, tstorage{int64_t(-2)})),
+            (trational{-1, 6}));
+  EXPECT_EQ(std::get<trational>(div(tstorage{uint64_t(2)}, third)),
+            (trational{6, 1}));
+  EXPECT_EQ(std::get<double>(div(third, tstorage{0.5})), 1. / 3. / 0.5);
+
+  EXPECT_THROW(div(third, tstorage{trational{0, 1}}), std::domain_error);
+  EXPECT_THROW(div(third, tstorage{int64_t(0)}), std::domain_error);
+}
+
 } // namespace math
 } // namespace calculator
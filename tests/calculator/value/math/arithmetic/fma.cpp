@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.arithmetic;
+
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(arithmetic, fma_int64_t_int64_t_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      fma(tstorage{int64_t(1)}, tstorage{int64_t(1)}, tstorage{int64_t(1)})));
+
+  EXPECT_EQ(std::get<int64_t>(fma(tstorage{int64_t(2)}, tstorage{int64_t(3)},
+                                  tstorage{int64_t(4)})),
+            10);
+  EXPECT_EQ(std::get<int64_t>(fma(tstorage{int64_t(-2)}, tstorage{int64_t(3)},
+                                  tstorage{int64_t(4)})),
+            -2);
+}
+
+TEST(arithmetic, fma_int64_t_int64_t_int64_t_intermediate_overflow) {
+  // The multiplication doesn't fit in 64-bit, the final result does.
+  using limits = std::numeric_limits<int64_t>;
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      fma(tstorage{limits::max()}, tstorage{int64_t(2)},
+          tstorage{limits::min()})));
+
+  EXPECT_EQ(std::get<int64_t>(fma(tstorage{limits::max()}, tstorage{int64_t(2)},
+                                  tstorage{limits::min()})),
+            limits::max() - 1);
+}
+
+TEST(arithmetic, fma_int64_t_int64_t_int64_t_result_overflow_uint64_t) {
+  using limits = std::numeric_limits<int64_t>;
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(fma(
+      tstorage{limits::max()}, tstorage{int64_t(1)}, tstorage{int64_t(1)})));
+
+  EXPECT_EQ(std::get<uint64_t>(fma(tstorage{limits::max()},
+                                   tstorage{int64_t(1)}, tstorage{int64_t(1)})),
+            uint64_t(limits::max()) + 1);
+}
+
+TEST(arithmetic, fma_uint64_t_uint64_t_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(fma(
+      tstorage{uint64_t(1)}, tstorage{uint64_t(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(std::get<uint64_t>(fma(tstorage{uint64_t(2)},
+                                   tstorage{uint64_t(3)},
+                                   tstorage{uint64_t(4)})),
+            10);
+}
+
+TEST(arithmetic, fma_uint64_t_uint64_t_uint64_t_result_double) {
+  using limits = std::numeric_limits<uint64_t>;
+  ASSERT_TRUE(std::holds_alternative<double>(
+      fma(tstorage{limits::max()}, tstorage{limits::max()},
+          tstorage{limits::max()})));
+
+  const double max = static_cast<double>(limits::max());
+  EXPECT_EQ(std::get<double>(fma(tstorage{limits::max()},
+                                 tstorage{limits::max()},
+                                 tstorage{limits::max()})),
+            std::fma(max, max, max));
+}
+
+TEST(arithmetic, fma_int64_t_uint64_t_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      fma(tstorage{int64_t(-2)}, tstorage{uint64_t(3)}, tstorage{int64_t(4)})));
+
+  EXPECT_EQ(std::get<int64_t>(fma(tstorage{int64_t(-2)}, tstorage{uint64_t(3)},
+                                  tstorage{int64_t(4)})),
+            -2);
+  EXPECT_EQ(std::get<uint64_t>(fma(tstorage{int64_t(2)}, tstorage{uint64_t(3)},
+                                   tstorage{int64_t(4)})),
+            10);
+}
+
+TEST(arithmetic, fma_double) {
+  ASSERT_TRUE(std::holds_alternative<double>(
+      fma(tstorage{int64_t(1)}, tstorage{double(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(std::get<double>(fma(tstorage{double(2)}, tstorage{double(3)},
+                                 tstorage{double(4)})),
+            10.);
+
+  // Only rounds once, a separate multiply and add would result in 0.
+  const double epsilon = std::numeric_limits<double>::epsilon();
+  EXPECT_EQ(std::get<double>(fma(tstorage{1. + epsilon},
+                                 tstorage{1. - epsilon}, tstorage{-1.})),
+            -epsilon * epsilon);
+}
+
+} // namespace math
+} // namespace calculator
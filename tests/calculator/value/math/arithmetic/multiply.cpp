@@ -342,5 +342,21 @@ TEST(arithmetic, mul_double_double) {
       mul(tstorage{limit::signaling_NaN()}, tstorage{double(1)}))));
 }
 
+TEST(arithmetic, mul_rational) {
+  const tstorage third{trational{1, 3}};
+  EXPECT_EQ(std::get<trational>(mul(third, third)), (trational{1, 9}));
+  EXPECT_EQ(std::get<trational>(mul(third, tstorage{int64_t(-3)})),
+            (trational{-1, 1}));
+  EXPECT_EQ(std::get<trational>(mul(tstorage{uint64_t(2)}, third)),
+            (trational{2, 3}));
+  EXPECT_EQ(std::get<double>(mul(third, tstorage{0.5})), 1. / 3. * 0.5);
+
+  // Overflows are stored as a double.
+  EXPECT_EQ(std::get<double>(mul(tstorage{trational{1, INT64_MAX}},
+                                 tstorage{trational{1, INT64_MAX - 1}})),
+            (1. / static_cast<double>(INT64_MAX)) *
+                (1. / static_cast<double>(INT64_MAX - 1)));
+}
+
 } // namespace math
 } // namespace calculator
@@ -60,5 +60,18 @@ TEST(arithmetic, negate_double) {
   EXPECT_EQ(std::get<double>(negate(tstorage{double(-1)})), 1.);
 }
 
+TEST(arithmetic, negate_rational) {
+  EXPECT_EQ(std::get<trational>(negate(tstorage{trational{1, 3}})),
+            (trational{-1, 3}));
+  EXPECT_EQ(std::get<trational>(negate(tstorage{trational{-1, 3}})),
+            (trational{1, 3}));
+  EXPECT_EQ(std::get<trational>(negate(tstorage{trational{INT64_MIN, 2}})),
+            (trational{INT64_MAX / 2 + 1, 1}));
+
+  // Overflows are stored as a double.
+  EXPECT_EQ(std::get<double>(negate(tstorage{trational{INT64_MIN, 3}})),
+            -static_cast<double>(INT64_MIN) / 3.);
+}
+
 } // namespace math
 } // namespace calculator
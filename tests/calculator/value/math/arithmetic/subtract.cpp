@@ -331,5 +331,23 @@ TEST(arithmetic, sub_double_double) {
       sub(tstorage{limit::signaling_NaN()}, tstorage{double(0)}))));
 }
 
+TEST(arithmetic, sub_rational) {
+  const tstorage third{trational{1, 3}};
+  EXPECT_EQ(std::get<trational>(sub(third, third)), (trational{0, 1}));
+  EXPECT_EQ(std::get<trational>(sub(third, tstorage{int64_t(1)})),
+            (trational{-2, 3}));
+  EXPECT_EQ(std::get<trational>(sub(tstorage{uint64_t(1)}, third)),
+            (trational{2, 3}));
+  EXPECT_EQ(std::get<trational>(sub(third, tstorage{trational{1, 2}})),
+            (trational{-1, 6}));
+  EXPECT_EQ(std::get<double>(sub(third, tstorage{0.5})), 1. / 3. - 0.5);
+
+  // Overflows are stored as a double.
+  EXPECT_EQ(std::get<double>(sub(tstorage{trational{INT64_MIN, 7}},
+                                 tstorage{trational{INT64_MAX, 7}})),
+            static_cast<double>(INT64_MIN) / 7. -
+                static_cast<double>(INT64_MAX) / 7.);
+}
+
 } // namespace math
 } // namespace calculator
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, bitrev_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(bitrev(tstorage{int64_t(0)})));
+
+  EXPECT_EQ(std::get<int64_t>(bitrev(tstorage{int64_t(0)})), 0);
+  EXPECT_EQ(std::get<int64_t>(bitrev(tstorage{int64_t(-1)})), -1);
+  EXPECT_EQ(std::get<int64_t>(bitrev(tstorage{int64_t(1)})),
+            std::numeric_limits<int64_t>::min());
+}
+
+TEST(bitwise, bitrev_uint64_t) {
+  ASSERT_TRUE(
+      std::holds_alternative<uint64_t>(bitrev(tstorage{uint64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(bitrev(tstorage{uint64_t(1)})),
+            uint64_t(1) << 63);
+  EXPECT_EQ(std::get<uint64_t>(bitrev(tstorage{uint64_t(0x0f)})),
+            uint64_t(0xf000000000000000));
+}
+
+TEST(bitwise, bitrev_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(bitrev(tstorage{double(0)})));
+
+  // 0x3ff0000000000000
+  EXPECT_EQ(std::get<uint64_t>(bitrev(tstorage{double(1)})), uint64_t(0xffc));
+}
+
+} // namespace math
+} // namespace calculator
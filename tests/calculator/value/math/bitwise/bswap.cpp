@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, bswap_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(bswap(tstorage{int64_t(0)})));
+
+  EXPECT_EQ(std::get<int64_t>(bswap(tstorage{int64_t(0)})), 0);
+  EXPECT_EQ(std::get<int64_t>(bswap(tstorage{int64_t(-1)})), -1);
+  EXPECT_EQ(std::get<int64_t>(bswap(tstorage{int64_t(1)})),
+            int64_t(0x0100000000000000));
+}
+
+TEST(bitwise, bswap_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(bswap(tstorage{uint64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(bswap(tstorage{uint64_t(0x0102030405060708)})),
+            uint64_t(0x0807060504030201));
+}
+
+TEST(bitwise, bswap_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(bswap(tstorage{double(0)})));
+
+  // 0x3ff0000000000000
+  EXPECT_EQ(std::get<uint64_t>(bswap(tstorage{double(1)})), uint64_t(0xf03f));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, ctz_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(ctz(tstorage{int64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{int64_t(0)})), 64);
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{int64_t(1)})), 0);
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{int64_t(-2)})), 1);
+}
+
+TEST(bitwise, ctz_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(ctz(tstorage{uint64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{uint64_t(0)})), 64);
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{uint64_t(8)})), 3);
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{uint64_t(1) << 63})), 63);
+}
+
+TEST(bitwise, ctz_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(ctz(tstorage{double(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{double(0)})), 64);
+  // 0x3ff0000000000000
+  EXPECT_EQ(std::get<uint64_t>(ctz(tstorage{double(1)})), 52);
+}
+
+} // namespace math
+} // namespace calculator
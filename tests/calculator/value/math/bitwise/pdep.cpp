@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <bit>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, pdep_int64_t_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      pdep(tstorage{int64_t(1)}, tstorage{int64_t(1)})));
+
+  EXPECT_EQ(
+      std::get<int64_t>(pdep(tstorage{int64_t(0b101)}, tstorage{int64_t(0)})),
+      0);
+  EXPECT_EQ(std::get<int64_t>(pdep(tstorage{int64_t(0b101)},
+                                   tstorage{int64_t(0b1111'0000)})),
+            0b0101'0000);
+  EXPECT_EQ(
+      std::get<int64_t>(pdep(tstorage{int64_t(-1)}, tstorage{int64_t(-2)})),
+      -2);
+}
+
+TEST(bitwise, pdep_int64_t_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      pdep(tstorage{int64_t(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(std::get<uint64_t>(
+                pdep(tstorage{int64_t(-1)}, tstorage{uint64_t(0xff00)})),
+            0xff00);
+}
+
+TEST(bitwise, pdep_uint64_t_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      pdep(tstorage{uint64_t(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(std::get<uint64_t>(pdep(tstorage{uint64_t(0b1011)},
+                                    tstorage{uint64_t(0b1010'1010)})),
+            0b1000'1010);
+  EXPECT_EQ(std::get<uint64_t>(pdep(tstorage{uint64_t(0xff)},
+                                    tstorage{uint64_t(0xf00000000000000f)})),
+            uint64_t(0xf00000000000000f));
+}
+
+TEST(bitwise, pdep_double_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      pdep(tstorage{double(1)}, tstorage{double(1)})));
+
+  // 0x3ff0000000000000
+  EXPECT_EQ(std::get<uint64_t>(pdep(
+                tstorage{std::bit_cast<double>(uint64_t(0x3ff))},
+                tstorage{std::bit_cast<double>(uint64_t(0x7ff0000000000000))})),
+            uint64_t(0x3ff0000000000000));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, popcount_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(popcount(tstorage{int64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{int64_t(0)})), 0);
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{int64_t(-1)})), 64);
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{int64_t(0x55)})), 4);
+}
+
+TEST(bitwise, popcount_uint64_t) {
+  ASSERT_TRUE(
+      std::holds_alternative<uint64_t>(popcount(tstorage{uint64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{uint64_t(0)})), 0);
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{uint64_t(0xff)})), 8);
+  EXPECT_EQ(std::get<uint64_t>(
+                popcount(tstorage{std::numeric_limits<uint64_t>::max()})),
+            64);
+}
+
+TEST(bitwise, popcount_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(popcount(tstorage{double(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{double(0)})), 0);
+  // 0x3ff0000000000000
+  EXPECT_EQ(std::get<uint64_t>(popcount(tstorage{double(1)})), 10);
+}
+
+} // namespace math
+} // namespace calculator
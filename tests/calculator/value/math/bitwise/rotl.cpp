@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, rotl_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      rotl(tstorage{int64_t(1)}, tstorage{int64_t(1)})));
+
+  EXPECT_THROW(rotl(tstorage{int64_t(0)}, tstorage{int64_t(-1)}),
+               std::range_error);
+  EXPECT_THROW(rotl(tstorage{int64_t(0)}, tstorage{int64_t(0)}),
+               std::range_error);
+  EXPECT_THROW(rotl(tstorage{int64_t(0)}, tstorage{int64_t(65)}),
+               std::range_error);
+
+  EXPECT_EQ(std::get<int64_t>(rotl(tstorage{int64_t(1)}, tstorage{int64_t(1)})),
+            2);
+  EXPECT_EQ(
+      std::get<int64_t>(rotl(tstorage{int64_t(-2)}, tstorage{int64_t(1)})), -3);
+  EXPECT_EQ(
+      std::get<int64_t>(rotl(tstorage{int64_t(-2)}, tstorage{int64_t(64)})),
+      -2);
+}
+
+TEST(bitwise, rotl_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      rotl(tstorage{uint64_t(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(std::get<uint64_t>(rotl(tstorage{uint64_t(0x8000000000000001)},
+                                    tstorage{uint64_t(1)})),
+            3);
+  EXPECT_EQ(std::get<uint64_t>(
+                rotl(tstorage{uint64_t(0xff)}, tstorage{uint64_t(60)})),
+            uint64_t(0xf00000000000000f));
+}
+
+TEST(bitwise, rotl_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      rotl(tstorage{double(1)}, tstorage{double(1)})));
+
+  // 0x3ff0000000000000
+  EXPECT_EQ(
+      std::get<uint64_t>(rotl(tstorage{double(1)}, tstorage{double(12)})),
+      uint64_t(0x3ff));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.bitwise;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(bitwise, rotr_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<int64_t>(
+      rotr(tstorage{int64_t(1)}, tstorage{int64_t(1)})));
+
+  EXPECT_THROW(rotr(tstorage{int64_t(0)}, tstorage{int64_t(-1)}),
+               std::range_error);
+  EXPECT_THROW(rotr(tstorage{int64_t(0)}, tstorage{int64_t(0)}),
+               std::range_error);
+  EXPECT_THROW(rotr(tstorage{int64_t(0)}, tstorage{int64_t(65)}),
+               std::range_error);
+
+  EXPECT_EQ(std::get<int64_t>(rotr(tstorage{int64_t(2)}, tstorage{int64_t(1)})),
+            1);
+  EXPECT_EQ(std::get<int64_t>(rotr(tstorage{int64_t(1)}, tstorage{int64_t(1)})),
+            std::numeric_limits<int64_t>::min());
+}
+
+TEST(bitwise, rotr_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      rotr(tstorage{uint64_t(1)}, tstorage{uint64_t(1)})));
+
+  EXPECT_EQ(
+      std::get<uint64_t>(rotr(tstorage{uint64_t(3)}, tstorage{uint64_t(1)})),
+      uint64_t(0x8000000000000001));
+  EXPECT_EQ(
+      std::get<uint64_t>(rotr(tstorage{uint64_t(3)}, tstorage{uint64_t(64)})),
+      3);
+}
+
+TEST(bitwise, rotr_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      rotr(tstorage{double(1)}, tstorage{double(1)})));
+
+  // 0x3ff0000000000000
+  EXPECT_EQ(
+      std::get<uint64_t>(rotr(tstorage{double(1)}, tstorage{double(52)})),
+      uint64_t(0x3ff));
+}
+
+} // namespace math
+} // namespace calculator
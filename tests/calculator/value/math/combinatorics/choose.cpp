@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.combinatorics;
+
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(combinatorics, choose_uint64_t_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(
+      choose(tstorage{uint64_t(5)}, tstorage{uint64_t(2)})));
+
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(0)}, tstorage{uint64_t(0)})),
+      1);
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(5)}, tstorage{uint64_t(0)})),
+      1);
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(5)}, tstorage{uint64_t(2)})),
+      10);
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(5)}, tstorage{uint64_t(5)})),
+      1);
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(5)}, tstorage{uint64_t(6)})),
+      0);
+}
+
+TEST(combinatorics, choose_uint64_t_uint64_t_table_limits) {
+  // The last row of the lookup table.
+  EXPECT_EQ(std::get<uint64_t>(
+                choose(tstorage{uint64_t(67)}, tstorage{uint64_t(33)})),
+            14'226'520'737'620'288'370u);
+  // Outside the table, but still fits.
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{uint64_t(68)}, tstorage{uint64_t(2)})),
+      2'278);
+  EXPECT_EQ(std::get<uint64_t>(
+                choose(tstorage{uint64_t(1'000'000)}, tstorage{uint64_t(3)})),
+            166'666'166'667'000'000u);
+}
+
+TEST(combinatorics, choose_uint64_t_uint64_t_result_double) {
+  ASSERT_TRUE(std::holds_alternative<double>(
+      choose(tstorage{uint64_t(68)}, tstorage{uint64_t(34)})));
+
+  EXPECT_NEAR(
+      std::get<double>(choose(tstorage{uint64_t(68)}, tstorage{uint64_t(34)})),
+      28'453'041'475'240'576'740., 1e10);
+}
+
+TEST(combinatorics, choose_int64_t_int64_t) {
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{int64_t(5)}, tstorage{int64_t(3)})),
+      10);
+
+  EXPECT_THROW(choose(tstorage{int64_t(-5)}, tstorage{int64_t(3)}),
+               std::range_error);
+  EXPECT_THROW(choose(tstorage{int64_t(5)}, tstorage{int64_t(-3)}),
+               std::range_error);
+}
+
+TEST(combinatorics, choose_double_double) {
+  EXPECT_EQ(
+      std::get<uint64_t>(choose(tstorage{double(5)}, tstorage{double(3)})), 10);
+
+  EXPECT_THROW(choose(tstorage{double(5.5)}, tstorage{double(3)}),
+               std::range_error);
+  EXPECT_THROW(choose(tstorage{double(5)}, tstorage{double(0.5)}),
+               std::range_error);
+}
+
+} // namespace math
+} // namespace calculator
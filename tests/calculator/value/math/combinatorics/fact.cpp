@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.combinatorics;
+
+#include <cmath>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(combinatorics, fact_int64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(fact(tstorage{int64_t(0)})));
+
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{int64_t(0)})), 1);
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{int64_t(5)})), 120);
+
+  EXPECT_THROW(fact(tstorage{int64_t(-1)}), std::range_error);
+}
+
+TEST(combinatorics, fact_uint64_t) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(fact(tstorage{uint64_t(20)})));
+
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{uint64_t(0)})), 1);
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{uint64_t(1)})), 1);
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{uint64_t(10)})), 3'628'800);
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{uint64_t(20)})),
+            2'432'902'008'176'640'000);
+}
+
+TEST(combinatorics, fact_uint64_t_result_double) {
+  ASSERT_TRUE(std::holds_alternative<double>(fact(tstorage{uint64_t(21)})));
+
+  EXPECT_DOUBLE_EQ(std::get<double>(fact(tstorage{uint64_t(21)})),
+                   51'090'942'171'709'440'000.);
+  EXPECT_TRUE(std::isinf(std::get<double>(fact(tstorage{uint64_t(171)}))));
+}
+
+TEST(combinatorics, fact_double) {
+  ASSERT_TRUE(std::holds_alternative<uint64_t>(fact(tstorage{double(3)})));
+
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{double(0)})), 1);
+  EXPECT_EQ(std::get<uint64_t>(fact(tstorage{double(3)})), 6);
+
+  EXPECT_THROW(fact(tstorage{double(-1)}), std::range_error);
+  EXPECT_THROW(fact(tstorage{double(1.5)}), std::range_error);
+  EXPECT_THROW(fact(tstorage{std::numeric_limits<double>::quiet_NaN()}),
+               std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
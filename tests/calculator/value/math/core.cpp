@@ -17,6 +17,7 @@ import calculator.math.core;
 #include <bit>
 #include <cmath>
 #include <limits>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -64,6 +65,14 @@ TEST(core, bitwise_cast_double) {
             std::bit_cast<uint64_t>(limit::signaling_NaN()));
 }
 
+TEST(core, bitwise_cast_rational) {
+  EXPECT_EQ(bitwise_cast(tstorage{trational{-2, 2}}),
+            static_cast<uint64_t>(-1));
+  EXPECT_EQ(bitwise_cast(tstorage{trational{0, 3}}), 0);
+  EXPECT_EQ(bitwise_cast(tstorage{trational{6, 3}}), 2);
+  EXPECT_THROW(bitwise_cast(tstorage{trational{1, 3}}), std::range_error);
+}
+
 TEST(core, positive_integral_cast_int64_t) {
   static_assert(
       std::same_as<decltype(positive_integral_cast(tstorage{int64_t(1)})),
@@ -117,6 +126,18 @@ TEST(core, positive_integral_cast_double) {
                std::range_error);
 }
 
+TEST(core, positive_integral_cast_rational) {
+  EXPECT_THROW(positive_integral_cast(tstorage{trational{-3, 3}}),
+               std::range_error);
+  EXPECT_THROW(positive_integral_cast(tstorage{trational{0, 3}}),
+               std::range_error);
+  EXPECT_THROW(positive_integral_cast(tstorage{trational{1, 3}}),
+               std::range_error);
+  EXPECT_EQ(positive_integral_cast(tstorage{trational{3, 3}}), 1);
+  EXPECT_EQ(positive_integral_cast(tstorage{trational{INT64_MAX, 1}}),
+            INT64_MAX);
+}
+
 TEST(core, negative_integral_cast_int64_t) {
   static_assert(
       std::same_as<decltype(negative_integral_cast(tstorage{int64_t(-1)})),
@@ -171,6 +192,18 @@ TEST(core, negative_integral_cast_double) {
                std::range_error);
 }
 
+TEST(core, negative_integral_cast_rational) {
+  EXPECT_THROW(negative_integral_cast(tstorage{trational{3, 3}}),
+               std::range_error);
+  EXPECT_THROW(negative_integral_cast(tstorage{trational{0, 3}}),
+               std::range_error);
+  EXPECT_THROW(negative_integral_cast(tstorage{trational{-1, 3}}),
+               std::range_error);
+  EXPECT_EQ(negative_integral_cast(tstorage{trational{-3, 3}}), -1);
+  EXPECT_EQ(negative_integral_cast(tstorage{trational{INT64_MIN, 1}}),
+            INT64_MIN);
+}
+
 TEST(core, integral_cast_int64_t) {
   static_assert(
       std::same_as<decltype(integral_cast(tstorage{int64_t(-1)})), tstorage>);
@@ -228,6 +261,20 @@ TEST(core, integral_cast_double) {
                std::domain_error);
 }
 
+TEST(core, integral_cast_rational) {
+  EXPECT_EQ(integral_cast(tstorage{trational{-6, 3}}), tstorage{int64_t(-2)});
+  EXPECT_EQ(integral_cast(tstorage{trational{0, 3}}), tstorage{int64_t(0)});
+  EXPECT_EQ(integral_cast(tstorage{trational{6, 3}}), tstorage{int64_t(2)});
+  EXPECT_THROW(integral_cast(tstorage{trational{-1, 3}}), std::range_error);
+  EXPECT_THROW(integral_cast(tstorage{trational{1, 3}}), std::range_error);
+}
+
+TEST(core, double_cast_rational) {
+  EXPECT_EQ(double_cast(tstorage{trational{-1, 2}}), -0.5);
+  EXPECT_EQ(double_cast(tstorage{trational{0, 3}}), 0.);
+  EXPECT_EQ(double_cast(tstorage{trational{1, 3}}), 1. / 3.);
+}
+
 template <class I> static void to_storage_double() {
   ASSERT_TRUE(std::holds_alternative<double>(
       to_storage<I>(__int128_t(std::numeric_limits<int64_t>::min()) - 1)));
@@ -362,5 +409,14 @@ TEST(core, to_storage_uint128) {
             double(__uint128_t(std::numeric_limits<uint64_t>::max()) + 1));
 }
 
+TEST(core, cast_vector) {
+  const tstorage value{tvector{std::vector<uint64_t>{1}}};
+  EXPECT_THROW(bitwise_cast(value), std::domain_error);
+  EXPECT_THROW(positive_integral_cast(value), std::domain_error);
+  EXPECT_THROW(negative_integral_cast(value), std::domain_error);
+  EXPECT_THROW(integral_cast(value), std::domain_error);
+  EXPECT_THROW(double_cast(value), std::domain_error);
+}
+
 } // namespace math
 } // namespace calculator
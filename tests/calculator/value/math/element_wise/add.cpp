@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, add_int64_t) {
+  // Six elements use both the SIMD and the scalar part of the kernel.
+  EXPECT_EQ(element_wise_add(make_vector<int64_t>({-1, 2, -3, 4, -5, 6}),
+                             make_vector<int64_t>({1, 1, 1, -1, -1, -1})),
+            make_vector<int64_t>({0, 3, -2, 3, -6, 5}));
+
+  EXPECT_EQ(element_wise_add(make_vector<int64_t>({-1, 2, -3, 4, -5, 6}),
+                             tstorage{int64_t(-1)}),
+            make_vector<int64_t>({-2, 1, -4, 3, -6, 5}));
+
+  // The scalar is converted to the element type of the vector.
+  EXPECT_EQ(element_wise_add(tstorage{uint64_t(1)},
+                             make_vector<int64_t>({-1, 2, -3, 4, -5, 6})),
+            make_vector<int64_t>({0, 3, -2, 5, -4, 7}));
+}
+
+TEST(element_wise, add_int64_t_overflow) {
+  // The overflow is in the scalar part of the kernel.
+  EXPECT_EQ(element_wise_add(make_vector<int64_t>({1, 2, 3, 4, 5,
+                                                   INT64_MAX}),
+                             tstorage{int64_t(1)}),
+            make_vector<uint64_t>({2, 3, 4, 5, 6, uint64_t(INT64_MAX) + 1}));
+
+  // The overflow is in the SIMD part of the kernel.
+  EXPECT_EQ(element_wise_add(make_vector<int64_t>({-1, INT64_MIN, -3, -4, -5}),
+                             tstorage{int64_t(-1)}),
+            make_vector<double>({-2., double(INT64_MIN) - 1., -4., -5., -6.}));
+}
+
+TEST(element_wise, add_uint64_t) {
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             make_vector<uint64_t>({5, 4, 3, 2, 1})),
+            make_vector<uint64_t>({6, 6, 6, 6, 6}));
+
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, UINT64_MAX, 4, 5}),
+                             tstorage{uint64_t(1)}),
+            make_vector<double>({2., 3., 18446744073709551616., 5., 6.}));
+}
+
+TEST(element_wise, add_mixed) {
+  EXPECT_EQ(
+      element_wise_add(make_vector<uint64_t>({1, 2, uint64_t(INT64_MAX) + 2}),
+                       make_vector<int64_t>({-2, -2, -2})),
+      make_vector<int64_t>({-1, 0, INT64_MAX}));
+
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, UINT64_MAX}),
+                             make_vector<int64_t>({-2, -2, -2})),
+            make_vector<double>({-1., 0., double(UINT64_MAX - 2)}));
+
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, UINT64_MAX}),
+                             tstorage{int64_t(-1)}),
+            make_vector<uint64_t>({0, 1, UINT64_MAX - 1}));
+}
+
+TEST(element_wise, add_double) {
+  EXPECT_EQ(element_wise_add(make_vector<double>({.5, 1.5, 2.5, 3.5, 4.5}),
+                             make_vector<int64_t>({-1, 1, -1, 1, -1})),
+            make_vector<double>({-.5, 2.5, 1.5, 4.5, 3.5}));
+
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             tstorage{.5}),
+            make_vector<double>({1.5, 2.5, 3.5, 4.5, 5.5}));
+
+  EXPECT_EQ(element_wise_add(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             tstorage{trational{1, 4}}),
+            make_vector<double>({1.25, 2.25, 3.25, 4.25, 5.25}));
+}
+
+TEST(element_wise, add_matrix) {
+  const tstorage matrix =
+      tmatrix{2, 2, tvector{std::vector<int64_t>{1, 2, 3, INT64_MAX}}};
+  EXPECT_EQ(element_wise_add(matrix, matrix),
+            (tstorage{tmatrix{2, 2,
+                              tvector{std::vector<double>{
+                                  2., 4., 6., 2. * double(INT64_MAX)}}}}));
+  EXPECT_EQ(element_wise_add(matrix, tstorage{int64_t(-1)}),
+            (tstorage{tmatrix{
+                2, 2, tvector{std::vector<int64_t>{0, 1, 2, INT64_MAX - 1}}}}));
+
+  EXPECT_THROW(element_wise_add(matrix, make_vector<int64_t>({1, 2, 3, 4})),
+               std::domain_error);
+  EXPECT_THROW(
+      element_wise_add(
+          matrix, tmatrix{1, 4, tvector{std::vector<int64_t>{1, 2, 3, 4}}}),
+      std::domain_error);
+}
+
+TEST(element_wise, add_size_mismatch) {
+  EXPECT_THROW(element_wise_add(make_vector<uint64_t>({1, 2, 3}),
+                                make_vector<uint64_t>({1, 2})),
+               std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
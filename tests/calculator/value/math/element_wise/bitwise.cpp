@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <bit>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, and) {
+  EXPECT_EQ(element_wise_and(make_vector<int64_t>({-1, -2, -3, -4, -5}),
+                             tstorage{int64_t(-2)}),
+            make_vector<int64_t>({-2, -2, -4, -4, -6}));
+
+  EXPECT_EQ(element_wise_and(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             make_vector<int64_t>({-1, -1, -2, -1, -2})),
+            make_vector<uint64_t>({1, 2, 2, 4, 4}));
+
+  EXPECT_EQ(element_wise_and(make_vector<double>({1.}),
+                             tstorage{uint64_t(0xfff0'0000'0000'0000)}),
+            make_vector<uint64_t>({std::bit_cast<uint64_t>(1.)}));
+
+  // An integral rational is a valid scalar.
+  EXPECT_EQ(element_wise_and(make_vector<uint64_t>({1, 2, 3}),
+                             tstorage{trational{4, 2}}),
+            make_vector<uint64_t>({0, 2, 2}));
+}
+
+TEST(element_wise, or) {
+  EXPECT_EQ(element_wise_or(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                            tstorage{uint64_t(1)}),
+            make_vector<uint64_t>({1, 3, 3, 5, 5}));
+}
+
+TEST(element_wise, xor) {
+  EXPECT_EQ(element_wise_xor(make_vector<int64_t>({-1, 0, 1, 2, 3}),
+                             make_vector<int64_t>({-1, -1, -1, -1, -1})),
+            make_vector<int64_t>({0, -1, -2, -3, -4}));
+}
+
+} // namespace math
+} // namespace calculator
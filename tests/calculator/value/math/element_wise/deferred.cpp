@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.element_wise;
+import calculator.math.reduction;
+import calculator.math.sequence;
+import tests.make_vector;
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+static bool holds_deferred(const tstorage &value) {
+  return std::holds_alternative<tvector>(value) &&
+         !std::get<tvector>(value).stored();
+}
+
+static constexpr std::size_t size = 10'000;
+
+TEST(element_wise, deferred) {
+  std::vector<double> a(size);
+  std::vector<int64_t> b(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    a[i] = 0.25 * static_cast<double>(i + 1);
+    b[i] = static_cast<int64_t>(i % 7) - 3;
+  }
+
+  const tstorage product = element_wise_mul(make_vector(a), make_vector(b));
+  const tstorage sum = element_wise_add(product, trational{1, 2});
+  const tstorage result = element_wise_div(sum, make_vector(a));
+  ASSERT_TRUE(holds_deferred(result));
+  EXPECT_EQ(std::get<tvector>(result).depth(), 3);
+  EXPECT_EQ(std::get<tvector>(result).size(), size);
+
+  std::vector<double> expected(size);
+  for (std::size_t i = 0; i < size; ++i)
+    expected[i] = (a[i] * static_cast<double>(b[i]) + 0.5) / a[i];
+  EXPECT_EQ(result, make_vector(expected));
+
+  // Only the result is stored, the intermediate results stay deferred.
+  EXPECT_FALSE(holds_deferred(result));
+  EXPECT_TRUE(holds_deferred(sum));
+}
+
+TEST(element_wise, deferred_release) {
+  // Records the destruction of the expression.
+  class texpression_ones final : public texpression {
+  public:
+    explicit texpression_ones(bool &destroyed)
+        : texpression(100, 1), destroyed_(destroyed) {}
+    ~texpression_ones() override { destroyed_ = true; }
+
+    void evaluate(std::size_t, std::size_t count,
+                  double *result) const override {
+      std::fill_n(result, count, 1.);
+    }
+
+  private:
+    bool &destroyed_;
+  };
+
+  bool destroyed = false;
+  const tvector vector{std::make_unique<const texpression_ones>(destroyed)};
+  EXPECT_EQ(vector.depth(), 1);
+
+  // Storing the elements releases the expression and its operands.
+  EXPECT_EQ(vector.get<double>()[0], 1.);
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(vector.depth(), 0);
+  EXPECT_EQ(vector.size(), 100);
+}
+
+TEST(element_wise, deferred_divisor) {
+  const tstorage a = make_vector(std::vector<double>(size, 2.));
+  const tstorage divisor = element_wise_add(element_wise_mul(a, a), 1.);
+  ASSERT_TRUE(holds_deferred(divisor));
+
+  // The divisor is calculated in the pass of the quotient.
+  const tstorage result = element_wise_div(a, divisor);
+  EXPECT_TRUE(holds_deferred(result));
+  EXPECT_TRUE(holds_deferred(divisor));
+  EXPECT_EQ(result, make_vector(std::vector<double>(size, 0.4)));
+  EXPECT_TRUE(holds_deferred(divisor));
+
+  // A deferred divisor is checked for zeros like the stored divisor with the
+  // same elements, without storing its elements.
+  std::vector<double> b(size, 1.);
+  b[size - 1] = 0.;
+  const tstorage zero = element_wise_mul(a, make_vector(b));
+  ASSERT_TRUE(holds_deferred(zero));
+  EXPECT_THROW(element_wise_div(a, zero), std::domain_error);
+  EXPECT_TRUE(holds_deferred(zero));
+  std::vector<double> c(size, 2.);
+  c[size - 1] = 0.;
+  EXPECT_THROW(element_wise_div(a, make_vector(c)), std::domain_error);
+
+  // A sequence is searched for a zero without storing its elements.
+  const tstorage sequence = range(-10., 0.5, uint64_t(size));
+  EXPECT_THROW(element_wise_div(a, sequence), std::domain_error);
+  EXPECT_THROW(element_wise_div(a, range(int64_t(-9'999), int64_t(3),
+                                         uint64_t(size))),
+               std::domain_error);
+  EXPECT_TRUE(holds_deferred(
+      element_wise_div(a, range(uint64_t(1), uint64_t(1), uint64_t(size)))));
+  EXPECT_TRUE(holds_deferred(sequence));
+}
+
+TEST(element_wise, deferred_depth) {
+  tstorage result = make_vector(std::vector<double>(size, 1.));
+  for (int i = 0; i < 20; ++i) {
+    result = element_wise_add(result, 1.);
+    EXPECT_LE(std::get<tvector>(result).depth(), 8);
+  }
+  EXPECT_EQ(result, make_vector(std::vector<double>(size, 21.)));
+}
+
+TEST(element_wise, deferred_not) {
+  // Small vectors and integral results are calculated immediately.
+  EXPECT_FALSE(holds_deferred(
+      element_wise_add(make_vector(std::vector<double>(size / 4, 1.)), 1.)));
+  EXPECT_FALSE(holds_deferred(element_wise_add(
+      make_vector(std::vector<int64_t>(size, 1)), int64_t(1))));
+
+  EXPECT_THROW(element_wise_div(make_vector(std::vector<double>(size, 1.)),
+                                make_vector(std::vector<double>(size, 0.))),
+               std::domain_error);
+}
+
+TEST(element_wise, deferred_reduction) {
+  std::vector<double> a(size);
+  for (std::size_t i = 0; i < size; ++i)
+    a[i] = static_cast<double>(i % 5);
+  const std::vector<tstorage> values{element_wise_mul(
+      make_vector(a), make_vector(std::vector<double>(size, 2.)))};
+  ASSERT_TRUE(holds_deferred(values[0]));
+
+  // The elements are reduced in parts, they are not stored.
+  EXPECT_EQ(math::sum(values), tstorage{4. * size});
+  EXPECT_EQ(math::prod(values), tstorage{0.});
+  EXPECT_EQ(math::min(values), tstorage{0.});
+  EXPECT_EQ(math::max(values), tstorage{8.});
+  EXPECT_TRUE(holds_deferred(values[0]));
+
+  // The elements of an integral sequence stay exact.
+  const std::vector<tstorage> sequence{
+      range(uint64_t(1), uint64_t(1), uint64_t(20))};
+  EXPECT_EQ(math::prod(sequence),
+            tstorage{uint64_t(2'432'902'008'176'640'000)});
+  EXPECT_FALSE(std::get<tvector>(sequence[0]).stored());
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, div_exact) {
+  EXPECT_EQ(element_wise_div(make_vector<int64_t>({-2, 4, -6, 8, -10}),
+                             tstorage{int64_t(-2)}),
+            make_vector<int64_t>({1, -2, 3, -4, 5}));
+
+  EXPECT_EQ(element_wise_div(make_vector<uint64_t>({5, 8, 9, 8, 5}),
+                             make_vector<uint64_t>({5, 4, 3, 2, 1})),
+            make_vector<uint64_t>({1, 2, 3, 4, 5}));
+}
+
+TEST(element_wise, div_inexact) {
+  // Unlike the scalar division the result is never a rational.
+  EXPECT_EQ(element_wise_div(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             tstorage{uint64_t(2)}),
+            make_vector<double>({.5, 1., 1.5, 2., 2.5}));
+
+  EXPECT_EQ(element_wise_div(tstorage{uint64_t(1)},
+                             make_vector<int64_t>({-1, 2, -4})),
+            make_vector<double>({-1., .5, -.25}));
+}
+
+TEST(element_wise, div_double) {
+  EXPECT_EQ(element_wise_div(make_vector<double>({1., 3., 5., 7., 9.}),
+                             tstorage{2.}),
+            make_vector<double>({.5, 1.5, 2.5, 3.5, 4.5}));
+}
+
+TEST(element_wise, div_by_zero) {
+  EXPECT_THROW(element_wise_div(make_vector<uint64_t>({1, 2, 3}),
+                                make_vector<uint64_t>({1, 0, 3})),
+               std::domain_error);
+  EXPECT_THROW(element_wise_div(make_vector<double>({1., 2., 3.}),
+                                tstorage{-0.}),
+               std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, mul_integral) {
+  EXPECT_EQ(element_wise_mul(make_vector<int64_t>({-1, 2, -3, 4, -5}),
+                             tstorage{int64_t(-2)}),
+            make_vector<int64_t>({2, -4, 6, -8, 10}));
+
+  EXPECT_EQ(element_wise_mul(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             make_vector<uint64_t>({5, 4, 3, 2, 1})),
+            make_vector<uint64_t>({5, 8, 9, 8, 5}));
+
+  EXPECT_EQ(element_wise_mul(make_vector<uint64_t>({1, 2, 3}),
+                             tstorage{int64_t(-1)}),
+            make_vector<int64_t>({-1, -2, -3}));
+}
+
+TEST(element_wise, mul_overflow) {
+  // The result doesn't fit in the type of the operands.
+  EXPECT_EQ(element_wise_mul(make_vector<int64_t>({1, INT64_MAX}),
+                             tstorage{int64_t(2)}),
+            make_vector<uint64_t>({2, UINT64_MAX - 1}));
+  EXPECT_EQ(element_wise_mul(make_vector<int64_t>({-1, INT64_MAX}),
+                             tstorage{int64_t(2)}),
+            make_vector<double>({-2., 2. * double(INT64_MAX)}));
+
+  EXPECT_EQ(element_wise_mul(make_vector<uint64_t>({1, UINT64_MAX}),
+                             tstorage{uint64_t(2)}),
+            make_vector<double>({2., 2. * double(UINT64_MAX)}));
+
+  EXPECT_EQ(element_wise_mul(make_vector<uint64_t>({1, UINT64_MAX}),
+                             make_vector<uint64_t>({1, UINT64_MAX})),
+            make_vector<double>({1., double(UINT64_MAX) * double(UINT64_MAX)}));
+}
+
+TEST(element_wise, mul_double) {
+  EXPECT_EQ(element_wise_mul(make_vector<double>({.5, 1.5, 2.5, 3.5, 4.5}),
+                             tstorage{uint64_t(2)}),
+            make_vector<double>({1., 3., 5., 7., 9.}));
+}
+
+} // namespace math
+} // namespace calculator
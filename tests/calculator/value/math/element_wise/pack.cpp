@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, pack) {
+  EXPECT_EQ(pack(std::vector<tstorage>{uint64_t(1), uint64_t(2)}),
+            make_vector<uint64_t>({1, 2}));
+  EXPECT_EQ(pack(std::vector<tstorage>{int64_t(1), int64_t(2)}),
+            make_vector<int64_t>({1, 2}));
+
+  EXPECT_EQ(pack(std::vector<tstorage>{int64_t(-1), uint64_t(2)}),
+            make_vector<int64_t>({-1, 2}));
+  EXPECT_EQ(pack(std::vector<tstorage>{int64_t(1), UINT64_MAX}),
+            make_vector<uint64_t>({1, UINT64_MAX}));
+  EXPECT_EQ(pack(std::vector<tstorage>{int64_t(-1), UINT64_MAX}),
+            make_vector<double>({-1., double(UINT64_MAX)}));
+
+  EXPECT_EQ(pack(std::vector<tstorage>{uint64_t(1), trational{1, 2}}),
+            make_vector<double>({1., .5}));
+
+  EXPECT_THROW(pack(std::vector<tstorage>{make_vector<uint64_t>({1})}),
+               std::domain_error);
+}
+
+TEST(element_wise, unpack) {
+  EXPECT_EQ(unpack(make_vector<int64_t>({-1, 2})),
+            (std::vector<tstorage>{int64_t(-1), int64_t(2)}));
+  EXPECT_EQ(unpack(make_vector<double>({.5})), (std::vector<tstorage>{.5}));
+
+  EXPECT_THROW(unpack(tstorage{uint64_t(1)}), std::domain_error);
+}
+
+TEST(element_wise, copy) {
+  // Copies share the elements.
+  const tvector vector{std::vector<uint64_t>{1, 2, 3}};
+  const tvector copy = vector;
+  EXPECT_EQ(copy.get<uint64_t>().data(), vector.get<uint64_t>().data());
+}
+
+} // namespace math
+} // namespace calculator
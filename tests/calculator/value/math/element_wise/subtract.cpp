@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.element_wise;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(element_wise, sub_int64_t) {
+  EXPECT_EQ(element_wise_sub(make_vector<int64_t>({-1, 2, -3, 4, -5, 6}),
+                             make_vector<int64_t>({1, 1, 1, -1, -1, -1})),
+            make_vector<int64_t>({-2, 1, -4, 5, -4, 7}));
+
+  EXPECT_EQ(element_wise_sub(tstorage{int64_t(-1)},
+                             make_vector<int64_t>({-1, 2, -3, 4, -5, 6})),
+            make_vector<int64_t>({0, -3, 2, -5, 4, -7}));
+
+  EXPECT_EQ(element_wise_sub(make_vector<int64_t>({INT64_MIN, -1, 0, 1, 2}),
+                             tstorage{int64_t(1)}),
+            make_vector<double>({double(INT64_MIN) - 1., -2., -1., 0., 1.}));
+}
+
+TEST(element_wise, sub_uint64_t) {
+  EXPECT_EQ(element_wise_sub(make_vector<uint64_t>({6, 7, 8, 9, 10}),
+                             make_vector<uint64_t>({5, 4, 3, 2, 1})),
+            make_vector<uint64_t>({1, 3, 5, 7, 9}));
+
+  // An underflow results in signed elements when they fit.
+  EXPECT_EQ(element_wise_sub(make_vector<uint64_t>({1, 2, 3, 4, 5}),
+                             tstorage{uint64_t(3)}),
+            make_vector<int64_t>({-2, -1, 0, 1, 2}));
+
+  EXPECT_EQ(element_wise_sub(make_vector<uint64_t>({0, UINT64_MAX}),
+                             tstorage{uint64_t(1)}),
+            make_vector<double>({-1., double(UINT64_MAX - 1)}));
+}
+
+TEST(element_wise, sub_double) {
+  EXPECT_EQ(element_wise_sub(make_vector<double>({.5, 1.5, 2.5, 3.5, 4.5}),
+                             tstorage{uint64_t(1)}),
+            make_vector<double>({-.5, .5, 1.5, 2.5, 3.5}));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.fft;
+import tests.make_vector;
+
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+template <class T>
+static std::vector<T> naive(const std::vector<T> &lhs,
+                            const std::vector<T> &rhs) {
+  std::vector<T> result(lhs.size() + rhs.size() - 1);
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    for (std::size_t j = 0; j < rhs.size(); ++j)
+      result[i + j] += lhs[i] * rhs[j];
+  return result;
+}
+
+TEST(conv, direct) {
+  EXPECT_EQ(conv(make_vector<int64_t>({1, 2, 3}), make_vector<int64_t>({0, 1})),
+            make_vector<int64_t>({0, 1, 2, 3}));
+  EXPECT_EQ(conv(make_vector<uint64_t>({1, 1}), make_vector<int64_t>({-1, 1})),
+            make_vector<int64_t>({-1, 0, 1}));
+  EXPECT_EQ(conv(make_vector<double>({.5, 1.}), make_vector<uint64_t>({2})),
+            make_vector<double>({1., 2.}));
+
+  // The exact result doesn't fit in 64 bits.
+  EXPECT_EQ(conv(make_vector<uint64_t>({UINT64_MAX}),
+                 make_vector<uint64_t>({2})),
+            make_vector<double>({2. * double(UINT64_MAX)}));
+}
+
+TEST(conv, transform) {
+  std::mt19937_64 generator;
+  std::uniform_int_distribution<int64_t> distribution{-1000, 1000};
+  std::vector<int64_t> lhs(1000);
+  std::vector<int64_t> rhs(300);
+  for (int64_t &element : lhs)
+    element = distribution(generator);
+  for (int64_t &element : rhs)
+    element = distribution(generator);
+
+  // The integral result is rounded, so it's exact.
+  EXPECT_EQ(conv(tvector{lhs}, tvector{rhs}),
+            tstorage{tvector{naive(lhs, rhs)}});
+
+  const std::vector<double> a(lhs.begin(), lhs.end());
+  const std::vector<double> b(rhs.begin(), rhs.end());
+  const std::vector<double> expected = naive(a, b);
+  const tstorage result = conv(tvector{a}, tvector{b});
+  const std::span<const double> elements =
+      std::get<tvector>(result).get<double>();
+  ASSERT_EQ(elements.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i)
+    EXPECT_NEAR(elements[i], expected[i], 1e-6);
+}
+
+TEST(conv, large_integrals) {
+  // Too large for the transform to be exact.
+  std::vector<int64_t> lhs(100, int64_t(1) << 40);
+  std::vector<int64_t> rhs(100, 3);
+  EXPECT_EQ(conv(tvector{lhs}, tvector{rhs}),
+            tstorage{tvector{naive(lhs, rhs)}});
+}
+
+TEST(conv, not_a_vector) {
+  EXPECT_THROW(conv(tstorage{1.}, make_vector<double>({1.})),
+               std::domain_error);
+  EXPECT_THROW(conv(make_vector<double>({1.}), tstorage{1.}),
+               std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
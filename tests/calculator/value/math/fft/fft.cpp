@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.fft;
+import tests.make_vector;
+
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+static std::vector<std::complex<double>> as_complex(const tstorage &value) {
+  const tmatrix &matrix = std::get<tmatrix>(value);
+  EXPECT_EQ(matrix.columns(), 2);
+  const std::span<const double> elements = matrix.elements().get<double>();
+  std::vector<std::complex<double>> result;
+  for (std::size_t i = 0; i < elements.size(); i += 2)
+    result.emplace_back(elements[i], elements[i + 1]);
+  return result;
+}
+
+static tstorage make_complex(std::span<const std::complex<double>> values) {
+  std::vector<double> elements;
+  for (std::complex<double> value : values) {
+    elements.push_back(value.real());
+    elements.push_back(value.imag());
+  }
+  return tmatrix{values.size(), 2, tvector{std::move(elements)}};
+}
+
+static std::vector<std::complex<double>>
+dft(std::span<const std::complex<double>> values) {
+  const std::size_t size = values.size();
+  std::vector<std::complex<double>> result(size);
+  for (std::size_t k = 0; k < size; ++k)
+    for (std::size_t n = 0; n < size; ++n)
+      result[k] += values[n] * std::polar(1., -2. * std::numbers::pi *
+                                                  double(n * k % size) /
+                                                  double(size));
+  return result;
+}
+
+static void expect_near(std::span<const std::complex<double>> lhs,
+                        std::span<const std::complex<double>> rhs) {
+  ASSERT_EQ(lhs.size(), rhs.size());
+  for (std::size_t i = 0; i < lhs.size(); ++i)
+    EXPECT_LT(std::abs(lhs[i] - rhs[i]), 1e-9) << "index " << i;
+}
+
+TEST(fft, vector) {
+  const std::vector<std::complex<double>> expected{
+      {10., 0.}, {-2., 2.}, {-2., 0.}, {-2., -2.}};
+  expect_near(as_complex(fft(make_vector<int64_t>({1, 2, 3, 4}))), expected);
+
+  expect_near(as_complex(fft(make_vector<double>({5.}))),
+              std::vector<std::complex<double>>{{5., 0.}});
+}
+
+TEST(fft, sizes) {
+  // Both an odd and an even number of radix-2 stages, and sizes that use
+  // Bluestein's algorithm.
+  std::mt19937_64 generator;
+  std::uniform_real_distribution<double> distribution{-1., 1.};
+  for (std::size_t size : {2, 3, 5, 8, 12, 16, 31, 64, 100, 128, 1000}) {
+    std::vector<std::complex<double>> values(size);
+    for (std::complex<double> &value : values)
+      value = {distribution(generator), distribution(generator)};
+
+    const tstorage transformed = fft(make_complex(values));
+    expect_near(as_complex(transformed), dft(values));
+    expect_near(as_complex(ifft(transformed)), values);
+  }
+}
+
+TEST(fft, invalid) {
+  EXPECT_THROW(fft(tstorage{1.}), std::domain_error);
+  EXPECT_THROW(
+      ifft(tmatrix{1, 3, tvector{std::vector<double>{1., 2., 3.}}}),
+      std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.linear_algebra;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+/** Returns a well-conditioned matrix, larger than a block of the LU. */
+static std::vector<double> make_random(std::size_t n) {
+  std::mt19937_64 generator{n};
+  std::uniform_real_distribution<double> distribution{-1., 1.};
+  std::vector<double> result(n * n);
+  for (double &element : result)
+    element = distribution(generator);
+  return result;
+}
+
+static std::span<const double> elements(const tstorage &value) {
+  return std::get<tmatrix>(value).elements().get<double>();
+}
+
+TEST(linear_algebra, lu) {
+  const auto [p, l, u] = lu(make_matrix<int64_t>(2, 2, {1, 2, 3, 4}));
+  EXPECT_EQ(p, make_matrix<int64_t>(2, 2, {0, 1, 1, 0}));
+  EXPECT_EQ(l, make_matrix<double>(2, 2, {1., 0., 1. / 3., 1.}));
+  EXPECT_EQ(u, make_matrix<double>(2, 2, {3., 4., 0., 2. - 4. / 3.}));
+
+  EXPECT_THROW(lu(make_matrix<int64_t>(1, 2, {1, 2})), std::domain_error);
+  EXPECT_THROW(lu(tstorage{int64_t(1)}), std::domain_error);
+}
+
+TEST(linear_algebra, lu_blocked) {
+  static constexpr std::size_t n = 150;
+  const std::vector<double> a = make_random(n);
+  const auto [p, l, u] = lu(make_matrix(n, n, a));
+
+  // P * A = L * U
+  const tstorage pa = matmul(p, make_matrix(n, n, a));
+  const tstorage product = matmul(l, u);
+  for (std::size_t i = 0; i < n * n; ++i)
+    EXPECT_NEAR(elements(pa)[i], elements(product)[i], 1e-12);
+
+  // Partial pivoting keeps the elements of L small.
+  for (double element : elements(l))
+    EXPECT_LE(std::abs(element), 1.);
+}
+
+TEST(linear_algebra, solve) {
+  const tstorage a = make_matrix<int64_t>(2, 2, {2, 1, 1, 3});
+  const tstorage b = tvector{std::vector<int64_t>{4, 7}};
+  EXPECT_EQ(solve(a, b), (tstorage{tvector{std::vector<double>{1., 2.}}}));
+  EXPECT_EQ(solve(a, make_matrix<int64_t>(2, 2, {2, 1, 1, 3})),
+            make_matrix<double>(2, 2, {1., 0., 0., 1.}));
+
+  EXPECT_THROW(solve(a, tvector{std::vector<int64_t>{1, 2, 3}}),
+               std::domain_error);
+  EXPECT_THROW(solve(make_matrix<int64_t>(2, 2, {1, 2, 2, 4}),
+                     tvector{std::vector<int64_t>{1, 2}}),
+               std::domain_error);
+}
+
+TEST(linear_algebra, solve_blocked) {
+  static constexpr std::size_t n = 200;
+  const std::vector<double> a = make_random(n);
+  std::vector<double> expected(n);
+  for (std::size_t i = 0; i < n; ++i)
+    expected[i] = static_cast<double>(i % 7) - 3.;
+
+  std::vector<double> b(n);
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      b[i] += a[i * n + j] * expected[j];
+
+  const tstorage x = solve(make_matrix(n, n, a), tvector{b});
+  const std::span<const double> result = std::get<tvector>(x).get<double>();
+  for (std::size_t i = 0; i < n; ++i)
+    EXPECT_NEAR(result[i], expected[i], 1e-9);
+}
+
+TEST(linear_algebra, inv) {
+  EXPECT_EQ(inv(make_matrix<int64_t>(2, 2, {2, 1, 1, 1})),
+            make_matrix<double>(2, 2, {1., -1., -1., 2.}));
+
+  static constexpr std::size_t n = 100;
+  const tstorage a = make_matrix(n, n, make_random(n));
+  const tstorage identity = matmul(a, inv(a));
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      EXPECT_NEAR(elements(identity)[i * n + j], i == j ? 1. : 0., 1e-10);
+
+  EXPECT_THROW(inv(make_matrix<int64_t>(2, 2, {1, 2, 2, 4})),
+               std::domain_error);
+}
+
+TEST(linear_algebra, det) {
+  EXPECT_EQ(det(make_matrix<int64_t>(1, 1, {-5})), tstorage{int64_t(-5)});
+  EXPECT_EQ(det(make_matrix<int64_t>(3, 3, {0, 2, 1, 3, 1, 4, 5, 6, 7})),
+            tstorage{int64_t(11)});
+  EXPECT_EQ(det(make_matrix<int64_t>(2, 2, {1, 2, 2, 4})),
+            tstorage{int64_t(0)});
+  EXPECT_EQ(det(make_matrix<int64_t>(3, 3, {1, 2, 3, 0, 0, 1, 0, 0, 2})),
+            tstorage{int64_t(0)});
+  EXPECT_EQ(det(make_matrix<int64_t>(2, 2, {INT64_MAX, 0, 0, 2})),
+            tstorage{uint64_t(INT64_MAX) * 2});
+
+  EXPECT_EQ(det(make_matrix<double>(2, 2, {.5, 1., 1.5, 2.})), tstorage{-.5});
+
+  // The intermediate results don't fit in 128 bits.
+  EXPECT_EQ(det(make_matrix<int64_t>(3, 3,
+                                     {INT64_MAX, 0, 0, 0, INT64_MAX, 0, 0, 0,
+                                      INT64_MAX})),
+            tstorage{std::pow(double(INT64_MAX), 3.)});
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.linear_algebra;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(linear_algebra, matmul) {
+  const tstorage a = make_matrix<int64_t>(2, 3, {1, 2, 3, 4, 5, 6});
+  const tstorage b = make_matrix<int64_t>(3, 2, {7, 8, 9, 10, 11, 12});
+  EXPECT_EQ(matmul(a, b), make_matrix<int64_t>(2, 2, {58, 64, 139, 154}));
+  EXPECT_EQ(matmul(b, a),
+            make_matrix<int64_t>(
+                3, 3, {39, 54, 69, 49, 68, 87, 59, 82, 105}));
+
+  const tstorage c = make_matrix<double>(2, 2, {.5, 1., 1.5, 2.});
+  EXPECT_EQ(matmul(c, c), make_matrix<double>(2, 2, {1.75, 2.5, 3.75, 5.5}));
+  EXPECT_EQ(matmul(a, make_matrix<double>(3, 1, {.5, .25, .125})),
+            make_matrix<double>(2, 1, {1.375, 4.}));
+
+  EXPECT_THROW(matmul(a, a), std::domain_error);
+  EXPECT_THROW(matmul(a, tstorage{int64_t(1)}), std::domain_error);
+  EXPECT_THROW(matmul(tvector{std::vector<int64_t>{1}}, a), std::domain_error);
+}
+
+TEST(linear_algebra, matmul_overflow) {
+  const tstorage a =
+      make_matrix<int64_t>(1, 2, {INT64_MAX, INT64_MAX});
+  const tstorage b = make_matrix<int64_t>(2, 1, {2, -2});
+  EXPECT_EQ(matmul(a, b), make_matrix<int64_t>(1, 1, {0}));
+
+  const tstorage c = make_matrix<int64_t>(2, 1, {2, 2});
+  EXPECT_EQ(matmul(a, c),
+            make_matrix<double>(1, 1, {4. * double(INT64_MAX)}));
+}
+
+/** Multiplies the matrices with the textbook algorithm. */
+static std::vector<double> reference(const std::vector<double> &a,
+                                     const std::vector<double> &b,
+                                     std::size_t m, std::size_t k,
+                                     std::size_t n) {
+  std::vector<double> result(m * n);
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      for (std::size_t p = 0; p < k; ++p)
+        result[i * n + j] += a[i * k + p] * b[p * n + j];
+  return result;
+}
+
+TEST(linear_algebra, matmul_blocked) {
+  std::mt19937_64 generator;
+  std::uniform_real_distribution<double> distribution{-1., 1.};
+
+  // The sizes aren't multiples of the tiles and blocks.
+  for (auto [m, k, n] : {std::array<std::size_t, 3>{1, 1, 1},
+                         std::array<std::size_t, 3>{5, 3, 9},
+                         std::array<std::size_t, 3>{67, 131, 45},
+                         std::array<std::size_t, 3>{150, 300, 70}}) {
+    std::vector<double> a(m * k);
+    std::vector<double> b(k * n);
+    for (double &element : a)
+      element = distribution(generator);
+    for (double &element : b)
+      element = distribution(generator);
+
+    const tstorage result = matmul(make_matrix(m, k, a), make_matrix(k, n, b));
+    const tmatrix &matrix = std::get<tmatrix>(result);
+    ASSERT_EQ(matrix.rows(), m);
+    ASSERT_EQ(matrix.columns(), n);
+
+    const std::vector<double> expected = reference(a, b, m, k, n);
+    const std::span<const double> elements =
+        matrix.elements().get<double>();
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      EXPECT_NEAR(elements[i], expected[i], 1e-12 * static_cast<double>(k));
+  }
+}
+
+} // namespace math
+} // namespace calculator
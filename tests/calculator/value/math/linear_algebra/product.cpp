@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.linear_algebra;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(linear_algebra, dot) {
+  EXPECT_EQ(dot(make_vector<int64_t>({1, -2, 3}),
+                make_vector<uint64_t>({4, 5, 6})),
+            tstorage{int64_t(12)});
+  EXPECT_EQ(dot(make_vector<double>({.5, 1., 1.5, 2., 2.5, 3., 3.5, 4., 4.5}),
+                make_vector<int64_t>({2, 2, 2, 2, 2, 2, 2, 2, 2})),
+            tstorage{45.});
+
+  // The intermediate results are exact.
+  EXPECT_EQ(dot(make_vector<int64_t>({INT64_MAX, INT64_MAX}),
+                make_vector<int64_t>({2, -1})),
+            tstorage{int64_t(INT64_MAX)});
+  EXPECT_EQ(dot(make_vector<int64_t>({INT64_MAX}), make_vector<int64_t>({2})),
+            tstorage{uint64_t(INT64_MAX) * 2});
+
+  EXPECT_THROW(dot(make_vector<int64_t>({1}), make_vector<int64_t>({1, 2})),
+               std::domain_error);
+  EXPECT_THROW(dot(make_vector<int64_t>({1}), tstorage{int64_t(1)}),
+               std::domain_error);
+}
+
+TEST(linear_algebra, outer) {
+  EXPECT_EQ(outer(make_vector<int64_t>({1, -2}),
+                  make_vector<uint64_t>({3, 4, 5})),
+            make_matrix<int64_t>(2, 3, {3, 4, 5, -6, -8, -10}));
+  EXPECT_EQ(outer(make_vector<double>({.5}), make_vector<int64_t>({1, 2})),
+            make_matrix<double>(1, 2, {.5, 1.}));
+
+  EXPECT_EQ(outer(make_vector<int64_t>({INT64_MAX}),
+                  make_vector<int64_t>({2})),
+            make_matrix<double>(1, 1, {2. * double(INT64_MAX)}));
+
+  EXPECT_THROW(outer(make_vector<int64_t>({1}), tstorage{int64_t(1)}),
+               std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
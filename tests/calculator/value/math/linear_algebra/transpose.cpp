@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.linear_algebra;
+import tests.make_vector;
+
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(linear_algebra, transpose) {
+  EXPECT_EQ(transpose(make_matrix<int64_t>(2, 3, {1, 2, 3, 4, 5, 6})),
+            make_matrix<int64_t>(3, 2, {1, 4, 2, 5, 3, 6}));
+  EXPECT_EQ(transpose(make_matrix<double>(1, 2, {.5, .25})),
+            make_matrix<double>(2, 1, {.5, .25}));
+
+  // Larger than a tile.
+  std::vector<int64_t> elements(70 * 40);
+  std::iota(elements.begin(), elements.end(), 0);
+  const tstorage matrix = make_matrix(70, 40, elements);
+  EXPECT_EQ(transpose(transpose(matrix)), matrix);
+  EXPECT_EQ(std::get<tmatrix>(transpose(matrix)).elements().get<int64_t>()[1],
+            40);
+
+  EXPECT_THROW(transpose(tstorage{int64_t(1)}), std::domain_error);
+}
+
+TEST(linear_algebra, reshape) {
+  const tstorage vector = tvector{std::vector<uint64_t>{1, 2, 3, 4, 5, 6}};
+  EXPECT_EQ(reshape(vector, tstorage{uint64_t(3)}),
+            make_matrix<int64_t>(2, 3, {1, 2, 3, 4, 5, 6}));
+  EXPECT_EQ(reshape(reshape(vector, tstorage{uint64_t(3)}),
+                    tstorage{uint64_t(2)}),
+            make_matrix<int64_t>(3, 2, {1, 2, 3, 4, 5, 6}));
+
+  // A matrix doesn't store std::uint64_t elements.
+  const tstorage large = tvector{std::vector<uint64_t>{1, UINT64_MAX}};
+  EXPECT_EQ(reshape(large, tstorage{uint64_t(1)}),
+            make_matrix<double>(2, 1, {1., double(UINT64_MAX)}));
+
+  EXPECT_THROW(reshape(vector, tstorage{uint64_t(4)}), std::domain_error);
+  EXPECT_THROW(reshape(vector, tstorage{uint64_t(0)}), std::range_error);
+  EXPECT_THROW(reshape(tstorage{uint64_t(1)}, tstorage{uint64_t(1)}),
+               std::domain_error);
+}
+
+TEST(linear_algebra, flatten) {
+  EXPECT_EQ(flatten(make_matrix<int64_t>(2, 2, {1, 2, 3, 4})),
+            (tstorage{tvector{std::vector<int64_t>{1, 2, 3, 4}}}));
+
+  EXPECT_THROW(flatten(tvector{std::vector<int64_t>{1}}), std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.rational;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(rational, make_rational_normalised) {
+  std::optional<trational> result = make_rational(3, -6);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numerator, -3);
+  EXPECT_EQ(result->denominator, 6);
+
+  result = make_rational(std::numeric_limits<int64_t>::max() + __int128_t(1),
+                         -2);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numerator, std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(result->denominator, 2);
+}
+
+TEST(rational, make_rational_lazy) {
+  // The fraction fits, so it's not reduced.
+  const std::optional<trational> result = make_rational(2, 4);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numerator, 2);
+  EXPECT_EQ(result->denominator, 4);
+}
+
+TEST(rational, make_rational_reduced) {
+  constexpr __int128_t max = std::numeric_limits<int64_t>::max();
+
+  std::optional<trational> result = make_rational(2 * max, 4 * max);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numerator, 1);
+  EXPECT_EQ(result->denominator, 2);
+
+  result = make_rational(max + 1, 2);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(result->numerator, (max + 1) / 2);
+  EXPECT_EQ(result->denominator, 1);
+}
+
+TEST(rational, make_rational_overflow) {
+  constexpr __int128_t max = std::numeric_limits<int64_t>::max();
+
+  EXPECT_FALSE(make_rational(max + 1, 3));
+  EXPECT_FALSE(make_rational(1, max + 2));
+  EXPECT_FALSE(make_rational(-max - 2, 1));
+}
+
+} // namespace math
+} // namespace calculator
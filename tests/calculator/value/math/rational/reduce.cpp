@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.rational;
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(rational, reduce) {
+  static_assert(reduce(trational{2, 4}).numerator == 1);
+  static_assert(reduce(trational{2, 4}).denominator == 2);
+
+  EXPECT_EQ(reduce(trational{0, 5}).numerator, 0);
+  EXPECT_EQ(reduce(trational{0, 5}).denominator, 1);
+
+  EXPECT_EQ(reduce(trational{-12, 18}).numerator, -2);
+  EXPECT_EQ(reduce(trational{-12, 18}).denominator, 3);
+
+  EXPECT_EQ(reduce(trational{7, 13}).numerator, 7);
+  EXPECT_EQ(reduce(trational{7, 13}).denominator, 13);
+
+  EXPECT_EQ(reduce(trational{INT64_MIN, 2}).numerator, INT64_MIN / 2);
+  EXPECT_EQ(reduce(trational{INT64_MIN, 2}).denominator, 1);
+
+  EXPECT_EQ(reduce(trational{INT64_MAX, INT64_MAX}).numerator, 1);
+  EXPECT_EQ(reduce(trational{INT64_MAX, INT64_MAX}).denominator, 1);
+}
+
+TEST(rational, equal) {
+  static_assert(trational{1, 2} == trational{2, 4});
+  static_assert(trational{-1, 2} == trational{-2, 4});
+  static_assert(trational{0, 2} == trational{0, 3});
+  static_assert(trational{1, 2} != trational{-1, 2});
+  static_assert(trational{1, 3} != trational{1, 2});
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.reduction;
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(reduction, count) {
+  EXPECT_EQ(count(std::vector<tstorage>{int64_t(-1)}), tstorage{uint64_t(1)});
+  EXPECT_EQ(count(std::vector<tstorage>{uint64_t(1), .5, trational{1, 2}}),
+            tstorage{uint64_t(3)});
+  EXPECT_EQ(
+      count(std::vector<tstorage>{
+          tvector{std::vector<double>{.5, .25}}, uint64_t(1),
+          tvector{std::vector<uint64_t>{1, 2, 3}}}),
+      tstorage{uint64_t(6)});
+
+  EXPECT_THROW(count(std::vector<tstorage>{}), std::out_of_range);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.reduction;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(reduction, min) {
+  EXPECT_EQ(min(std::vector<tstorage>{uint64_t(2)}), tstorage{uint64_t(2)});
+  EXPECT_EQ(min(std::vector<tstorage>{uint64_t(2), int64_t(-3), .5}),
+            tstorage{int64_t(-3)});
+  EXPECT_EQ(min(std::vector<tstorage>{uint64_t(1), trational{1, 2}, .75}),
+            (tstorage{trational{1, 2}}));
+  EXPECT_EQ(min(std::vector<tstorage>{trational{-1, 2}, -.25}),
+            (tstorage{trational{-1, 2}}));
+  EXPECT_EQ(min(std::vector<tstorage>{trational{-1, 2}, -.75}),
+            tstorage{-.75});
+
+  EXPECT_THROW(min(std::vector<tstorage>{}), std::out_of_range);
+}
+
+TEST(reduction, max) {
+  EXPECT_EQ(max(std::vector<tstorage>{uint64_t(2)}), tstorage{uint64_t(2)});
+  EXPECT_EQ(max(std::vector<tstorage>{uint64_t(2), int64_t(-3), .5}),
+            tstorage{uint64_t(2)});
+  EXPECT_EQ(max(std::vector<tstorage>{uint64_t(1), trational{3, 2}, 1.25}),
+            (tstorage{trational{3, 2}}));
+
+  EXPECT_THROW(max(std::vector<tstorage>{}), std::out_of_range);
+}
+
+TEST(reduction, extremum_exact) {
+  // These values are equal as double.
+  EXPECT_EQ(max(std::vector<tstorage>{UINT64_MAX - 1, UINT64_MAX,
+                                      double(UINT64_MAX - 1)}),
+            tstorage{double(UINT64_MAX - 1)});
+  EXPECT_EQ(max(std::vector<tstorage>{UINT64_MAX - 1, UINT64_MAX}),
+            tstorage{UINT64_MAX});
+  EXPECT_EQ(min(std::vector<tstorage>{INT64_MIN + 1, INT64_MIN}),
+            tstorage{INT64_MIN});
+  EXPECT_EQ(min(std::vector<tstorage>{0x1p63, INT64_MAX}),
+            tstorage{INT64_MAX});
+}
+
+TEST(reduction, extremum_vector) {
+  const tstorage vector = make_vector<int64_t>({5, -3, 8, 1, 9, -7, 2, 4, 0});
+  EXPECT_EQ(min(std::vector<tstorage>{vector}), tstorage{int64_t(-7)});
+  EXPECT_EQ(max(std::vector<tstorage>{vector}), tstorage{int64_t(9)});
+  EXPECT_EQ(max(std::vector<tstorage>{vector, uint64_t(10)}),
+            tstorage{uint64_t(10)});
+
+  const tstorage unsigned_vector =
+      make_vector<uint64_t>({5, UINT64_MAX, 8, 1, 9, 7});
+  EXPECT_EQ(min(std::vector<tstorage>{unsigned_vector}),
+            tstorage{uint64_t(1)});
+  EXPECT_EQ(max(std::vector<tstorage>{unsigned_vector}), tstorage{UINT64_MAX});
+
+  const tstorage double_vector = make_vector<double>({.5, -3., 8., 1.5, -.5});
+  EXPECT_EQ(min(std::vector<tstorage>{double_vector}), tstorage{-3.});
+  EXPECT_EQ(max(std::vector<tstorage>{double_vector}), tstorage{8.});
+}
+
+TEST(reduction, extremum_nan) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_TRUE(std::isnan(std::get<double>(
+      min(std::vector<tstorage>{uint64_t(1), nan, uint64_t(2)}))));
+  EXPECT_TRUE(std::isnan(std::get<double>(
+      max(std::vector<tstorage>{make_vector<double>({1., 2., 3., 4., nan})}))));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.reduction;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(reduction, prod) {
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(2)}), tstorage{uint64_t(2)});
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(2), uint64_t(3)}),
+            tstorage{uint64_t(6)});
+  EXPECT_EQ(prod(std::vector<tstorage>{int64_t(-2), int64_t(3)}),
+            tstorage{int64_t(-6)});
+  EXPECT_EQ(prod(std::vector<tstorage>{int64_t(-2), int64_t(-3)}),
+            tstorage{int64_t(6)});
+  EXPECT_EQ(prod(std::vector<tstorage>{int64_t(-2), uint64_t(3)}),
+            tstorage{int64_t(-6)});
+
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(2), .25}), tstorage{.5});
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(3), trational{1, 2}}),
+            (tstorage{trational{3, 2}}));
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(4), trational{1, 2}}),
+            (tstorage{trational{2, 1}}));
+
+  EXPECT_THROW(prod(std::vector<tstorage>{}), std::out_of_range);
+}
+
+TEST(reduction, prod_overflow) {
+  // Intermediate results may exceed 64 bits.
+  EXPECT_EQ(prod(std::vector<tstorage>{UINT64_MAX, UINT64_MAX, uint64_t(0)}),
+            tstorage{uint64_t(0)});
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(1) << 32, uint64_t(1) << 32}),
+            tstorage{0x1p64});
+
+  // Larger than 128 bits.
+  EXPECT_EQ(prod(std::vector<tstorage>{uint64_t(1) << 63, uint64_t(1) << 63,
+                                       uint64_t(1) << 63}),
+            tstorage{0x1p189});
+}
+
+TEST(reduction, prod_vector) {
+  EXPECT_EQ(prod(std::vector<tstorage>{make_vector<uint64_t>({1, 2, 3}),
+                                       uint64_t(4)}),
+            tstorage{uint64_t(24)});
+  EXPECT_EQ(prod(std::vector<tstorage>{make_vector<int64_t>({-1, 2, -3})}),
+            tstorage{int64_t(6)});
+  EXPECT_EQ(prod(std::vector<tstorage>{
+                make_vector<double>({.5, .5, 2., 2., 4., 4., 8., 8., .25}),
+                trational{1, 4}}),
+            tstorage{64.});
+}
+
+} // namespace math
+} // namespace calculator
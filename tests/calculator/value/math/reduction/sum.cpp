@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.reduction;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(reduction, sum) {
+  EXPECT_EQ(sum(std::vector<tstorage>{uint64_t(1)}), tstorage{uint64_t(1)});
+  EXPECT_EQ(sum(std::vector<tstorage>{uint64_t(1), uint64_t(2)}),
+            tstorage{uint64_t(3)});
+  EXPECT_EQ(sum(std::vector<tstorage>{int64_t(-1), int64_t(-2)}),
+            tstorage{int64_t(-3)});
+  EXPECT_EQ(sum(std::vector<tstorage>{int64_t(-1), uint64_t(2)}),
+            tstorage{uint64_t(1)});
+
+  EXPECT_EQ(sum(std::vector<tstorage>{uint64_t(1), .5}), tstorage{1.5});
+  EXPECT_EQ(sum(std::vector<tstorage>{uint64_t(1), trational{1, 2}}),
+            (tstorage{trational{3, 2}}));
+  EXPECT_EQ(sum(std::vector<tstorage>{trational{1, 2}, trational{1, 2}}),
+            (tstorage{trational{1, 1}}));
+
+  EXPECT_THROW(sum(std::vector<tstorage>{}), std::out_of_range);
+}
+
+TEST(reduction, sum_overflow) {
+  // Intermediate results may overflow.
+  EXPECT_EQ(sum(std::vector<tstorage>{UINT64_MAX, UINT64_MAX, int64_t(-1),
+                                      INT64_MIN, INT64_MIN}),
+            tstorage{uint64_t(UINT64_MAX - 2)});
+
+  EXPECT_EQ(sum(std::vector<tstorage>{UINT64_MAX, uint64_t(1)}),
+            tstorage{double(UINT64_MAX) + 1.});
+  EXPECT_EQ(sum(std::vector<tstorage>{INT64_MIN, int64_t(-1)}),
+            tstorage{double(INT64_MIN) - 1.});
+}
+
+TEST(reduction, sum_vector) {
+  EXPECT_EQ(sum(std::vector<tstorage>{make_vector<uint64_t>({1, 2, 3}),
+                                      uint64_t(4)}),
+            tstorage{uint64_t(10)});
+  EXPECT_EQ(sum(std::vector<tstorage>{make_vector<double>({.5, .25}),
+                                      trational{1, 4}}),
+            tstorage{1.});
+
+  // Every lane of the SIMD register overflows.
+  EXPECT_EQ(sum(std::vector<tstorage>{make_vector<uint64_t>(
+                std::vector<uint64_t>(11, UINT64_MAX)),
+                                      make_vector<int64_t>({-11})}),
+            tstorage{double(UINT64_MAX) * 11. - 11.});
+  EXPECT_EQ(sum(std::vector<tstorage>{
+                make_vector<int64_t>(std::vector<int64_t>(11, INT64_MIN)),
+                make_vector<int64_t>(std::vector<int64_t>(11, INT64_MAX))}),
+            tstorage{int64_t(-11)});
+}
+
+TEST(reduction, sum_large) {
+  // Large enough to be processed in parallel.
+  std::vector<int64_t> elements(1'000'003);
+  std::iota(elements.begin(), elements.end(), -500'000);
+  const tstorage vector = make_vector<int64_t>(elements);
+
+  EXPECT_EQ(sum(std::vector<tstorage>{vector}), tstorage{int64_t(1'000'003)});
+  EXPECT_EQ(sum(std::vector<tstorage>{uint64_t(1), vector, vector}),
+            tstorage{uint64_t(2'000'007)});
+
+  EXPECT_EQ(sum(std::vector<tstorage>(elements.begin(), elements.end())),
+            tstorage{int64_t(1'000'003)});
+}
+
+TEST(reduction, sum_summation) {
+  const std::vector<tstorage> values{1., 1e100, 1., -1e100};
+  EXPECT_EQ(sum(values), tstorage{0.});
+  EXPECT_EQ(sum(values, tsummation::naive), tstorage{0.});
+  EXPECT_EQ(sum(values, tsummation::neumaier), tstorage{2.});
+
+  const tstorage vector = make_vector<double>({1., 1e100, 1., -1e100});
+  EXPECT_EQ(sum(std::vector<tstorage>{vector}, tsummation::neumaier),
+            tstorage{2.});
+  EXPECT_EQ(sum(std::vector<tstorage>{vector, vector}, tsummation::neumaier),
+            tstorage{4.});
+
+  // The integrals and rationals are added to the compensated sum.
+  EXPECT_EQ(sum(std::vector<tstorage>{1e100, uint64_t(1), trational{1, 2},
+                                      -1e100},
+                tsummation::neumaier),
+            tstorage{1.5});
+}
+
+TEST(reduction, sum_summation_accuracy) {
+  // Every small element is lost when added to 1 with a naive sum.
+  std::vector<double> elements(1 << 20, 0x1p-53);
+  elements[0] = 1.;
+  const std::vector<tstorage> values{make_vector<double>(elements)};
+  const double exact = 1. + 0x1p-33;
+
+  const double naive = std::get<double>(sum(values, tsummation::naive));
+  const double pairwise = std::get<double>(sum(values, tsummation::pairwise));
+  const double neumaier = std::get<double>(sum(values, tsummation::neumaier));
+
+  EXPECT_LT(std::abs(pairwise - exact), std::abs(naive - exact));
+  // Only the small elements in the block of the 1 are lost.
+  EXPECT_LE(std::abs(pairwise - exact), 0x1p-45);
+  EXPECT_EQ(neumaier, exact);
+
+  // The same values, but not in a vector.
+  const std::vector<tstorage> scalars(elements.begin(), elements.end());
+  EXPECT_EQ(std::get<double>(sum(scalars, tsummation::naive)), 1.);
+  EXPECT_LE(std::abs(std::get<double>(sum(scalars, tsummation::pairwise)) -
+                     exact),
+            0x1p-45);
+  EXPECT_EQ(std::get<double>(sum(scalars, tsummation::neumaier)), exact);
+}
+
+} // namespace math
+} // namespace calculator
@@ -49,5 +49,14 @@ TEST(arithmetic, ceil_double) {
   EXPECT_EQ(std::get<double>(ceil(tstorage{1.1})), 2.);
 }
 
+TEST(arithmetic, ceil_rational) {
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{-3, 2}})), -1);
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{-1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{0, 1}})), 0);
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{1, 3}})), 1);
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{3, 2}})), 2);
+  EXPECT_EQ(std::get<int64_t>(ceil(tstorage{trational{6, 3}})), 2);
+}
+
 } // namespace math
 } // namespace calculator
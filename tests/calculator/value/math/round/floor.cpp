@@ -49,5 +49,14 @@ TEST(arithmetic, floor_double) {
   EXPECT_EQ(std::get<double>(floor(tstorage{1.1})), 1.);
 }
 
+TEST(arithmetic, floor_rational) {
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{-3, 2}})), -2);
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{-1, 3}})), -1);
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{0, 1}})), 0);
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{3, 2}})), 1);
+  EXPECT_EQ(std::get<int64_t>(floor(tstorage{trational{6, 3}})), 2);
+}
+
 } // namespace math
 } // namespace calculator
@@ -49,5 +49,16 @@ TEST(arithmetic, round_double) {
   EXPECT_EQ(std::get<double>(round(tstorage{1.1})), 1.);
 }
 
+TEST(arithmetic, round_rational) {
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{-3, 2}})), -2);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{-1, 2}})), -1);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{-1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{0, 1}})), 0);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{1, 2}})), 1);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{3, 2}})), 2);
+  EXPECT_EQ(std::get<int64_t>(round(tstorage{trational{5, 3}})), 2);
+}
+
 } // namespace math
 } // namespace calculator
@@ -49,5 +49,14 @@ TEST(arithmetic, trunc_double) {
   EXPECT_EQ(std::get<double>(trunc(tstorage{1.1})), 1.);
 }
 
+TEST(arithmetic, trunc_rational) {
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{-3, 2}})), -1);
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{-1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{0, 1}})), 0);
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{1, 3}})), 0);
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{3, 2}})), 1);
+  EXPECT_EQ(std::get<int64_t>(trunc(tstorage{trational{6, 3}})), 2);
+}
+
 } // namespace math
 } // namespace calculator
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.scan;
+import tests.make_vector;
+
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(scan, cumprod_integral) {
+  EXPECT_EQ(cumprod(make_vector<int64_t>({-1, 2, -3, 4, -5, 6})),
+            make_vector<int64_t>({-1, -2, 6, 24, -120, -720}));
+  EXPECT_EQ(cumprod(make_vector<uint64_t>({1, 2, 3, 4, 5})),
+            make_vector<uint64_t>({1, 2, 6, 24, 120}));
+
+  EXPECT_EQ(cumprod(make_vector<int64_t>({INT64_MAX, 2, 0})),
+            make_vector<uint64_t>(
+                {uint64_t(INT64_MAX), uint64_t(INT64_MAX) * 2, 0}));
+  EXPECT_EQ(cumprod(make_vector<uint64_t>({UINT64_MAX, UINT64_MAX, 2})),
+            make_vector<double>(
+                {double(UINT64_MAX), double(UINT64_MAX) * double(UINT64_MAX),
+                 2. * double(UINT64_MAX) * double(UINT64_MAX)}));
+}
+
+TEST(scan, cumprod_double) {
+  EXPECT_EQ(cumprod(make_vector<double>({.5, 2., 4., -.25, 8., 1.5})),
+            make_vector<double>({.5, 1., 4., -1., -8., -12.}));
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.scan;
+import tests.make_vector;
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(scan, cumsum_int64_t) {
+  // Six elements use both the SIMD and the scalar part of the kernel.
+  EXPECT_EQ(cumsum(make_vector<int64_t>({-1, 2, -3, 4, -5, 6})),
+            make_vector<int64_t>({-1, 1, -2, 2, -3, 3}));
+
+  EXPECT_EQ(cumsum(make_vector<int64_t>({INT64_MAX, 1, -2})),
+            make_vector<uint64_t>(
+                {uint64_t(INT64_MAX), uint64_t(INT64_MAX) + 1,
+                 uint64_t(INT64_MAX) - 1}));
+  EXPECT_EQ(cumsum(make_vector<int64_t>({INT64_MIN, -1, 1, 1, 1})),
+            make_vector<double>({double(INT64_MIN), double(INT64_MIN) - 1.,
+                                 double(INT64_MIN), double(INT64_MIN) + 1.,
+                                 double(INT64_MIN) + 2.}));
+}
+
+TEST(scan, cumsum_uint64_t) {
+  EXPECT_EQ(cumsum(make_vector<uint64_t>({1, 2, 3, 4, 5})),
+            make_vector<uint64_t>({1, 3, 6, 10, 15}));
+
+  EXPECT_EQ(cumsum(make_vector<uint64_t>({UINT64_MAX, 1})),
+            make_vector<double>({double(UINT64_MAX), 18446744073709551616.}));
+}
+
+TEST(scan, cumsum_double) {
+  EXPECT_EQ(cumsum(make_vector<double>({.5, 1., 1.5, 2., 2.5, -3.})),
+            make_vector<double>({.5, 1.5, 3., 5., 7.5, 4.5}));
+}
+
+TEST(scan, cumsum_large) {
+  // Large enough to be scanned in parallel.
+  std::vector<int64_t> elements(1'000'003);
+  std::iota(elements.begin(), elements.end(), -500'000);
+  std::vector<int64_t> expected(elements.size());
+  std::partial_sum(elements.begin(), elements.end(), expected.begin());
+  EXPECT_EQ(cumsum(tvector{elements}), tstorage{tvector{expected}});
+
+  std::vector<double> doubles(elements.begin(), elements.end());
+  std::vector<double> sums(elements.size());
+  std::partial_sum(doubles.begin(), doubles.end(), sums.begin());
+  EXPECT_EQ(cumsum(tvector{doubles}), tstorage{tvector{sums}});
+}
+
+TEST(scan, cumsum_not_a_vector) {
+  EXPECT_THROW(cumsum(tstorage{int64_t(1)}), std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
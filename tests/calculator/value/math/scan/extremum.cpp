@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import calculator.math.scan;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(scan, cummax) {
+  EXPECT_EQ(cummax(make_vector<int64_t>({-3, -5, -1, 4, 2, 6})),
+            make_vector<int64_t>({-3, -3, -1, 4, 4, 6}));
+  EXPECT_EQ(cummax(make_vector<uint64_t>({1, UINT64_MAX, 3})),
+            make_vector<uint64_t>({1, UINT64_MAX, UINT64_MAX}));
+  EXPECT_EQ(cummax(make_vector<double>({.5, -1., 2., 1.5, 3., -4.})),
+            make_vector<double>({.5, .5, 2., 2., 3., 3.}));
+}
+
+TEST(scan, cummin) {
+  EXPECT_EQ(cummin(make_vector<int64_t>({-3, -5, -1, 4, -7, 6})),
+            make_vector<int64_t>({-3, -5, -5, -5, -7, -7}));
+  EXPECT_EQ(cummin(make_vector<uint64_t>({3, 1, 2})),
+            make_vector<uint64_t>({3, 1, 1}));
+  EXPECT_EQ(cummin(make_vector<double>({.5, -1., 2., -1.5, 3., -4.})),
+            make_vector<double>({.5, -1., -1., -1.5, -1.5, -4.}));
+}
+
+TEST(scan, extremum_nan) {
+  // A NaN is propagated to the remaining elements.
+  const tstorage result =
+      cummax(make_vector<double>({1., 2., std::nan(""), 4., 5., 6.}));
+  const std::span<const double> elements =
+      std::get<tvector>(result).get<double>();
+  EXPECT_EQ(elements[1], 2.);
+  for (std::size_t i = 2; i < elements.size(); ++i)
+    EXPECT_TRUE(std::isnan(elements[i]));
+}
+
+} // namespace math
+} // namespace calculator
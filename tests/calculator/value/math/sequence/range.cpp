@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.element_wise;
+import calculator.math.reduction;
+import calculator.math.sequence;
+import tests.make_vector;
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+static bool holds_sequence(const tstorage &value) {
+  return std::holds_alternative<tvector>(value) &&
+         std::get<tvector>(value).holds_sequence();
+}
+
+TEST(sequence, iota) {
+  const tstorage result = iota(uint64_t(4));
+  ASSERT_TRUE(holds_sequence(result));
+  EXPECT_EQ(std::get<tvector>(result).size(), 4);
+  EXPECT_EQ(result, make_vector<uint64_t>({0, 1, 2, 3}));
+
+  EXPECT_THROW(iota(uint64_t(0)), std::range_error);
+  EXPECT_THROW(iota(int64_t(-1)), std::range_error);
+  EXPECT_THROW(iota(uint64_t(UINT64_MAX)), std::range_error);
+}
+
+TEST(sequence, range) {
+  EXPECT_EQ(range(uint64_t(10), int64_t(-3), uint64_t(4)),
+            make_vector<uint64_t>({10, 7, 4, 1}));
+  EXPECT_EQ(range(int64_t(-2), int64_t(2), uint64_t(3)),
+            make_vector<int64_t>({-2, 0, 2}));
+  EXPECT_EQ(range(uint64_t(1), int64_t(-1), uint64_t(3)),
+            make_vector<int64_t>({1, 0, -1}));
+  EXPECT_EQ(range(0.5, trational{1, 4}, uint64_t(3)),
+            make_vector<double>({0.5, 0.75, 1.}));
+
+  // The elements don't fit in an integral type.
+  EXPECT_EQ(range(int64_t(INT64_MIN), uint64_t(UINT64_MAX), uint64_t(3)),
+            make_vector<double>({-0x1p63, 0x1p63, 0x3p63}));
+
+  // The step doesn't fit in the element type.
+  EXPECT_EQ(range(int64_t(INT64_MIN), uint64_t(UINT64_MAX - 1), uint64_t(2)),
+            make_vector<int64_t>({INT64_MIN, INT64_MAX - 1}));
+
+  EXPECT_THROW(range(0., std::numeric_limits<double>::infinity(), uint64_t(2)),
+               std::domain_error);
+  EXPECT_THROW(range(make_vector<double>({1.}), 1., uint64_t(2)),
+               std::domain_error);
+}
+
+TEST(sequence, element_wise) {
+  const tstorage sequence = range(uint64_t(1), uint64_t(2), uint64_t(3));
+
+  tstorage result = element_wise_add(sequence, uint64_t(1));
+  EXPECT_TRUE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<uint64_t>({2, 4, 6}));
+
+  result = element_wise_sub(uint64_t(1), sequence);
+  EXPECT_TRUE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<int64_t>({0, -2, -4}));
+
+  result = element_wise_sub(sequence, iota(uint64_t(3)));
+  EXPECT_TRUE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<uint64_t>({1, 2, 3}));
+
+  // The result is no sequence.
+  result = element_wise_mul(sequence, sequence);
+  EXPECT_FALSE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<uint64_t>({1, 9, 25}));
+
+  result = element_wise_add(sequence, make_vector<uint64_t>({1, 1, 1}));
+  EXPECT_FALSE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<uint64_t>({2, 4, 6}));
+
+  result = element_wise_mul(sequence, 0.5);
+  EXPECT_FALSE(holds_sequence(result));
+  EXPECT_EQ(result, make_vector<double>({0.5, 1.5, 2.5}));
+
+  // Overflow gives the same types as a stored vector.
+  result = element_wise_mul(sequence, uint64_t(UINT64_MAX / 4));
+  EXPECT_FALSE(holds_sequence(result));
+  EXPECT_EQ(result,
+            element_wise_mul(make_vector<uint64_t>({1, 3, 5}),
+                             uint64_t(UINT64_MAX / 4)));
+
+  EXPECT_THROW(element_wise_add(sequence, iota(uint64_t(2))),
+               std::domain_error);
+}
+
+TEST(sequence, element_wise_double) {
+  // A double result has the same elements as the operation on the stored
+  // elements. The larger size uses a deferred operation.
+  for (uint64_t size : {uint64_t(100), uint64_t(10'000)}) {
+    std::vector<uint64_t> integrals(size);
+    std::vector<double> doubles(size);
+    for (uint64_t i = 0; i < size; ++i) {
+      integrals[i] = i + 1;
+      doubles[i] = 0.5 + static_cast<double>(i) * 0.1;
+    }
+
+    EXPECT_EQ(element_wise_mul(range(uint64_t(1), uint64_t(1), size), 0.1),
+              element_wise_mul(make_vector(integrals), 0.1));
+    EXPECT_EQ(element_wise_add(range(0.5, 0.1, size), 0.3),
+              element_wise_add(make_vector(doubles), 0.3));
+  }
+}
+
+TEST(sequence, element_wise_parts) {
+  // Operations that don't give a sequence calculate the elements of the
+  // sequence in parts, they are not stored.
+  const uint64_t size = 10'000;
+  const tstorage sequence = range(int64_t(-5'000), int64_t(1), size);
+  std::vector<int64_t> elements(size);
+  std::vector<int64_t> squares(size);
+  std::vector<int64_t> masked(size);
+  std::vector<double> halves(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    elements[i] = static_cast<int64_t>(i) - 5'000;
+    squares[i] = elements[i] * elements[i];
+    masked[i] = elements[i] & 0xff;
+    halves[i] = static_cast<double>(elements[i]) / 2.;
+  }
+
+  EXPECT_EQ(element_wise_mul(sequence, make_vector(elements)),
+            make_vector(squares));
+  EXPECT_EQ(element_wise_and(sequence, int64_t(0xff)), make_vector(masked));
+  const tstorage twos = make_vector(std::vector<int64_t>(size, 2));
+  EXPECT_EQ(element_wise_div(sequence, twos), make_vector(halves));
+  EXPECT_FALSE(std::get<tvector>(sequence).stored());
+}
+
+TEST(sequence, reduction) {
+  const std::vector<tstorage> values{
+      range(int64_t(-5), int64_t(2), uint64_t(6)), int64_t(1)};
+  EXPECT_EQ(sum(values), tstorage{int64_t(1)});
+  EXPECT_EQ(min(values), tstorage{int64_t(-5)});
+  EXPECT_EQ(max(values), tstorage{int64_t(5)});
+  EXPECT_EQ(count(values), tstorage{uint64_t(7)});
+  EXPECT_TRUE(holds_sequence(values[0]));
+
+  const std::vector<tstorage> doubles{range(1., -0.5, uint64_t(5))};
+  EXPECT_EQ(sum(doubles), tstorage{0.});
+  EXPECT_EQ(min(doubles), tstorage{-1.});
+  EXPECT_EQ(max(doubles), tstorage{1.});
+}
+
+TEST(sequence, large) {
+  // The elements are never stored, that would use 8 GB.
+  const std::vector<tstorage> values{
+      element_wise_add(iota(uint64_t(1'000'000'000)), uint64_t(1))};
+  EXPECT_EQ(sum(values), tstorage{uint64_t(500'000'000'500'000'000)});
+  EXPECT_EQ(max(values), tstorage{uint64_t(1'000'000'000)});
+  EXPECT_EQ(count(values), tstorage{uint64_t(1'000'000'000)});
+}
+
+TEST(sequence, large_double) {
+  // A double result is no sequence but a deferred vector. Its elements are
+  // never stored, but they are reduced one by one instead of in closed form.
+  const std::vector<tstorage> values{
+      element_wise_mul(iota(uint64_t(10'000'000)), 0.5)};
+  EXPECT_FALSE(holds_sequence(values[0]));
+  EXPECT_EQ(sum(values), tstorage{24'999'997'500'000.});
+  EXPECT_EQ(max(values), tstorage{4'999'999.5});
+  EXPECT_FALSE(std::get<tvector>(values[0]).stored());
+}
+
+} // namespace math
+} // namespace calculator
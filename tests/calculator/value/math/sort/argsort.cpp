@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.sort;
+import tests.make_vector;
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(argsort, vector) {
+  EXPECT_EQ(argsort(make_vector<int64_t>({3, -1, 0, -1})),
+            make_vector<uint64_t>({1, 3, 2, 0}));
+  EXPECT_EQ(argsort(make_vector<uint64_t>({5, 4, 3})),
+            make_vector<uint64_t>({2, 1, 0}));
+
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_EQ(argsort(make_vector<double>({nan, 0.5, -0.5})),
+            make_vector<uint64_t>({2, 1, 0}));
+}
+
+TEST(argsort, large) {
+  // Large enough to use the radix sort, the duplicates test the stability.
+  std::vector<int64_t> elements(100'003);
+  for (std::size_t i = 0; i < elements.size(); ++i)
+    elements[i] = static_cast<int64_t>(i * 7919 % 1009) - 500;
+
+  std::vector<uint64_t> expected(elements.size());
+  std::iota(expected.begin(), expected.end(), 0);
+  std::ranges::stable_sort(
+      expected, [&](uint64_t lhs, uint64_t rhs) {
+        return elements[lhs] < elements[rhs];
+      });
+  EXPECT_EQ(argsort(tvector{elements}), tstorage{tvector{expected}});
+}
+
+TEST(argsort, not_a_vector) {
+  EXPECT_THROW(argsort(tstorage{1.}), std::domain_error);
+}
+
+TEST(sort_order, homogeneous) {
+  const std::vector<tstorage> doubles{2.5, -1., 2.5, 0.};
+  EXPECT_EQ(sort_order(doubles, torder::ascending),
+            (std::vector<std::size_t>{1, 3, 0, 2}));
+  // The sort is stable in both directions.
+  EXPECT_EQ(sort_order(doubles, torder::descending),
+            (std::vector<std::size_t>{0, 2, 3, 1}));
+
+  const std::vector<tstorage> integrals{uint64_t(5), int64_t(-2),
+                                        uint64_t(UINT64_MAX), int64_t(3)};
+  EXPECT_EQ(sort_order(integrals, torder::ascending),
+            (std::vector<std::size_t>{1, 3, 0, 2}));
+}
+
+TEST(sort_order, mixed) {
+  const std::vector<tstorage> values{
+      2.5,         trational{1, 3},   int64_t(-2),
+      uint64_t(1), std::numeric_limits<double>::quiet_NaN(), int64_t(1)};
+  EXPECT_EQ(sort_order(values, torder::ascending),
+            (std::vector<std::size_t>{2, 1, 3, 5, 0, 4}));
+  EXPECT_EQ(sort_order(values, torder::descending),
+            (std::vector<std::size_t>{4, 0, 3, 5, 1, 2}));
+
+  EXPECT_TRUE(sort_order(std::vector<tstorage>{}, torder::ascending).empty());
+}
+
+TEST(sort_order, not_a_scalar) {
+  const std::vector<tstorage> values{int64_t(1),
+                                     tvector{std::vector<int64_t>{1}}};
+  EXPECT_THROW(sort_order(values, torder::ascending), std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
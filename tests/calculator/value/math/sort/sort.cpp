@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.sort;
+import tests.make_vector;
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(sort, int64_t) {
+  EXPECT_EQ(sort(make_vector<int64_t>({3, -1, INT64_MIN, 0, INT64_MAX, -1})),
+            make_vector<int64_t>({INT64_MIN, -1, -1, 0, 3, INT64_MAX}));
+  EXPECT_EQ(sort(make_vector<int64_t>({3, -1, INT64_MIN, 0, INT64_MAX, -1}),
+                 torder::descending),
+            make_vector<int64_t>({INT64_MAX, 3, 0, -1, -1, INT64_MIN}));
+}
+
+TEST(sort, uint64_t) {
+  EXPECT_EQ(sort(make_vector<uint64_t>({UINT64_MAX, 0, 256, 1, 255})),
+            make_vector<uint64_t>({0, 1, 255, 256, UINT64_MAX}));
+  EXPECT_EQ(sort(make_vector<uint64_t>({UINT64_MAX, 0, 256, 1, 255}),
+                 torder::descending),
+            make_vector<uint64_t>({UINT64_MAX, 256, 255, 1, 0}));
+}
+
+TEST(sort, double) {
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  EXPECT_EQ(sort(make_vector<double>({1.5, -infinity, -0.25, 0., infinity,
+                                      -1e300, 1e-300})),
+            make_vector<double>({-infinity, -1e300, -0.25, 0., 1e-300, 1.5,
+                                 infinity}));
+  EXPECT_EQ(sort(make_vector<double>({1.5, -0.25, 0.}), torder::descending),
+            make_vector<double>({1.5, 0., -0.25}));
+}
+
+TEST(sort, nan) {
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  const tstorage result = sort(make_vector<double>({nan, 2., -1., nan}));
+  const tvector &elements = std::get<tvector>(result);
+  ASSERT_EQ(elements.size(), 4);
+  EXPECT_EQ(elements.get<double>()[0], -1.);
+  EXPECT_EQ(elements.get<double>()[1], 2.);
+  EXPECT_TRUE(std::isnan(elements.get<double>()[2]));
+  EXPECT_TRUE(std::isnan(elements.get<double>()[3]));
+}
+
+TEST(sort, large) {
+  // Large enough to be sorted in parallel.
+  std::mt19937_64 generator;
+  std::vector<int64_t> elements(1'000'003);
+  std::ranges::generate(elements, [&] {
+    return static_cast<int64_t>(generator());
+  });
+  std::vector<int64_t> expected = elements;
+  std::ranges::sort(expected);
+  EXPECT_EQ(sort(tvector{elements}), tstorage{tvector{expected}});
+
+  std::vector<double> doubles(elements.begin(), elements.end());
+  std::ranges::sort(doubles, std::greater{});
+  EXPECT_EQ(sort(tvector{std::vector<double>(elements.begin(), elements.end())},
+                 torder::descending),
+            tstorage{tvector{doubles}});
+}
+
+TEST(sort, not_a_vector) {
+  EXPECT_THROW(sort(tstorage{int64_t(1)}), std::domain_error);
+}
+
+} // namespace math
+} // namespace calculator
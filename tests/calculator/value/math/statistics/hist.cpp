@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.statistics;
+import tests.make_vector;
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(statistics, hist) {
+  // The largest value is counted in the last bucket.
+  const std::vector<tstorage> values{
+      make_vector<int64_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), int64_t(10)};
+  EXPECT_EQ(hist(values, 5), make_vector<uint64_t>({2, 2, 2, 2, 4}));
+  EXPECT_EQ(hist(values, 1), make_vector<uint64_t>({12}));
+
+  const std::vector<tstorage> doubles{-1., 0.5, 1., trational{1, 3}};
+  EXPECT_EQ(hist(doubles, 2), make_vector<uint64_t>({1, 3}));
+}
+
+TEST(statistics, hist_equal) {
+  const std::vector<tstorage> values{make_vector<uint64_t>({7, 7, 7})};
+  EXPECT_EQ(hist(values, 3), make_vector<uint64_t>({3, 0, 0}));
+}
+
+TEST(statistics, hist_subnormal) {
+  // The number of buckets divided by the width of the range overflows.
+  const std::vector<tstorage> values{0., 1e-310};
+  EXPECT_EQ(hist(values, 10),
+            make_vector<uint64_t>({1, 0, 0, 0, 0, 0, 0, 0, 0, 1}));
+
+  const std::vector<tstorage> vector{make_vector<double>(
+      {0., 1e-310, 0., 1e-310, 0., 1e-310, 0., 1e-310, 0.})};
+  EXPECT_EQ(hist(vector, 10),
+            make_vector<uint64_t>({5, 0, 0, 0, 0, 0, 0, 0, 0, 4}));
+}
+
+TEST(statistics, hist_nan) {
+  constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+  const std::vector<tstorage> values{
+      make_vector<double>({nan, 0., 1., nan, 2., 3., nan}), nan};
+  EXPECT_EQ(hist(values, 2), make_vector<uint64_t>({2, 2}));
+
+  const std::vector<tstorage> nans{nan};
+  EXPECT_EQ(hist(nans, 2), make_vector<uint64_t>({0, 0}));
+}
+
+TEST(statistics, hist_large) {
+  // Large enough to be counted in parallel. The range is a power of two, so
+  // the bucket boundaries are exact.
+  std::vector<double> elements((1 << 20) + 1);
+  std::iota(elements.begin(), elements.end(), 0.);
+  const std::vector<tstorage> values{tvector{elements}};
+  std::vector<uint64_t> expected(16, 1 << 16);
+  ++expected.back();
+  EXPECT_EQ(hist(values, 16), tstorage{tvector{expected}});
+}
+
+TEST(statistics, hist_invalid) {
+  const std::vector<tstorage> values{
+      1., std::numeric_limits<double>::infinity()};
+  EXPECT_THROW(hist(values, 2), std::domain_error);
+  EXPECT_THROW(hist(std::vector<tstorage>{}, 2), std::out_of_range);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+import calculator.math.statistics;
+import tests.make_vector;
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace calculator {
+namespace math {
+
+TEST(statistics, median) {
+  const std::vector<tstorage> odd{int64_t(3), int64_t(-1), int64_t(2)};
+  EXPECT_EQ(median(odd), tstorage{int64_t(2)});
+
+  const std::vector<tstorage> even{uint64_t(4), uint64_t(1), uint64_t(3),
+                                   uint64_t(2)};
+  EXPECT_EQ(median(even), tstorage{2.5});
+
+  // Equal middle values keep their type.
+  const std::vector<tstorage> equal{int64_t(1), int64_t(2), int64_t(2),
+                                    int64_t(3)};
+  EXPECT_EQ(median(equal), tstorage{int64_t(2)});
+
+  // The elements of vectors are used as separate values.
+  const std::vector<tstorage> vectors{make_vector<double>({5., 1.}), 3.,
+                                      make_vector<double>({4., 2.})};
+  EXPECT_EQ(median(vectors), tstorage{3.});
+}
+
+TEST(statistics, median_mixed) {
+  // Large integrals are compared exactly.
+  const std::vector<tstorage> integrals{
+      int64_t(-1), uint64_t(UINT64_MAX), uint64_t(UINT64_MAX - 1)};
+  EXPECT_EQ(median(integrals), tstorage{uint64_t(UINT64_MAX - 1)});
+
+  const std::vector<tstorage> rationals{trational{1, 3}, 1., trational{1, 2}};
+  EXPECT_EQ(std::get<trational>(median(rationals)), (trational{1, 2}));
+}
+
+TEST(statistics, median_nan) {
+  const std::vector<tstorage> values{
+      1., std::numeric_limits<double>::quiet_NaN(), 2.};
+  EXPECT_TRUE(std::isnan(std::get<double>(median(values))));
+}
+
+TEST(statistics, quantile) {
+  std::vector<int64_t> elements(101);
+  std::iota(elements.begin(), elements.end(), 0);
+  std::ranges::shuffle(elements, std::mt19937_64{});
+  const std::vector<tstorage> values{tvector{elements}};
+
+  EXPECT_EQ(quantile(values, tstorage{0.}), tstorage{int64_t(0)});
+  EXPECT_EQ(quantile(values, tstorage{int64_t(1)}), tstorage{int64_t(100)});
+  EXPECT_EQ(quantile(values, tstorage{0.99}), tstorage{int64_t(99)});
+  EXPECT_EQ(quantile(values, tstorage{0.995}), tstorage{99.5});
+  EXPECT_EQ(quantile(values, tstorage{trational{1, 4}}), tstorage{int64_t(25)});
+
+  // The results are in the order of the probabilities.
+  EXPECT_EQ(quantile(values, make_vector<double>({0.9, 0.5, 0.995})),
+            make_vector<double>({90., 50., 99.5}));
+}
+
+TEST(statistics, quantile_invalid) {
+  const std::vector<tstorage> values{1., 2.};
+  EXPECT_THROW(quantile(values, tstorage{1.5}), std::range_error);
+  EXPECT_THROW(quantile(values, tstorage{int64_t(-1)}), std::range_error);
+  const tstorage nan{std::numeric_limits<double>::quiet_NaN()};
+  EXPECT_THROW(quantile(values, nan), std::range_error);
+  EXPECT_THROW(quantile(std::vector<tstorage>{}, tstorage{0.5}),
+               std::out_of_range);
+}
+
+} // namespace math
+} // namespace calculator
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import lib.parallel;
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace lib {
+TEST(parallel, parallel_reduce) {
+  std::vector<int> values(1000);
+  std::iota(values.begin(), values.end(), 0);
+  auto map = [&](std::size_t first, std::size_t last) {
+    return std::vector<int>(values.begin() + first, values.begin() + last);
+  };
+  auto combine = [](std::vector<int> lhs, const std::vector<int> &rhs) {
+    lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+    return lhs;
+  };
+
+  // The combination preserves the order of the chunks.
+  EXPECT_EQ(parallel_reduce(values.size(), map, combine), values);
+  EXPECT_EQ(parallel_reduce(values.size(), map, combine, 1), values);
+  EXPECT_EQ(parallel_reduce(values.size(), map, combine, 10'000), values);
+}
+
+TEST(parallel, parallel_reduce_throws) {
+  EXPECT_THROW(parallel_reduce(
+                   1000,
+                   [](std::size_t, std::size_t) -> int {
+                     throw std::range_error("");
+                   },
+                   std::plus<>{}, 1),
+               std::range_error);
+}
+
+TEST(parallel, parallel_for) {
+  for (std::size_t grain_size : {std::size_t(1), std::size_t(7),
+                                 parallel_grain_size}) {
+    std::vector<int> values(1000);
+    parallel_for(
+        values.size(),
+        [&](std::size_t first, std::size_t last) {
+          for (; first < last; ++first)
+            ++values[first];
+        },
+        grain_size);
+    EXPECT_EQ(values, std::vector<int>(1000, 1));
+  }
+}
+
+TEST(parallel, worker_pool) {
+  tworker_pool pool;
+  // The workers are reused for every range.
+  for (std::size_t size : {std::size_t(0), std::size_t(1), std::size_t(1000),
+                           std::size_t(1001)}) {
+    std::vector<int> values(size);
+    pool.parallel_for(
+        values.size(),
+        [&](std::size_t first, std::size_t last) {
+          for (; first < last; ++first)
+            ++values[first];
+        },
+        7);
+    EXPECT_EQ(values, std::vector<int>(size, 1));
+  }
+}
+
+TEST(parallel, worker_pool_throws) {
+  tworker_pool pool;
+  EXPECT_THROW(pool.parallel_for(
+                   1000,
+                   [](std::size_t, std::size_t) { throw std::range_error(""); },
+                   1),
+               std::range_error);
+
+  // The pool is usable after an exception.
+  std::vector<int> values(100);
+  pool.parallel_for(
+      values.size(),
+      [&](std::size_t first, std::size_t last) {
+        for (; first < last; ++first)
+          ++values[first];
+      },
+      1);
+  EXPECT_EQ(values, std::vector<int>(100, 1));
+}
+} // namespace lib
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+import lib.table;
+
+#include <array>
+
+#include <gtest/gtest.h>
+
+namespace lib {
+TEST(table, make_table) {
+  static constexpr std::array lut =
+      make_table<4>([](std::size_t i) { return static_cast<int>(i * i); });
+  static_assert(lut.size() == 4);
+  EXPECT_EQ(lut[0], 0);
+  EXPECT_EQ(lut[1], 1);
+  EXPECT_EQ(lut[2], 4);
+  EXPECT_EQ(lut[3], 9);
+}
+} // namespace lib
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) Mark de Wever <koraq@xs4all.nl>
+ * Part of the RPN project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY.
+ *
+ * See the COPYING file for more details.
+ */
+
+module;
+
+#include <vector>
+
+export module tests.make_vector;
+
+import calculator.math.core;
+
+namespace calculator {
+namespace math {
+
+/** Helper function to create a vector value from its @p elements. */
+export template <class T> tstorage make_vector(std::vector<T> elements) {
+  return tvector{std::move(elements)};
+}
+
+/** Helper function to create a matrix value from its @p elements. */
+export template <class T>
+tstorage make_matrix(std::size_t rows, std::size_t columns,
+                     std::vector<T> elements) {
+  return tmatrix{rows, columns, tvector{std::move(elements)}};
+}
+} // namespace math
+} // namespace calculator